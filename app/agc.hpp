@@ -8,6 +8,7 @@
 
 #include <q/fx.hpp>
 #include <q/support.hpp>
+#include <inf/function_table.hpp>
 
 namespace cycfi { namespace infinity
 {
@@ -44,6 +45,12 @@ namespace cycfi { namespace infinity
    //          static constexpr float high_threshold = 0.05f;
    //       };
    //
+   //    The Config values may be overridden at construction time (e.g. for
+   //    tuning, see tuning.hpp).
+   //
+   //    The gain (1 / envelope) is looked up from a compile-time table (see
+   //    function_table.hpp), good for a max_gain of up to 128.
+   //
    ////////////////////////////////////////////////////////////////////////////
    template <typename Config>
    struct agc
@@ -53,8 +60,16 @@ namespace cycfi { namespace infinity
       static constexpr float high_threshold = Config::high_threshold;
 
       agc(float decay, uint32_t sps)
-       : _env_follow(decay, sps)
+       : agc(decay, sps, max_gain, low_threshold, high_threshold)
+      {}
+
+      agc(
+         float decay, uint32_t sps
+       , float max_gain_, float low_threshold_, float high_threshold_)
+       : _noise_gate{ low_threshold_, high_threshold_ }
+       , _env_follow(decay, sps)
        , _dc_block(10.0f /* hz */, sps)
+       , _max_gain(max_gain_)
       {}
 
       float operator()(float s)
@@ -70,10 +85,9 @@ namespace cycfi { namespace infinity
 				return 0;
 
          // Automatic gain control
-         _gain = q::fast_inverse(env);
-         if (_gain > max_gain)
-            _gain = max_gain;
-         // _gain = q::fast_inverse(env);
+         _gain = inverse_table{}(env);
+         if (_gain > _max_gain)
+            _gain = _max_gain;
          return s * _gain;
       }
 
@@ -87,10 +101,21 @@ namespace cycfi { namespace infinity
          return _env_follow();
       }
 
-      q::window_comparator _noise_gate = { low_threshold, high_threshold };
+      // 1 / envelope, for envelopes from 1/128 (the gain is clamped to
+      // max_gain below 1 / max_gain anyway)
+      struct inverse_function : table_functions::inverse
+      {
+         static constexpr double min = 1.0 / 128;
+         static constexpr double max = 2.0;
+      };
+
+      using inverse_table = function_table<inverse_function, 2048>;
+
+      q::window_comparator _noise_gate;
       q::envelope_follower _env_follow;
       q::dc_block          _dc_block;
       float                _gain = { 1.0f };
+      float                _max_gain;
    };
 }}
 
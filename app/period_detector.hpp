@@ -8,6 +8,7 @@
 
 #include <q/fx.hpp>
 #include <cmath>
+#include "tuning.hpp"
 
 namespace cycfi { namespace infinity
 {
@@ -97,10 +98,10 @@ namespace cycfi { namespace infinity
       void compute_min_max(int mean)
       {
          // Compute the _min and _max (approximately 1 semitone
-         // below and above val).
-         int mean_div_16 = mean / 16;
-         _max = mean + mean_div_16;
-         _min = mean - mean_div_16;
+         // below and above val, see tuning.hpp).
+         int window = mean / tuning().period_window;
+         _max = mean + window;
+         _min = mean - window;
       }
 
       float operator()() const
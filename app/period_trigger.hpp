@@ -7,6 +7,7 @@
 #define CYCFI_INFINITY_PERIOD_TRIGGER_HPP_FEBRUARY_11_2016
 
 #include <q/fx.hpp>
+#include "tuning.hpp"
 
 namespace cycfi { namespace infinity
 {
@@ -14,26 +15,25 @@ namespace cycfi { namespace infinity
    // The peak_trigger generates pulses that coincide with the peaks of a
    // waveform. This is accomplished by sending the signal through an envelope
    // follower and comparing the (slightly attenuated) result with the
-   // original signal using a schmitt_trigger.
+   // original signal using a schmitt_trigger. The hysteresis and the drop
+   // (attenuation) are set by tuning() (see tuning.hpp).
    //
    // The result is a bool corresponding to the peaks.
    ////////////////////////////////////////////////////////////////////////////
    struct peak_trigger
    {
-      static constexpr float hysteresis = 0.002f;
-      static constexpr float drop = 0.80f;
-
       peak_trigger(float r)
-       : _ef(r), _cmp(hysteresis)
+       : _ef(r), _cmp(tuning().peak_hysteresis), _drop(tuning().peak_drop)
       {}
 
       bool operator()(float s)
       {
-         return _cmp(s, _ef(s) * drop);
+         return _cmp(s, _ef(s) * _drop);
       }
 
       q::envelope_follower _ef;
       q::schmitt_trigger   _cmp;
+      float                _drop;
    };
 
    ////////////////////////////////////////////////////////////////////////////
@@ -65,8 +65,6 @@ namespace cycfi { namespace infinity
    ////////////////////////////////////////////////////////////////////////////
    struct period_trigger
    {
-      static constexpr float dead_zone = 0.5;
-
       int operator()(float s, bool active = true)
       {
          if (!active)
@@ -76,7 +74,7 @@ namespace cycfi { namespace infinity
          }
 
          // kill dead-zone
-         if (s < dead_zone && s > -dead_zone)
+         if (s < _dead_zone && s > -_dead_zone)
             s = 0.0f;
 
          // Detect the peaks
@@ -95,6 +93,7 @@ namespace cycfi { namespace infinity
 
       peak_trigger   _pos_peak = {0.999};
       peak_trigger   _neg_peak = {0.999};
+      float          _dead_zone = tuning().dead_zone;
       int            _state = 0;
    };
 }}
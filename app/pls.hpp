@@ -10,6 +10,9 @@
 #include "agc.hpp"
 #include "period_trigger.hpp"
 #include "period_detector.hpp"
+#include "tuning.hpp"
+#include <inf/profiler.hpp>
+#include <inf/trace.hpp>
 #include <cmath>
 
 namespace cycfi { namespace infinity
@@ -34,7 +37,12 @@ namespace cycfi { namespace infinity
       enum { stop, wait, run, release };
 
       pls(Synth& synth_)
-       : _agc(0.05f /* seconds */, sps)
+       : _agc(
+            0.05f /* seconds */, sps
+          , tuning().agc_max_gain
+          , tuning().agc_low_threshold
+          , tuning().agc_high_threshold
+         )
        , _synth(synth_)
        , _start_phase(synth_.shift())
        , _target_phase(_start_phase)
@@ -43,15 +51,23 @@ namespace cycfi { namespace infinity
       float operator()(float s, uint32_t sample_clock)
       {
          bool was_active = _agc.active();
-         auto agc_out = _agc(s);
+         auto agc_out = profile(profile_id::agc, [&]{ return _agc(s); });
          int prev_state = _trig();
          bool is_active = _agc.active();
 
+         if (was_active != is_active)
+         {
+            trace(
+               is_active? trace_event::gate_open : trace_event::gate_close
+             , sample_clock, _channel
+            );
+         }
+
          // If we're not active, start the deactivation process
          if (!is_active)
-            return deactivate();
+            return deactivate(sample_clock);
 
-         int state = _trig(agc_out, is_active);
+         int state = profile(profile_id::trigger, [&]{ return _trig(agc_out, is_active); });
          bool onset = !was_active && is_active;
 
          // Update phase every 512 clock cycles
@@ -60,10 +76,14 @@ namespace cycfi { namespace infinity
 
          if (prev_state != state && state)
          {
+            auto period = sample_clock - _edge_start;
+            trace(trace_event::edge, sample_clock, _channel
+             , std::uint16_t(period < 0xffff? period : 0xffff));
+
             if (!onset)
                sync(sample_clock);
             else
-               _stage = wait;
+               stage(wait, sample_clock);
             _edge_start = sample_clock;
          }
 
@@ -71,13 +91,13 @@ namespace cycfi { namespace infinity
          _synth.shift(_shift_lp(_target_phase));
 
          // Synthesize!
-         auto val = _synth();
+         auto val = profile(profile_id::synth, [&]{ return _synth(); });
 
          // Avoid synthesizer startup glitch. Wait for zero-crossing.
          if (_stage == wait)
          {
             if (_synth.is_start())
-               _stage = run;
+               stage(run, sample_clock);
             else
                return 0.0f;
          }
@@ -89,17 +109,44 @@ namespace cycfi { namespace infinity
          return _agc.envelope();
       }
 
+      // The detected period (samples). Zero until the first sync.
+      float period() const
+      {
+         return _cycles? _period_lp() : 0.0f;
+      }
+
+      // The synth's phase error: the difference between the target phase
+      // and the (smoothed) phase shift, in cycles (-0.5 to 0.5)
+      float phase_error() const
+      {
+         auto err = std::int32_t(_target_phase - _synth.shift());
+         return err / 4294967296.0f;
+      }
+
+      bool active() const
+      {
+         return _stage != stop;
+      }
+
+      // The channel tagged on the trace events (see trace.hpp)
+      void channel(std::uint8_t ch)
+      {
+         _channel = ch;
+      }
+
    private:
 
       struct agc_config
       {
-         static constexpr float max_gain = 50.0f;
-         static constexpr float low_threshold = 0.01f;
-         static constexpr float high_threshold = 0.05f;
+         static constexpr float max_gain = default_tuning.agc_max_gain;
+         static constexpr float low_threshold = default_tuning.agc_low_threshold;
+         static constexpr float high_threshold = default_tuning.agc_high_threshold;
       };
 
       void sync(uint32_t sample_clock)
       {
+         profile_scope scope{ profile_id::detector };
+
          if (_cycles++)
             _period_lp(sample_clock-_edge_start);
          else
@@ -121,11 +168,20 @@ namespace cycfi { namespace infinity
             if (_cycles == 1)
                _shift_lp.y = _target_phase;
             _sync = false; // done sync
+
+            trace(trace_event::sync, sample_clock, _channel
+             , std::uint16_t(_target_phase >> 16));
          }
       }
 
+      void stage(int stage_, uint32_t sample_clock)
+      {
+         _stage = stage_;
+         trace(trace_event::stage, sample_clock, _channel, stage_);
+      }
+
       // Release the synth
-      float deactivate()
+      float deactivate(uint32_t sample_clock)
       {
          switch (_stage)
          {
@@ -136,13 +192,13 @@ namespace cycfi { namespace infinity
                return 0.0f;
 
             case run:
-               _stage = release;
+               stage(release, sample_clock);
                // fall through...
 
             case release: // continue until the next start phase
                if (_synth.is_start())
                {
-                  _stage = stop;
+                  stage(stop, sample_clock);
                   return 0.0f;
                }
                return _synth();
@@ -153,8 +209,8 @@ namespace cycfi { namespace infinity
       agc<agc_config>      _agc;
       period_trigger       _trig;
       Synth&               _synth;
-      period_detector      _period_lp = { 0.4 };
-      q::one_pole_lp       _shift_lp = { 0.001 };
+      period_detector      _period_lp = { tuning().period_lp };
+      q::one_pole_lp       _shift_lp = { tuning().shift_lp };
       int                  _stage = stop;
       uint32_t             _cycles = 0;
       q::phase_t           _start_phase;
@@ -162,6 +218,7 @@ namespace cycfi { namespace infinity
       q::phase_t           _target_phase = 0;
       q::phase_t           _prev_freq = 0;
       bool                 _sync = false;
+      std::uint8_t         _channel = 0;
    };
 }}
 
@@ -6,64 +6,165 @@
 #include <inf/multi_processor.hpp>
 #include <inf/app.hpp>
 #include <inf/support.hpp>
+#include <inf/mailbox.hpp>
+#include <inf/capture.hpp>
+#include <inf/trace.hpp>
+#include <inf/telemetry.hpp>
+#include <inf/uart.hpp>
+#include <inf/static_memory.hpp>
 #include <q/synth.hpp>
 
-#include "sustainer.hpp"
+#include "sustain_processor.hpp"
 #include "ui.hpp"
 
 #include <array>
 
+#if defined(INFINITY_HOST)
+# include <inf/host/capture.hpp>
+using cycfi::infinity::host::replaying;
+#else
+constexpr bool replaying() { return false; }
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 // Phase-Locked Synthesizer sustain test with PID
 //
 // Setup: Connect input signals to ADC channels 0, 1 and 2. Connect
 // pins PA4 (DAC out) to the sustain driver.
+//
+// Define INFINITY_CAPTURE to record the raw ADC data and the level changes
+// (see capture.hpp). On the host, the capture is written to the --capture
+// file, and can be replayed with --replay. On the target, the raw ADC data
+// (3 x 16 bits at 80kHz, 480kB/s) far exceeds what the telemetry UART can
+// carry, so the capture is not streamed. Instead, the ring buffer keeps
+// the most recent window, overwriting the oldest chunks, for a debugger to
+// dump (proc._capture, from _tail to _head, with the header in _info).
+//
+// Define INFINITY_TRACE to record the pls events and the level changes in
+// the trace ring (see trace.hpp). On the host, the trace is written to the
+// --trace file at the end of the simulation.
+//
+// Define INFINITY_TELEMETRY to stream the state of the sustainers and the
+// CPU load (see telemetry.hpp) at telemetry_rate over USART2 (TX: PA2,
+// the ST-LINK virtual COM port on Nucleo boards), 230400 baud, 8N1. View
+// with tools/telemetry_view.cpp. On the host, the stream is written to the
+// --uart file.
 ///////////////////////////////////////////////////////////////////////////////
 namespace inf = cycfi::infinity;
 namespace q = cycfi::q;
 using inf::delay_ms;
+using namespace inf::sustain_constants;
 
 ///////////////////////////////////////////////////////////////////////////////
 // Our UI
 inf::ui ui;
 
 ///////////////////////////////////////////////////////////////////////////////
-// Our multi-processor
-static constexpr auto clock = 80000;
-static constexpr auto sps_div = 4;
-static constexpr auto sps = clock / sps_div;
+// Our multi-processor (see sustain_processor.hpp for the constants)
+
+// The capture ring buffer size. On the host, it must hold the blocks
+// captured while the main loop is busy (e.g. refreshing the display). On
+// the target, it is the size of the most recent window (about 5 blocks).
+#if defined(INFINITY_HOST)
+static constexpr std::size_t capture_size = 1 << 20;
+static constexpr auto capture_overflow = inf::capture_overflow::drop;
+#else
+static constexpr std::size_t capture_size = 16384;
+static constexpr auto capture_overflow = inf::capture_overflow::overwrite;
+#endif
+
+#if defined(INFINITY_TELEMETRY)
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry
+static constexpr auto telemetry_rate = 50;   // Hz (approximately)
 
-struct my_processor
+inf::uart_tx<inf::port::porta + 2, 230400> uart;
+inf::telemetry_stream<> telemetry;
+#endif
+
+struct my_processor : inf::sustain_processor<strings>
 {
-   static constexpr auto oversampling = sps_div;
    static constexpr auto adc_id = 1;
    static constexpr auto timer_id = 2;
-   static constexpr auto channels = 3;
-   static constexpr auto sampling_rate = clock;
-   static constexpr auto buffer_size = 1024;
-   static constexpr auto latency = buffer_size / sps_div;
+   static constexpr auto sampling_rate = adc_clock;
+   static constexpr auto buffer_size = inf::sustain_constants::buffer_size;
+
+   // Samples per block, per channel
+   static constexpr auto block_samples = buffer_size / (2 * oversampling);
 
-   void process(std::array<float, 2>& out, float s, std::uint32_t channel)
+   // Called at the start of each block, from the DSP interrupt
+   void begin_block()
    {
-      out[0] += _sustainers[channel](s, _sample_clock);
-      out[1] += s;
+      if (sustain_processor::begin_block())
+      {
+         auto level = current_level();
+         inf::trace(inf::trace_event::param, _sample_clock, param_level, inf::trace_unorm(level));
+#if defined(INFINITY_CAPTURE)
+         _capture.param(param_level, level);
+#endif
+      }
+#if defined(INFINITY_TELEMETRY)
+      send_telemetry();
+#endif
+   }
+
+#if defined(INFINITY_TELEMETRY)
+   static constexpr auto telemetry_decimation =
+      std::max(sps / (block_samples * telemetry_rate), 1);
 
-      if (channel == channels-1)
-         ++_sample_clock;
+   void send_telemetry()
+   {
+      if (++_telemetry_count < telemetry_decimation)
+         return;
+      _telemetry_count = 0;
+
+      for (std::size_t i = 0; i != channels; ++i)
+      {
+         auto const& s = _sustainers[i];
+         inf::telemetry_string frame;
+         frame.sample_clock = _sample_clock;
+         frame.channel = i;
+         frame.flags = s.active()? inf::telemetry_string::active : 0;
+         frame.period = s.period();
+         frame.phase_error = s.phase_error();
+         frame.envelope = s.envelope();
+         frame.level = s.level();
+         telemetry.push(frame);
+      }
+
+      inf::telemetry_system sys;
+      if (_system.read(sys))
+      {
+         sys.sample_clock = _sample_clock;
+         sys.dropped = telemetry.dropped();
+         telemetry.push(sys);
+      }
    }
 
-   void update_level(float level)
+   // Called from the main loop with the latest CPU load and error
+   // counters. Sent with the next telemetry frames.
+   void update_system(inf::telemetry_system const& sys)
    {
-      constexpr float max = 1.0f / channels;
-      for (auto& s : _sustainers)
-         s.update_level(ui.level(), max);
+      _system.write(sys);
    }
 
-   using sustainer_type = inf::sustainer<sps, latency>;
-   using sustainer_array_type = std::array<sustainer_type, channels>;
+   inf::mailbox<inf::telemetry_system> _system;
+   int                     _telemetry_count = 0;
+#endif
+
+#if defined(INFINITY_CAPTURE)
+   // Called with the raw ADC data of each block, from the DSP interrupt
+   template <typename Iter>
+   void capture(Iter src)
+   {
+      _capture.frames(src);
+   }
 
-   sustainer_array_type _sustainers;
-   uint32_t             _sample_clock = 0;
+   inf::capture_recorder<
+      channels, buffer_size / 2, capture_size, capture_overflow
+   >
+   _capture;
+#endif
 };
 
 inf::multi_channel_processor<inf::processor<my_processor>> proc;
@@ -72,13 +173,51 @@ inf::multi_channel_processor<inf::processor<my_processor>> proc;
 // Configuration
 auto config = inf::config(
    ui.setup(),
+#if defined(INFINITY_TELEMETRY)
+   uart.setup(
+      []()
+      {
+         telemetry.sent();
+         telemetry.poll(uart);
+      }),
+#endif
    proc.config<0, 1, 2>()
 );
 
+#if !defined(INFINITY_HOST)
+///////////////////////////////////////////////////////////////////////////////
+// RAM budget (see static_memory.hpp): the STM32F446's 128K SRAM, less 16K
+// for the stack, the HAL and the libraries.
+static_assert(
+   inf::ram_budget<
+      112 * 1024
+    , decltype(proc)
+    , decltype(ui)
+#if defined(INFINITY_TELEMETRY)
+    , decltype(telemetry)
+#endif
+   >::ok
+ , "RAM budget exceeded"
+);
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 // The main loop
 void start()
 {
+#if defined(INFINITY_CAPTURE)
+   proc._capture.start(my_processor::sampling_rate, my_processor::oversampling);
+#endif
+#if defined(INFINITY_HOST)
+   // Replayed level changes
+   inf::host::param_handler(
+      [](std::uint32_t id, float value)
+      {
+         if (id == param_level)
+            proc.update_level(value);
+      });
+#endif
+
    proc.start();
    ui.start();
 
@@ -86,8 +225,23 @@ void start()
    {
       ui.refresh();
 
-      // Update the sustain level
-      proc.update_level(ui.level());
+      // Update the sustain level. Replays bring their own level updates.
+      if (!replaying())
+         proc.update_level(ui.level());
+
+      // On the target, the capture is not drained (see above)
+#if defined(INFINITY_CAPTURE) && defined(INFINITY_HOST)
+      proc._capture.flush(inf::host::capture_write);
+#endif
+#if defined(INFINITY_TELEMETRY)
+      inf::telemetry_system sys;
+      sys.load = proc.load();
+      sys.peak_load = proc.peak_load();
+      sys.tier = proc.load_tier();
+      sys.deadline_misses = proc.deadline_misses();
+      proc.update_system(sys);
+      telemetry.poll(uart);
+#endif
       delay_ms(10);
    }
 }
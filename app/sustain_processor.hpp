@@ -0,0 +1,153 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_SUSTAIN_PROCESSOR_HPP_NOVEMBER_28_2017)
+#define CYCFI_INFINITY_SUSTAIN_PROCESSOR_HPP_NOVEMBER_28_2017
+
+#include <inf/mailbox.hpp>
+#include "sustainer.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // The constants of the sustain app. The ADC samples at adc_clock, with
+   // sps_div oversampling, so the sustainers run at sps.
+   ////////////////////////////////////////////////////////////////////////////
+   namespace sustain_constants
+   {
+      constexpr auto adc_clock = 80000;
+      constexpr auto sps_div = 4;
+      constexpr auto sps = adc_clock / sps_div;
+      constexpr auto buffer_size = 1024;  // The ADC buffer (two blocks)
+      constexpr auto latency = buffer_size / sps_div;
+      constexpr auto strings = 3;         // The strings sharing the level
+
+      // Captured parameters (see capture.hpp)
+      enum : std::uint32_t { param_level };
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // sustain_processor: The processing of the sustain app, one sustainer
+   // (see sustainer.hpp) per channel, as a Base for processor (see
+   // processor.hpp). The firmware (app/start.cpp) adds the
+   // multi_channel_processor settings, capture and telemetry. The offline
+   // batch processor (tools/batch.cpp) runs it over recorded takes, one
+   // channel at a time.
+   //
+   // The level is written from the main loop (update_level) and picked up
+   // at the start of the next block (begin_block). The level PID steps
+   // once per update, so the main loop writes the level every 10ms, even
+   // if it did not change.
+   //
+   // Load tiers (see multi_processor.hpp and governor.hpp):
+   //
+   //    0  Full quality.
+   //
+   //    1  Skip the idle channels. The sustainer of a channel that is not
+   //       active is not run until its input reaches the AGC's low
+   //       (gate close) threshold. It then runs for at least wake_hold
+   //       samples, so it sees its envelope rise through the gate open
+   //       threshold the way it does at tier 0. Idle channels output
+   //       nothing anyway.
+   //
+   // - channels:      The number of channels
+   // - oversampling:  The ADC oversampling factor (1 for samples that are
+   //                  already at sps)
+   ////////////////////////////////////////////////////////////////////////////
+   template <int channels_, int oversampling_ = sustain_constants::sps_div>
+   struct sustain_processor
+   {
+      static constexpr auto oversampling = oversampling_;
+      static constexpr auto channels = channels_;
+      static constexpr auto latency = sustain_constants::latency;
+      static constexpr std::size_t load_tiers = 1;
+      static constexpr std::uint32_t wake_hold = sustain_constants::sps / 20;
+
+      sustain_processor()
+       : _wake_threshold(tuning().agc_low_threshold)
+      {
+         for (std::size_t i = 0; i != channels; ++i)
+            _sustainers[i].channel(i);
+         _wake.fill(std::uint32_t{ wake_hold });
+      }
+
+      void process(std::array<float, 2>& out, float s, std::uint32_t channel)
+      {
+         if (!skip(channel, s))
+            out[0] += _sustainers[channel](s, _sample_clock);
+         out[1] += s;
+
+         if (channel == channels-1)
+            ++_sample_clock;
+      }
+
+      // Called at the start of each block. Returns true if a new level was
+      // picked up (see current_level).
+      bool begin_block()
+      {
+         constexpr float max = 1.0f / sustain_constants::strings;
+         if (!_level.read(_current_level))
+            return false;
+         for (auto& s : _sustainers)
+            s.update_level(_current_level, max);
+         return true;
+      }
+
+      // Called from the main loop. The new level is picked up at the start
+      // of the next block (see begin_block).
+      void update_level(float level)
+      {
+         _level.write(level);
+      }
+
+      // The latest level picked up by begin_block
+      float current_level() const
+      {
+         return _current_level;
+      }
+
+      // Called from the DSP interrupt when the load tier changes
+      void degrade(std::size_t tier)
+      {
+         _skip_idle = tier >= 1;
+      }
+
+      // Tier 1: true if the channel is idle and its sustainer can be
+      // skipped for sample s
+      bool skip(std::uint32_t channel, float s)
+      {
+         auto& wake = _wake[channel];
+         if (!_skip_idle || _sustainers[channel].active()
+            || std::abs(s) >= _wake_threshold)
+         {
+            wake = wake_hold;
+            return false;
+         }
+         if (wake == 0)
+            return true;
+         --wake;
+         return false;
+      }
+
+      using sustainer_type = sustainer<sustain_constants::sps, latency>;
+      using sustainer_array_type = std::array<sustainer_type, channels>;
+
+      sustainer_array_type    _sustainers;
+      uint32_t                _sample_clock = 0;
+      mailbox<float>          _level;
+      float                   _current_level = 0.0f;
+
+      // Load tiers
+      bool                    _skip_idle = false;
+      float                   _wake_threshold;
+      std::array<std::uint32_t, channels> _wake;
+   };
+}}
+
+#endif
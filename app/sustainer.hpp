@@ -38,6 +38,34 @@ namespace cycfi { namespace infinity
          return _pls.envelope();
       }
 
+      // The pls state, for telemetry (see pls.hpp)
+      float period() const
+      {
+         return _pls.period();
+      }
+
+      float phase_error() const
+      {
+         return _pls.phase_error();
+      }
+
+      bool active() const
+      {
+         return _pls.active();
+      }
+
+      // The drive level (see update_level)
+      float level() const
+      {
+         return _level;
+      }
+
+      // The channel tagged on the trace events (see trace.hpp)
+      void channel(std::uint8_t ch)
+      {
+         _pls.channel(ch);
+      }
+
       // Update the level. This should be called approximately
       // every 10ms (or adjust level_pid_config sps accordingly).
       void update_level(float level, float max)
@@ -102,6 +130,34 @@ namespace cycfi { namespace infinity
          return _pls.envelope();
       }
 
+      // The pls state, for telemetry (see pls.hpp)
+      float period() const
+      {
+         return _pls.period();
+      }
+
+      float phase_error() const
+      {
+         return _pls.phase_error();
+      }
+
+      bool active() const
+      {
+         return _pls.active();
+      }
+
+      // The drive level (see update_level)
+      float level() const
+      {
+         return _level;
+      }
+
+      // The channel tagged on the trace events (see trace.hpp)
+      void channel(std::uint8_t ch)
+      {
+         _pls.channel(ch);
+      }
+
       // Update the level. This should be called approximately
       // every 10ms (or adjust level_pid_config sps accordingly).
       void update_level(float level, float max)
@@ -0,0 +1,62 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_TUNING_HPP_NOVEMBER_27_2017)
+#define CYCFI_INFINITY_TUNING_HPP_NOVEMBER_27_2017
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // The hand-tuned constants of the pls (see pls.hpp) and its building
+   // blocks, in one place.
+   //
+   // On the target, tuning() returns a constexpr reference to the defaults,
+   // so the constants are compile-time constants, as before. On host
+   // builds (INFINITY_HOST), tuning() returns a per-thread instance that
+   // can be modified at runtime, for example, by a parameter sweep that
+   // evaluates different tunings in parallel threads (see
+   // tools/pls_tune.cpp). The values are read when the blocks are
+   // constructed, or while processing, so modify them before constructing
+   // the pls.
+   ////////////////////////////////////////////////////////////////////////////
+   struct pls_tuning
+   {
+      // AGC (see agc.hpp)
+      float    agc_max_gain = 50.0f;
+      float    agc_low_threshold = 0.01f;
+      float    agc_high_threshold = 0.05f;
+
+      // peak_trigger and period_trigger (see period_trigger.hpp)
+      float    peak_hysteresis = 0.002f;
+      float    peak_drop = 0.80f;
+      float    dead_zone = 0.5f;
+
+      // period_detector (see period_detector.hpp). The window is
+      // mean / period_window around the mean period (16: approximately
+      // one semitone).
+      int      period_window = 16;
+      float    period_lp = 0.4f;
+
+      // pls phase shift low-pass coefficient (see pls.hpp)
+      float    shift_lp = 0.001f;
+   };
+
+   constexpr pls_tuning default_tuning = {};
+
+#if defined(INFINITY_HOST)
+   inline pls_tuning& tuning()
+   {
+      static thread_local pls_tuning t;
+      return t;
+   }
+#else
+   constexpr pls_tuning const& tuning()
+   {
+      return default_tuning;
+   }
+#endif
+}}
+
+#endif
@@ -58,6 +58,7 @@ namespace cycfi { namespace infinity
       mode_button_type  mode_btn;
       oled_type_ptr     cnv;
       mode_enum         mode = mode_enum::level;
+      char const*       label = nullptr;
 
       param_type        level_enc   { enc, 0.5, 0, 1, 0.001 };
       param_type        phase_enc   { enc, 0, -1, 2, 0.0001 };
@@ -135,21 +136,38 @@ namespace cycfi { namespace infinity
 
    void ui::display(char const* str, int val, int frac)
    {
-      cnv->clear();
-      cnv->draw_string(str, 15, 8, medium_font);
+      // Redraw the label only when it changes. Otherwise, erase only the
+      // value, so that refresh sends only the value's columns (see
+      // ssd1306::refresh).
+      static constexpr auto value_x = 70;
+      if (str != label)
+      {
+         cnv->clear();
+         cnv->draw_string(str, 15, 8, medium_font);
+         label = str;
+      }
+      else
+      {
+         cnv->fill_rect(
+            value_x, 8, canvas_type::width - value_x, 16
+          , monochrome::color::black
+         );
+      }
 
       if (val < 99999)
       {
          char out[8];
          to_string(val, out, frac);
-         cnv->draw_string(out, 70, 8, medium_font);
+         cnv->draw_string(out, value_x, 8, medium_font);
       }
       else
       {
-         cnv->draw_string("over", 70, 8, medium_font);
+         cnv->draw_string("over", value_x, 8, medium_font);
       }
 
-      cnv->refresh();
+      // Does not wait for the transfer (see ssd1306::refresh_async): the
+      // main loop, and the level updates, are not held up by the display.
+      cnv->refresh_async();
    }
 }}
 
@@ -0,0 +1,214 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/buffer.hpp>
+#include <inf/mirrored_buffer.hpp>
+#include <inf/delay.hpp>
+#include <inf/modulated_delay.hpp>
+#include <inf/interpolation.hpp>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Host microbenchmark: ring buffer reads. Compares buffer (heap and fixed
+// capacity storage), where each read masks the index, with mirrored_buffer
+// (see mirrored_buffer.hpp), where reads need no masking and the latest N
+// samples are contiguous:
+//
+//    taps     Per sample: push, then 4 linearly interpolated taps at
+//             moving fractional positions (as in a modulated delay)
+//    block    Per sample: push, then a 64 tap dot product with the latest
+//             samples (as in a correlation or FIR kernel), with 4 partial
+//             sums. The mirrored version uses a plain pointer loop
+//             (data()), which the compiler can vectorize.
+//    delay    A 1000 sample single_delay, one sample at a time, and with
+//             the block operations, in blocks of 128 samples
+//    chorus   4 linearly interpolated, slowly moving taps: the
+//             multi-tapped delay one sample at a time, with the taps moved
+//             every sample, and modulated_delay in blocks of 128 samples,
+//             with the taps moved every block (ramped over the block)
+//    steady   The same, with fixed taps
+//
+// Build (host): g++ -O3 -std=c++14 -DINFINITY_HOST -I inc bench/buffer_bench.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::size_t size = 1024;
+constexpr std::size_t num_taps = 4;
+constexpr std::size_t kernel_size = 64;
+constexpr std::size_t num_samples = 1 << 16;
+constexpr int iterations = 20;
+
+using heap_buffer = inf::buffer<float>;
+using fixed_buffer = inf::fixed_buffer<float, size>;
+using mirrored_buffer = inf::mirrored_buffer<float, size>;
+
+std::vector<float> input;
+std::array<float, kernel_size> kernel;
+
+template <typename Buffer>
+float taps(Buffer& b)
+{
+   inf::sample_interpolation::linear interpolate;
+   float result = 0.0f;
+   float pos[num_taps] = { 10.25f, 200.5f, 511.75f, 1000.125f };
+   for (auto s : input)
+   {
+      b.push(s);
+      for (auto& p : pos)
+      {
+         result += interpolate(b, p);
+         p += 0.01f;
+         if (p >= size - 1)
+            p -= size - 2;
+      }
+   }
+   return result;
+}
+
+template <typename Buffer>
+float block(Buffer& b)
+{
+   float result = 0.0f;
+   for (auto s : input)
+   {
+      b.push(s);
+      float sum[4] = {};
+      for (std::size_t i = 0; i != kernel_size; i += 4)
+         for (std::size_t j = 0; j != 4; ++j)
+            sum[j] += b[i + j] * kernel[i + j];
+      result += (sum[0] + sum[1]) + (sum[2] + sum[3]);
+   }
+   return result;
+}
+
+float block(mirrored_buffer& b)
+{
+   float result = 0.0f;
+   for (auto s : input)
+   {
+      b.push(s);
+      auto p = b.data();
+      float sum[4] = {};
+      for (std::size_t i = 0; i != kernel_size; i += 4)
+         for (std::size_t j = 0; j != 4; ++j)
+            sum[j] += p[i + j] * kernel[i + j];
+      result += (sum[0] + sum[1]) + (sum[2] + sum[3]);
+   }
+   return result;
+}
+
+using delay_type = inf::fixed_single_delay<float, 1000>;
+
+float delay_samples(delay_type& d, std::vector<float>& out)
+{
+   for (std::size_t i = 0; i != num_samples; ++i)
+      out[i] = d(input[i]);
+   return out[num_samples - 1];
+}
+
+float delay_blocks(delay_type& d, std::vector<float>& out)
+{
+   constexpr std::size_t block_size = 128;
+   for (std::size_t i = 0; i != num_samples; i += block_size)
+      d(&input[i], &out[i], block_size);
+   return out[num_samples - 1];
+}
+
+using multi_tap_type = inf::fixed_delay<float, 1000, num_taps, inf::sample_interpolation::linear>;
+using modulated_type = inf::modulated_delay<float, 1000, num_taps, 128>;
+constexpr float chorus_delays[num_taps] = { 300.25f, 500.5f, 700.75f, 900.125f };
+
+float chorus_samples(multi_tap_type& d, std::vector<float>& out, float depth)
+{
+   auto add = [](float s, float mix) { return s + mix; };
+   for (std::size_t i = 0; i != num_samples; ++i)
+   {
+      for (std::size_t j = 0; j != num_taps; ++j)
+         d.taps[j].tsamples = chorus_delays[j] + depth * (i % 4096);
+      input[i] >> d;
+      out[i] = d(add);
+   }
+   return out[num_samples - 1];
+}
+
+float chorus_blocks(modulated_type& d, std::vector<float>& out, float depth)
+{
+   constexpr std::size_t block_size = 128;
+   for (std::size_t i = 0; i != num_samples; i += block_size)
+   {
+      for (std::size_t j = 0; j != num_taps; ++j)
+      {
+         auto delay = chorus_delays[j] + depth * ((i + block_size - 1) % 4096);
+         d.delay(j, delay, depth? block_size : 0);
+      }
+      d(&input[i], &out[i], block_size);
+   }
+   return out[num_samples - 1];
+}
+
+template <typename F>
+float bench(char const* name, F f)
+{
+   float sink = 0.0f;
+   auto start = clock_type::now();
+   for (int i = 0; i != iterations; ++i)
+      sink = f();
+   std::chrono::duration<double, std::nano> elapsed = clock_type::now() - start;
+
+   auto ns = elapsed.count() / (double(iterations) * num_samples);
+   std::printf("%-24s %8.3f ns/sample   (%g)\n", name, ns, sink);
+   return sink;
+}
+
+int main()
+{
+   std::mt19937 gen;
+   std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+   input.resize(num_samples);
+   for (auto& s : input)
+      s = dist(gen);
+   for (auto& k : kernel)
+      k = dist(gen);
+
+   // Check that all the buffers agree
+   {
+      heap_buffer b1(size);
+      fixed_buffer b2;
+      mirrored_buffer b3;
+      auto r1 = taps(b1), r2 = taps(b2), r3 = taps(b3);
+      auto k1 = block(b1), k2 = block(b2), k3 = block(b3);
+      if (r1 != r2 || r1 != r3 || k1 != k2 || k1 != k3)
+      {
+         std::printf("Buffer mismatch!\n");
+         return 1;
+      }
+   }
+
+   bench("taps, buffer", [] { heap_buffer b(size); return taps(b); });
+   bench("taps, fixed_buffer", [] { fixed_buffer b; return taps(b); });
+   bench("taps, mirrored_buffer", [] { mirrored_buffer b; return taps(b); });
+
+   bench("block, buffer", [] { heap_buffer b(size); return block(b); });
+   bench("block, fixed_buffer", [] { fixed_buffer b; return block(b); });
+   bench("block, mirrored_buffer", [] { mirrored_buffer b; return block(b); });
+
+   std::vector<float> out(num_samples);
+   bench("delay, per sample", [&] { delay_type d{ 1000 }; return delay_samples(d, out); });
+   bench("delay, block", [&] { delay_type d{ 1000 }; return delay_blocks(d, out); });
+
+   bench("chorus, per sample", [&] { multi_tap_type d; return chorus_samples(d, out, 1 / 64.0f); });
+   bench("chorus, modulated", [&] { modulated_type d; return chorus_blocks(d, out, 1 / 64.0f); });
+   bench("steady, per sample", [&] { multi_tap_type d; return chorus_samples(d, out, 0); });
+   bench("steady, modulated", [&] { modulated_type d; return chorus_blocks(d, out, 0); });
+   return 0;
+}
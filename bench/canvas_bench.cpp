@@ -0,0 +1,74 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/canvas.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+///////////////////////////////////////////////////////////////////////////////
+// Host microbenchmark: mono_canvas::draw_string for the three fonts, at a
+// byte aligned y and an unaligned y, and with a string clipped by the
+// right edge of the canvas (glyph by glyph, with bounds checks). The
+// glyphs are decoded from the packed fonts as they are drawn (see
+// canvas.cpp), so this is also the per-glyph decode cost.
+//
+// Build (host): g++ -O3 -std=c++14 -I inc bench/canvas_bench.cpp
+//    src/inf/canvas.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+using canvas_type = inf::mono_canvas<128, 64>;
+using font = inf::monochrome::font;
+using color = inf::monochrome::color;
+using clock_type = std::chrono::steady_clock;
+
+constexpr int iterations = 100000;
+constexpr int runs = 7;
+
+void bench(char const* name, char const* str, font font_, int x, int y)
+{
+   std::uint8_t buffer[canvas_type::size];
+   canvas_type cnv{ buffer };
+   auto const len = std::strlen(str);
+
+   // The best of a few runs
+   double ns = 1e9;
+   for (int run = 0; run != runs; ++run)
+   {
+      auto start = clock_type::now();
+      for (int i = 0; i != iterations; ++i)
+      {
+         cnv.draw_string(str, x, y, font_, color::white);
+         cnv.mark_clean();
+      }
+      std::chrono::duration<double, std::nano> elapsed = clock_type::now() - start;
+      ns = std::min(ns, elapsed.count() / iterations);
+   }
+
+   unsigned sink = 0;
+   for (auto b : buffer)
+      sink += b;
+
+   std::printf("%-28s %8.1f ns/string %6.1f ns/glyph   (%u)\n",
+      name, ns, ns / len, sink);
+}
+
+int main()
+{
+   bench("small, aligned", "Phase -12.5 dB", font::small, 2, 8);
+   bench("small, unaligned", "Phase -12.5 dB", font::small, 2, 11);
+   bench("small, clipped", "Phase -12.5 dB, level", font::small, 60, 11);
+
+   bench("medium, aligned", "Level 0.50", font::medium, 2, 8);
+   bench("medium, unaligned", "Level 0.50", font::medium, 2, 11);
+   bench("medium, clipped", "Level 0.50", font::medium, 70, 11);
+
+   bench("large, aligned", "12.34", font::large, 2, 0);
+   bench("large, unaligned", "12.34", font::large, 2, 13);
+   bench("large, clipped", "12.34", font::large, 90, 0);
+   return 0;
+}
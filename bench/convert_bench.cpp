@@ -0,0 +1,149 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/sample_convert.hpp>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+///////////////////////////////////////////////////////////////////////////////
+// Host microbenchmark: ADC sample conversion. Compares the per-sample,
+// lambda-based conversion in the processor loop, using the float division
+// (the original multi_channel_processor::convert) and the multiply-add
+// (sample_convert::to_float), with the block conversions to float and Q15
+// (see sample_convert.hpp).
+//
+// Build (host): g++ -O3 -std=c++14 -I inc bench/convert_bench.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::size_t resolution = 4096;
+constexpr std::size_t half_resolution = resolution / 2;
+constexpr std::size_t oversampling = 4;
+constexpr std::size_t channels = 6;
+constexpr std::size_t buffer_size = 1024;
+constexpr std::size_t frames = buffer_size / oversampling;
+constexpr int iterations = 20000;
+
+using sample_group_type = std::array<std::uint16_t, channels>;
+using adc_buffer_type = std::array<sample_group_type, buffer_size>;
+using frame_type = std::array<float, channels>;
+using q15_frame_type = std::array<std::int16_t, channels>;
+using converter = inf::sample_convert<resolution, oversampling>;
+
+// The original per-sample conversion, using a float division
+float convert(std::uint32_t sample)
+{
+   return (sample / float(half_resolution * oversampling)) - 1.0f;
+}
+
+// The processor's down-sampling loop with a convert function
+template <typename I2, typename Convert>
+float process(I2 src, Convert convert)
+{
+   float result = 0.0f;
+   for (std::size_t i = 0; i != frames; ++i)
+   {
+      for (std::size_t c = 0; c != channels; ++c)
+      {
+         auto src_base = src;
+         std::uint32_t val = 0;
+         for (std::size_t j = 0; j != oversampling; ++j)
+            val += (*src_base++)[c];
+         result += convert(val);
+      }
+      src += oversampling;
+   }
+   return result;
+}
+
+// The block conversion followed by the processing loop
+template <typename I2>
+float process_block(I2 src, std::array<frame_type, frames>& out)
+{
+   converter::block_to_float(src, src + buffer_size, out.begin());
+   float result = 0.0f;
+   for (auto const& frame : out)
+      for (auto s : frame)
+         result += s;
+   return result;
+}
+
+// The block conversion to Q15 followed by an integer processing loop
+template <typename I2>
+float process_block_q15(I2 src, std::array<q15_frame_type, frames>& out)
+{
+   converter::block_to_q15(src, src + buffer_size, out.begin());
+   std::int32_t result = 0;
+   for (auto const& frame : out)
+      for (auto s : frame)
+         result += s;
+   return result;
+}
+
+template <typename F>
+void bench(char const* name, F f)
+{
+   float sink = 0.0f;
+   auto start = clock_type::now();
+   for (int i = 0; i != iterations; ++i)
+      sink += f();
+   std::chrono::duration<double, std::nano> elapsed = clock_type::now() - start;
+
+   auto ns = elapsed.count() / (double(iterations) * buffer_size * channels);
+   std::printf("%-24s %8.3f ns/sample   (%g)\n", name, ns, sink);
+}
+
+int main()
+{
+   static adc_buffer_type adc;
+   static std::array<frame_type, frames> out;
+   static std::array<q15_frame_type, frames> q15_out;
+
+   std::mt19937 gen;
+   std::uniform_int_distribution<int> dist(0, resolution - 1);
+   for (auto& group : adc)
+      for (auto& s : group)
+         s = dist(gen);
+
+   // Check that both conversions agree
+   process_block(adc.begin(), out);
+   for (std::size_t c = 0; c != channels; ++c)
+   {
+      std::uint32_t sum = 0;
+      for (std::size_t j = 0; j != oversampling; ++j)
+         sum += adc[j][c];
+      if (convert(sum) != out[0][c])
+      {
+         std::printf("Conversion mismatch!\n");
+         return 1;
+      }
+   }
+
+   bench("lambda, division", [&]
+   {
+      return process(adc.begin(), [](std::uint32_t s) { return convert(s); });
+   });
+
+   bench("lambda, multiply-add", [&]
+   {
+      return process(adc.begin(), [](std::uint32_t s) { return converter::to_float(s); });
+   });
+
+   bench("block, float", [&]
+   {
+      return process_block(adc.begin(), out);
+   });
+
+   bench("block, Q15", [&]
+   {
+      return process_block_q15(adc.begin(), q15_out);
+   });
+   return 0;
+}
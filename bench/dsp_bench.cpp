@@ -0,0 +1,450 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/processor.hpp>
+#include <inf/sample_convert.hpp>
+#include <inf/delay.hpp>
+#include <inf/lut.hpp>
+#include <inf/pid.hpp>
+#include "../app/sustainer.hpp"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Host microbenchmark suite for the DSP blocks: agc, peak_trigger,
+// period_trigger, period_detector, pls, sustainer, pid, single_delay, lut
+// (and their heap-free fixed_single_delay and fixed_lut variants)
+// and the processor down-sampling loop, for 1 to 12 channels and several
+// ADC buffer sizes.
+//
+// Build (host): g++ -O3 -std=c++14 -DINFINITY_HOST -I inc -I q/q_lib/include
+//                  bench/dsp_bench.cpp -o dsp_bench
+//
+// Usage: dsp_bench [--json] [--channels <n> | <min>-<max>] [--only <block>]
+//                  [--min-time <ms>]
+//
+// Prints one record per block, channel count and buffer size, as CSV with
+// a header line (default) or as JSON lines (--json):
+//
+//    block          The DSP block
+//    channels       Number of channels
+//    buffer_size    ADC buffer size (in ADC samples, see multi_processor)
+//    frames         Samples per channel per block (half the ADC buffer,
+//                   down-sampled by the oversampling factor)
+//    ns_per_sample  Nanoseconds per sample (per channel)
+//    msps           Throughput in millions of samples per second
+//    realtime       Block period divided by the time it takes to process
+//                   the block (how many times faster than real time)
+//
+// The input is a synthetic guitar-like signal: each channel is a plucked
+// string (decaying harmonics) with a different fundamental, plucked again
+// every second, so the triggers and detectors do their normal amount of
+// work.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+namespace q = cycfi::q;
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::uint32_t adc_clock = 80000;
+constexpr std::uint32_t oversampling = 4;
+constexpr std::uint32_t sps = adc_clock / oversampling;
+constexpr std::uint32_t latency = 1024 / oversampling;
+constexpr std::size_t max_channels = 12;
+constexpr std::size_t signal_frames = 2 * sps;
+constexpr std::size_t buffer_sizes[] = { 256, 1024, 4096 };
+
+///////////////////////////////////////////////////////////////////////////////
+// The test signal, interleaved, max_channels per frame
+std::vector<float> make_signal()
+{
+   constexpr double _2pi = 2.0 * 3.14159265358979323846;
+   constexpr double open_strings[] = { 82.41, 110.0, 146.83, 196.0, 246.94, 329.63 };
+
+   std::vector<float> signal(signal_frames * max_channels);
+   for (std::size_t c = 0; c != max_channels; ++c)
+   {
+      // Channels 6 to 11 are an octave higher
+      auto f0 = open_strings[c % 6] * ((c < 6)? 1 : 2);
+      for (std::size_t i = 0; i != signal_frames; ++i)
+      {
+         auto t = double(i % sps) / sps;
+         auto env = std::exp(-3.0 * t);
+         double s = 0.0;
+         for (int h = 1; h <= 4; ++h)
+            s += std::sin(_2pi * f0 * h * t) * (1.0 / h) * std::exp(-2.0 * h * t);
+         signal[i * max_channels + c] = float(0.3 * env * s);
+      }
+   }
+   return signal;
+}
+
+std::vector<float> const& signal()
+{
+   static auto sig = make_signal();
+   return sig;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The DSP blocks. Each holds the state of one channel. operator() takes
+// one sample and returns one sample.
+struct agc_config
+{
+   static constexpr float max_gain = 50.0f;
+   static constexpr float low_threshold = 0.01f;
+   static constexpr float high_threshold = 0.05f;
+};
+
+struct agc_block
+{
+   float operator()(float s) { return _agc(s); }
+   inf::agc<agc_config> _agc = { 0.05f, sps };
+};
+
+struct peak_trigger_block
+{
+   float operator()(float s) { return _trig(s); }
+   inf::peak_trigger _trig = { 0.999f };
+};
+
+struct period_trigger_block
+{
+   float operator()(float s) { return _trig(s); }
+   inf::period_trigger _trig;
+};
+
+// Feeds the period detector with the periods between rising zero
+// crossings, the way the pls feeds it with the trigger edges.
+struct period_detector_block
+{
+   float operator()(float s)
+   {
+      ++_clock;
+      bool state = s > 0.0f;
+      if (state && !_state)
+      {
+         auto period = _clock - _edge;
+         _edge = _clock;
+         if (_cycles++)
+            _detector(period);
+         else
+            _detector = period;
+      }
+      _state = state;
+      return _detector();
+   }
+
+   inf::period_detector _detector = { 0.4 };
+   std::uint32_t _clock = 0;
+   std::uint32_t _edge = 0;
+   std::uint32_t _cycles = 0;
+   bool _state = false;
+};
+
+using sin_synth = decltype(q::sin(0.0, sps, 0.0));
+
+struct pls_block
+{
+   float operator()(float s) { return _pls(s, _clock++); }
+
+   sin_synth _synth = q::sin(0.0, sps, q::pi/4);
+   inf::pls<sin_synth, sps, latency> _pls = { _synth };
+   std::uint32_t _clock = 0;
+};
+
+struct sustainer_block
+{
+   float operator()(float s) { return _sustainer(s, _clock++); }
+
+   inf::sustainer<sps, latency> _sustainer;
+   std::uint32_t _clock = 0;
+};
+
+struct pid_block
+{
+   float operator()(float s) { return _pid(0.5, std::abs(s)); }
+   inf::pid<inf::level_pid_config> _pid;
+};
+
+struct delay_block
+{
+   float operator()(float s) { return _delay(s); }
+   inf::single_delay<float> _delay = { std::size_t(1000) };
+};
+
+// Fractional (linearly interpolated) reads behind a moving write position
+struct lut_block
+{
+   float operator()(float s)
+   {
+      s >> _lut;
+      _index += 0.37f;
+      if (_index >= 1000.0f)
+         _index -= 1000.0f;
+      return _lut[_index];
+   }
+
+   inf::lut<float> _lut = { 1024.0f };
+   float _index = 0.0f;
+};
+
+// The same, with in-place (compile-time capacity) storage
+struct fixed_delay_block
+{
+   float operator()(float s) { return _delay(s); }
+   inf::fixed_single_delay<float, 1000> _delay = { std::size_t(1000) };
+};
+
+struct fixed_lut_block
+{
+   float operator()(float s)
+   {
+      s >> _lut;
+      _index += 0.37f;
+      if (_index >= 1000.0f)
+         _index -= 1000.0f;
+      return _lut[_index];
+   }
+
+   inf::fixed_lut<float, 1024> _lut;
+   float _index = 0.0f;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Measurement
+struct result
+{
+   double ns_per_sample;
+   double msps;
+   double realtime;
+};
+
+double min_time = 0.02; // seconds
+float volatile sink;
+
+// Calls process(offset) for successive blocks of the test signal until
+// min_time has elapsed.
+template <typename Process>
+result measure(std::size_t channels, std::size_t frames, Process&& process)
+{
+   std::size_t const num_blocks = signal_frames / frames;
+   std::size_t block = 0;
+
+   // Warm up
+   for (std::size_t i = 0; i != num_blocks; ++i)
+      process(i * frames);
+
+   std::size_t count = 0;
+   auto start = clock_type::now();
+   std::chrono::duration<double> elapsed;
+   do
+   {
+      for (int i = 0; i != 16; ++i)
+      {
+         process(block * frames);
+         if (++block == num_blocks)
+            block = 0;
+      }
+      count += 16;
+      elapsed = clock_type::now() - start;
+   }
+   while (elapsed.count() < min_time);
+
+   double samples = double(count) * frames * channels;
+   double block_time = elapsed.count() / count;
+   return {
+      (elapsed.count() * 1e9) / samples,
+      samples / (elapsed.count() * 1e6),
+      (double(frames) / sps) / block_time
+   };
+}
+
+template <typename Block>
+result bench_block(std::size_t channels, std::size_t frames)
+{
+   std::unique_ptr<Block[]> blocks{ new Block[channels] };
+   auto const* sig = signal().data();
+
+   return measure(channels, frames,
+      [&](std::size_t offset)
+      {
+         float acc = 0.0f;
+         for (std::size_t i = offset; i != offset + frames; ++i)
+         {
+            auto const* frame = sig + (i * max_channels);
+            for (std::size_t c = 0; c != channels; ++c)
+               acc += blocks[c](frame[c]);
+         }
+         sink = acc;
+      }
+   );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The processor down-sampling loop (with a trivial process function)
+template <std::size_t channels_>
+struct decimation_base
+{
+   static constexpr auto oversampling = ::oversampling;
+   static constexpr auto channels = channels_;
+
+   void process(std::array<float, 2>& out, float s, std::uint32_t channel)
+   {
+      out[channel & 1] += s;
+   }
+};
+
+template <std::size_t channels>
+result bench_processor(std::size_t frames)
+{
+   using converter = inf::sample_convert<4096, oversampling>;
+   using sample_group_type = std::array<std::uint16_t, channels>;
+
+   // The ADC samples for the whole test signal
+   std::vector<sample_group_type> adc(signal_frames * oversampling);
+   auto const& sig = signal();
+   for (std::size_t i = 0; i != adc.size(); ++i)
+      for (std::size_t c = 0; c != channels; ++c)
+         adc[i][c] = std::lround(
+            (sig[(i / oversampling) * max_channels + c] + 1.0f) * 2047.0f);
+
+   std::vector<std::array<float, 2>> out(frames);
+   inf::processor<decimation_base<channels>> proc;
+
+   return measure(channels, frames,
+      [&](std::size_t offset)
+      {
+         proc.process(
+            out.begin(), out.end(), adc.begin() + (offset * oversampling),
+            [](std::uint32_t sample) { return converter::to_float(sample); }
+         );
+         sink = out[0][0];
+      }
+   );
+}
+
+template <std::size_t... i>
+auto processor_benches(std::index_sequence<i...>)
+{
+   using bench_fn = result(*)(std::size_t frames);
+   return std::array<bench_fn, sizeof...(i)>{{ &bench_processor<i + 1>... }};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Output
+bool json = false;
+
+void report(
+   char const* block, std::size_t channels, std::size_t buffer_size,
+   std::size_t frames, result r)
+{
+   if (json)
+   {
+      std::printf(
+         "{\"block\":\"%s\",\"channels\":%zu,\"buffer_size\":%zu,"
+         "\"frames\":%zu,\"ns_per_sample\":%.3f,\"msps\":%.3f,"
+         "\"realtime\":%.1f}\n",
+         block, channels, buffer_size, frames,
+         r.ns_per_sample, r.msps, r.realtime);
+   }
+   else
+   {
+      std::printf("%s,%zu,%zu,%zu,%.3f,%.3f,%.1f\n",
+         block, channels, buffer_size, frames,
+         r.ns_per_sample, r.msps, r.realtime);
+   }
+   std::fflush(stdout);
+}
+
+[[noreturn]] void usage(char const* name)
+{
+   std::fprintf(stderr,
+      "Usage: %s [--json] [--channels <n> | <min>-<max>] [--only <block>]"
+      " [--min-time <ms>]\n", name);
+   std::exit(EXIT_FAILURE);
+}
+
+int main(int argc, char const* argv[])
+{
+   std::size_t min_channels = 1;
+   std::size_t last_channels = max_channels;
+   std::string only;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      std::string opt = argv[i];
+      if (opt == "--json")
+      {
+         json = true;
+         continue;
+      }
+      if (i+1 == argc)
+         usage(argv[0]);
+      std::string arg = argv[++i];
+      if (opt == "--channels")
+      {
+         auto dash = arg.find('-');
+         min_channels = std::stoul(arg.substr(0, dash));
+         last_channels = (dash == std::string::npos)?
+            min_channels : std::stoul(arg.substr(dash+1));
+      }
+      else if (opt == "--only")
+         only = arg;
+      else if (opt == "--min-time")
+         min_time = std::stod(arg) / 1000;
+      else
+         usage(argv[0]);
+   }
+
+   if (min_channels < 1 || last_channels > max_channels || min_channels > last_channels)
+      usage(argv[0]);
+
+   using bench_fn = result(*)(std::size_t channels, std::size_t frames);
+   struct entry { char const* name; bench_fn f; };
+   entry const blocks[] =
+   {
+      { "agc",              &bench_block<agc_block> },
+      { "peak_trigger",     &bench_block<peak_trigger_block> },
+      { "period_trigger",   &bench_block<period_trigger_block> },
+      { "period_detector",  &bench_block<period_detector_block> },
+      { "pls",              &bench_block<pls_block> },
+      { "sustainer",        &bench_block<sustainer_block> },
+      { "pid",              &bench_block<pid_block> },
+      { "single_delay",     &bench_block<delay_block> },
+      { "lut",              &bench_block<lut_block> },
+      { "fixed_delay",      &bench_block<fixed_delay_block> },
+      { "fixed_lut",        &bench_block<fixed_lut_block> },
+   };
+   auto const processors = processor_benches(std::make_index_sequence<max_channels>{});
+
+   if (!json)
+      std::puts("block,channels,buffer_size,frames,ns_per_sample,msps,realtime");
+
+   for (auto buffer_size : buffer_sizes)
+   {
+      auto frames = buffer_size / 2 / oversampling;
+      for (auto ch = min_channels; ch <= last_channels; ++ch)
+      {
+         for (auto const& b : blocks)
+         {
+            if (only.empty() || only == b.name)
+               report(b.name, ch, buffer_size, frames, b.f(ch, frames));
+         }
+         if (only.empty() || only == "processor")
+            report("processor", ch, buffer_size, frames, processors[ch-1](frames));
+      }
+   }
+   return 0;
+}
@@ -0,0 +1,95 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/function_table.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Host microbenchmark: function tables (see function_table.hpp) against
+// the standard library functions. For each, the time per call and the
+// maximum error (relative to max(1, |f(x)|)) over random arguments in the
+// table's domain.
+//
+// Note: the host has fast hardware division and a fast libm. On the
+// Cortex-M4, there is no double precision FPU, sinf, expf and powf are
+// software, and a float division takes 14 cycles, so the tables gain
+// much more there.
+//
+// Build (host): g++ -O3 -std=c++14 -DINFINITY_HOST -I inc bench/function_table_bench.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+namespace tf = inf::table_functions;
+namespace si = inf::sample_interpolation;
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::size_t num_samples = 1 << 16;
+constexpr int iterations = 50;
+
+template <typename Domain>
+std::vector<float> arguments()
+{
+   std::mt19937 gen;
+   std::uniform_real_distribution<float> dist(Domain::min, Domain::max);
+   std::vector<float> args(num_samples);
+   for (auto& x : args)
+      x = dist(gen);
+   return args;
+}
+
+template <typename Domain, typename F, typename Ref>
+void bench(char const* name, F f, Ref ref)
+{
+   auto args = arguments<Domain>();
+
+   double error = 0;
+   for (auto x : args)
+   {
+      auto expected = ref(double(x));
+      auto e = std::abs(f(x) - expected) / std::max(1.0, std::abs(expected));
+      error = std::max(error, e);
+   }
+
+   float sink = 0.0f;
+   auto start = clock_type::now();
+   for (int i = 0; i != iterations; ++i)
+      for (auto x : args)
+         sink += f(x);
+   std::chrono::duration<double, std::nano> elapsed = clock_type::now() - start;
+
+   auto ns = elapsed.count() / (double(iterations) * num_samples);
+   std::printf("%-28s %8.3f ns/call   max error: %.2e   (%g)\n", name, ns, error, sink);
+}
+
+int main()
+{
+   auto sin_ref = [](double x) { return std::sin(x); };
+   auto exp_ref = [](double x) { return std::exp(x); };
+   auto log_ref = [](double x) { return std::log(x); };
+   auto db_ref = [](double x) { return std::pow(10.0, x / 20); };
+   auto inverse_ref = [](double x) { return 1 / x; };
+
+   bench<tf::sin>("std::sin", [](float x) { return std::sin(x); }, sin_ref);
+   bench<tf::sin>("sin, 1024, linear", inf::function_table<tf::sin, 1024>{}, sin_ref);
+   bench<tf::sin>("sin, 256, lagrange4", inf::function_table<tf::sin, 256, si::lagrange4>{}, sin_ref);
+
+   bench<tf::exp>("std::exp", [](float x) { return std::exp(x); }, exp_ref);
+   bench<tf::exp>("exp, 1024, linear", inf::function_table<tf::exp, 1024>{}, exp_ref);
+
+   bench<tf::log>("std::log", [](float x) { return std::log(x); }, log_ref);
+   bench<tf::log>("log, 1024, linear", inf::function_table<tf::log, 1024>{}, log_ref);
+
+   bench<tf::db_to_gain>("std::pow(10, x / 20)", [](float x) { return std::pow(10.0f, x / 20); }, db_ref);
+   bench<tf::db_to_gain>("db_to_gain, 1024, linear", inf::function_table<tf::db_to_gain, 1024>{}, db_ref);
+
+   bench<tf::inverse>("1 / x", [](float x) { return 1 / x; }, inverse_ref);
+   bench<tf::inverse>("inverse, 1024, linear", inf::function_table<tf::inverse, 1024>{}, inverse_ref);
+   bench<tf::inverse>("inverse, 1024, hermite", inf::function_table<tf::inverse, 1024, si::cubic_hermite>{}, inverse_ref);
+   return 0;
+}
@@ -0,0 +1,132 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/delay.hpp>
+#include <inf/interpolation.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Host microbenchmark: fractional-delay interpolators (see
+// interpolation.hpp), through a single_delay at a fractional delay.
+//
+// Accuracy: a sine at various frequencies is delayed, and compared with the
+// ideal delayed sine, after the start-up transient. The gain is the
+// amplitude of the delayed sine (0dB is ideal), and the error is the RMS of
+// the difference, relative to the sine's RMS. Printed as CSV:
+//
+//    interpolator,freq_hz,gain_db,error_db
+//
+// Speed: the time per sample for random input, one sample at a time.
+//
+// Build (host): g++ -O3 -std=c++14 -DINFINITY_HOST -I inc bench/interpolation_bench.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+namespace si = inf::sample_interpolation;
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::uint32_t sps = 48000;
+constexpr float pi = 3.14159265358979f;
+constexpr float delay = 10.37f;
+constexpr std::size_t max_delay = 16;
+constexpr std::size_t num_samples = 1 << 16;
+constexpr int iterations = 20;
+
+std::vector<float> input;
+
+namespace cycfi { namespace infinity
+{
+   void error_handler()
+   {
+      std::printf("Fatal error!\n");
+      std::exit(1);
+   }
+}}
+
+template <typename Interpolation>
+void accuracy(char const* name)
+{
+   for (float freq : { 100.0f, 1000.0f, 5000.0f, 10000.0f, 15000.0f, 20000.0f })
+   {
+      inf::fixed_single_delay<float, max_delay, Interpolation> d;
+      d.samples_delay(delay);
+
+      // d(s) returns the delayed signal before pushing s: one sample more
+      auto w = 2 * pi * freq / sps;
+      double signal = 0.0, error = 0.0;
+      float peak = 0.0f;
+      for (std::size_t i = 0; i != 8192; ++i)
+      {
+         auto out = d(std::sin(w * i));
+         if (i < 4096)
+            continue;   // the transient
+         auto ideal = std::sin(w * (i - delay - 1));
+         signal += ideal * ideal;
+         error += (out - ideal) * (out - ideal);
+         peak = std::max(peak, std::abs(out));
+      }
+
+      auto gain_db = 20 * std::log10(peak);
+      auto error_db = 10 * std::log10(error / signal);
+      std::printf("%s,%g,%.3f,%.1f\n", name, freq, gain_db, error_db);
+   }
+}
+
+template <typename Interpolation>
+float speed(std::vector<float>& out)
+{
+   inf::fixed_single_delay<float, max_delay, Interpolation> d;
+   d.samples_delay(delay);
+   for (std::size_t i = 0; i != num_samples; ++i)
+      out[i] = d(input[i]);
+   return out[num_samples - 1];
+}
+
+template <typename Interpolation>
+float bench(char const* name)
+{
+   std::vector<float> out(num_samples);
+   float sink = 0.0f;
+   auto start = clock_type::now();
+   for (int i = 0; i != iterations; ++i)
+      sink = speed<Interpolation>(out);
+   std::chrono::duration<double, std::nano> elapsed = clock_type::now() - start;
+
+   auto ns = elapsed.count() / (double(iterations) * num_samples);
+   std::printf("%-24s %8.3f ns/sample   (%g)\n", name, ns, sink);
+   return sink;
+}
+
+int main()
+{
+   std::mt19937 gen;
+   std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+   input.resize(num_samples);
+   for (auto& s : input)
+      s = dist(gen);
+
+   std::printf("interpolator,freq_hz,gain_db,error_db\n");
+   accuracy<si::none>("none");
+   accuracy<si::linear>("linear");
+   accuracy<si::cubic_hermite>("cubic_hermite");
+   accuracy<si::lagrange4>("lagrange4");
+   accuracy<si::tabulated<si::cubic_hermite>>("tabulated_hermite");
+   accuracy<si::tabulated<si::lagrange4>>("tabulated_lagrange4");
+   accuracy<si::thiran>("thiran");
+   std::printf("\n");
+
+   bench<si::none>("none");
+   bench<si::linear>("linear");
+   bench<si::cubic_hermite>("cubic_hermite");
+   bench<si::lagrange4>("lagrange4");
+   bench<si::tabulated<si::cubic_hermite>>("tabulated_hermite");
+   bench<si::tabulated<si::lagrange4>>("tabulated_lagrange4");
+   bench<si::thiran>("thiran");
+   return 0;
+}
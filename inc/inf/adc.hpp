@@ -6,6 +6,10 @@
 #if !defined(CYCFI_INFINITY_ADC_HPP_DECEMBER_31_2015)
 #define CYCFI_INFINITY_ADC_HPP_DECEMBER_31_2015
 
+#if defined(INFINITY_HOST)
+# include <inf/host/adc.hpp>
+#else
+
 #include <inf/detail/pin_impl.hpp>
 #include <inf/timer.hpp>
 #include <inf/support.hpp>
@@ -208,4 +212,5 @@ namespace cycfi { namespace infinity
    };
 }}
 
+#endif // INFINITY_HOST
 #endif
@@ -8,15 +8,41 @@
 
 #include <vector>
 #include <array>
+#include <algorithm>
 #include <inf/support.hpp>
+#include <inf/static_memory.hpp>
 
 namespace cycfi { namespace infinity
 {
    ////////////////////////////////////////////////////////////////////////////////////////////////
    // buffer: a simple fixed size buffer using a ring buffer.
+   //
+   // The Storage determines where the data lives:
+   //
+   //    std::vector<T>          The heap (the default). The size is given
+   //                            to the constructor.
+   //    std::array<T, N>        In place, with a compile-time capacity N (a
+   //                            power of 2). No heap. See fixed_buffer.
+   //    arena_storage<T, A>     A static_arena (see static_memory.hpp), for
+   //                            sizes known only at run time. No heap.
+   //
+   // The size is rounded up to a power of 2 for efficient indexing. A size
+   // given to the constructor of a fixed capacity buffer must not exceed
+   // its capacity (error_handler is called).
+   //
+   // Blocks of elements can be pushed and read in bulk, for block based
+   // processing (e.g. from the processor's begin_block). Blocks are in time
+   // order (oldest first) and are copied in at most two contiguous segments
+   // (where the ring wraps around).
    ////////////////////////////////////////////////////////////////////////////////////////////////
    namespace detail
    {
+      // The smallest power of 2 that is >= n
+      constexpr std::size_t smallest_pow2(std::size_t n, std::size_t m = 1)
+      {
+         return (m < n)? smallest_pow2(n, m << 1) : m;
+      }
+
       template <typename T>
       void init_store(std::size_t size, std::vector<T>& _data, std::size_t& _mask)
       {
@@ -29,26 +55,56 @@ namespace cycfi { namespace infinity
       template <typename T, std::size_t N>
       void init_store(std::size_t size, std::array<T, N>& _data, std::size_t& _mask)
       {
-         // size is ignored; std::array is not resizeable
+         static_assert((N & (N - 1)) == 0, "N must be a power of 2");
+
+         // std::array is not resizeable. The size must fit.
+         if (size > N)
+            error_handler();
          _mask = _data.size() - 1;
       }
+
+      template <typename T, typename Arena>
+      void init_store(std::size_t size, arena_storage<T, Arena>& _data, std::size_t& _mask)
+      {
+         std::size_t capacity = smallest_pow2(size);
+         _mask = capacity - 1;
+         _data.allocate(capacity);
+      }
+
+      template <typename Storage>
+      struct storage_capacity
+      {
+         static constexpr std::size_t value = 0; // Set at run time
+      };
+
+      template <typename T, std::size_t N>
+      struct storage_capacity<std::array<T, N>>
+      {
+         static constexpr std::size_t value = N;
+      };
    }
-   
+
    template <typename T, typename Storage = std::vector<T>>
    class buffer
    {
    public:
 
+      // The compile-time capacity, or 0 if the size is set at run time
+      static constexpr std::size_t capacity = detail::storage_capacity<Storage>::value;
+
+      // Compile-time capacity (std::array storage) only
       explicit buffer()
        : _pos(0)
       {
-         detail::init_store(-1, _data, _mask);
+         static_assert(capacity != 0,
+            "The default constructor requires a fixed capacity Storage");
+         detail::init_store(capacity, _data, _mask);
       }
 
       explicit buffer(std::size_t size)
        : _pos(0)
       {
-         init_store(size, _data, _mask);
+         detail::init_store(size, _data, _mask);
       }
 
       buffer(buffer const& rhs) = default;
@@ -65,28 +121,75 @@ namespace cycfi { namespace infinity
       // push the latest element, overwriting the oldest element
       void push(T val)
       {
-         --_pos &= _mask;
+         ++_pos &= _mask;
          _data[_pos] = val;
       }
 
+      // push n elements, oldest first (first[n-1] becomes the latest element)
+      void push(T const* first, std::size_t n)
+      {
+         auto const size = _mask + 1;
+         if (n > size)
+         {
+            // Only the latest size elements are kept
+            first += n - size;
+            n = size;
+         }
+
+         auto data = &_data[0];
+         auto start = (_pos + 1) & _mask;
+         auto n1 = std::min(n, size - start);
+         std::copy(first, first + n1, data + start);
+         std::copy(first + n1, first + n, data);
+         _pos = (_pos + n) & _mask;
+      }
+
+      // read n elements, oldest first, ending at the nth latest element
+      // (out[n-1] is b[delay]). delay + n must not exceed the size.
+      void read(T* out, std::size_t delay, std::size_t n) const
+      {
+         auto const size = _mask + 1;
+         auto data = &_data[0];
+         auto start = (_pos - delay - (n - 1)) & _mask;
+         auto n1 = std::min(n, size - start);
+         std::copy(data + start, data + start + n1, out);
+         std::copy(data, data + (n - n1), out + n1);
+      }
+
       // get the nth latest element (b[0] is latest element. b[1] is the second latest)
       T operator[](std::size_t index) const
       {
-         return _data[(_pos + index) & _mask];
+         return _data[(_pos - index) & _mask];
       }
 
       // get the nth latest element (b[0] is latest element. b[1] is the second latest)
       T& operator[](std::size_t index)
       {
-         return _data[(_pos + index) & _mask];
+         return _data[(_pos - index) & _mask];
       }
 
    private:
 
       std::size_t	_mask;
       std::size_t _pos;
-      Storage     _data;
+      Storage     _data{};
    };
+
+   ////////////////////////////////////////////////////////////////////////////////////////////////
+   // fixed_buffer: a buffer with a compile-time capacity of at least N
+   // elements, stored in place.
+   ////////////////////////////////////////////////////////////////////////////////////////////////
+   template <typename T, std::size_t N>
+   using fixed_buffer = buffer<T, std::array<T, detail::smallest_pow2(N)>>;
+
+   ////////////////////////////////////////////////////////////////////////////////////////////////
+   // arena_buffer: a buffer sized at run time, allocated from a static_arena
+   // (see static_memory.hpp). Usable as the Storage of lut and delay, e.g.:
+   //
+   //    inf::single_delay<float, inf::arena_buffer<float, my_arena>> d{ 0.02f, sps };
+   ////////////////////////////////////////////////////////////////////////////////////////////////
+   template <typename T, typename Arena>
+   using arena_buffer = buffer<T, arena_storage<T, Arena>>;
 }}
 
 #endif
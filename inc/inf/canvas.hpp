@@ -7,7 +7,10 @@
 #define CYCFI_INFINITY_CANVAS_HPP_MAY_9_2017
 
 #include <utility>
+#include <algorithm>
 #include <cstdint>
+#include <cstdlib>
+#include <iterator>
 #include <string>
 
 namespace cycfi { namespace infinity
@@ -42,6 +45,13 @@ namespace cycfi { namespace infinity
    ////////////////////////////////////////////////////////////////////////////
    // mono_canvas canvas. This is implements routines for drawing
    // into monochromatic OLED frame buffers.
+   //
+   // The frame buffer is organized in pages of 8 rows, one byte per column
+   // (the SSD1306 layout). The canvas keeps track of the columns of each
+   // page drawn into (the dirty range) since the last mark_clean, so that
+   // the display driver can send only what changed (see ssd1306::refresh).
+   // clear() marks only the columns that were not already blank. Writes
+   // through begin() or operator[] are not tracked: call mark_dirty.
    ////////////////////////////////////////////////////////////////////////////
    template <std::size_t width_, std::size_t height_>
    struct mono_canvas
@@ -53,10 +63,20 @@ namespace cycfi { namespace infinity
       using font = monochrome::font;
       using bitmap = monochrome::bitmap;
       static std::size_t const size = (width * height) / 8;
+      static std::size_t const pages = height / 8;
+
+      // The dirty columns of a page: first to last (exclusive). Clean if
+      // first == last.
+      struct dirty_range
+      {
+         std::uint16_t first;
+         std::uint16_t last;
+      };
 
       mono_canvas(std::uint8_t* buffer_)
        : _buffer(buffer_)
       {
+         mark_dirty();
          clear();
       }
 
@@ -83,9 +103,17 @@ namespace cycfi { namespace infinity
       std::uint8_t&           operator[](std::size_t i)        { return _buffer[i]; }
       std::uint8_t const      operator[](std::size_t i) const  { return _buffer[i]; }
 
+      // Dirty tracking
+      void                    mark_dirty(int x, int y, int w, int h);
+      void                    mark_dirty();  // everything
+      void                    mark_clean();
+      dirty_range             dirty(std::size_t page) const { return _dirty[page]; }
+      bool                    is_dirty() const;
+
    private:
 
-      std::uint8_t* _buffer;
+      std::uint8_t*           _buffer;
+      dirty_range             _dirty[pages];
    };
 
    ////////////////////////////////////////////////////////////////////////////
@@ -139,31 +167,108 @@ namespace cycfi { namespace infinity
           std::uint8_t* buffer, std::uint8_t* end, int width, int height,
           int x, int y, char ch, monochrome::font font_, monochrome::color color_
       );
+
+      // Draw a string as a single run of glyphs, with a single bounds check.
+      // Returns the next x, or -1 (and draws nothing) if the run is not
+      // entirely in the canvas or has characters not in the font.
+      int draw_glyph_run(
+          std::uint8_t* buffer, int width, int height,
+          int x, int y, char const* str, monochrome::font font_, monochrome::color color_
+      );
+
+      // The height of the font's glyphs, in pixels
+      int font_height(monochrome::font font_);
+   }
+
+   template <std::size_t width, std::size_t height>
+   inline void mono_canvas<width, height>::mark_dirty(int x, int y, int w, int h)
+   {
+      // Clip to the canvas
+      auto x0 = std::max(x, 0);
+      auto x1 = std::min(x + w, int(width));
+      auto y0 = std::max(y, 0);
+      auto y1 = std::min(y + h, int(height));
+      if (x0 >= x1 || y0 >= y1)
+         return;
+
+      for (auto page = y0 / 8; page <= (y1 - 1) / 8; ++page)
+      {
+         auto& r = _dirty[page];
+         if (r.first == r.last)
+         {
+            r.first = x0;
+            r.last = x1;
+         }
+         else
+         {
+            r.first = std::min<int>(r.first, x0);
+            r.last = std::max<int>(r.last, x1);
+         }
+      }
+   }
+
+   template <std::size_t width, std::size_t height>
+   inline void mono_canvas<width, height>::mark_dirty()
+   {
+      for (auto& r : _dirty)
+         r = { 0, width };
+   }
+
+   template <std::size_t width, std::size_t height>
+   inline void mono_canvas<width, height>::mark_clean()
+   {
+      for (auto& r : _dirty)
+         r = { 0, 0 };
+   }
+
+   template <std::size_t width, std::size_t height>
+   inline bool mono_canvas<width, height>::is_dirty() const
+   {
+      for (auto const& r : _dirty)
+         if (r.first != r.last)
+            return true;
+      return false;
    }
 
    template <std::size_t width, std::size_t height>
    inline void mono_canvas<width, height>::clear()
    {
-      for (auto& pixels : *this)
-         pixels = 0;
+      // Mark only the columns that are not blank yet
+      auto non_blank = [](std::uint8_t pixels) { return pixels != 0; };
+      for (std::size_t page = 0; page != pages; ++page)
+      {
+         auto first = _buffer + page * width;
+         auto last = first + width;
+         auto i = std::find_if(first, last, non_blank);
+         if (i == last)
+            continue;
+
+         using reverse = std::reverse_iterator<std::uint8_t*>;
+         auto j = std::find_if(reverse(last), reverse(i), non_blank).base();
+         mark_dirty(i - first, page * 8, j - i, 8);
+         std::fill(i, j, 0);
+      }
    }
 
    template <std::size_t width, std::size_t height>
    inline void mono_canvas<width, height>::fast_hline(int x, int y, int w, color color_)
    {
       detail::fast_hline_impl(_buffer, width, height, x, y, w, color_);
+      mark_dirty(x, y, w, 1);
    }
 
    template <std::size_t width, std::size_t height>
    inline void mono_canvas<width, height>::fast_vline(int x, int y, int h, color color_)
    {
       detail::fast_vline_impl(_buffer, width, height, x, y, h, color_);
+      mark_dirty(x, y, 1, h);
    }
 
    template <std::size_t width, std::size_t height>
    void mono_canvas<width, height>::draw_pixel(int x, int y, color color_)
    {
       detail::draw_pixel(_buffer, width, height, x, y, color_);
+      mark_dirty(x, y, 1, 1);
    }
 
    template <std::size_t width, std::size_t height>
@@ -184,6 +289,10 @@ namespace cycfi { namespace infinity
       else
       {
          detail::line_impl(_buffer, width, height, x0, y0, x1, y1, color_);
+         mark_dirty(
+            std::min(x0, x1), std::min(y0, y1)
+          , std::abs(x1 - x0) + 1, std::abs(y1 - y0) + 1
+         );
       }
    }
 
@@ -203,22 +312,41 @@ namespace cycfi { namespace infinity
       fast_vline(x+w-1, y, h, color_);
    }
 
+   template <std::size_t width, std::size_t height>
+   inline void mono_canvas<width, height>::draw_bitmap(bitmap const& img, int x, int y, color color_)
+   {
+      detail::draw_bitmap(_buffer, _buffer+size, width, height, x, y, img, color_);
+      mark_dirty(x, y, img.width, ((img.height + 7) / 8) * 8);
+   }
+
    template <std::size_t width, std::size_t height>
    inline int mono_canvas<width, height>::draw_char(char ch, int x, int y, font font_, color color_)
    {
-      return detail::draw_char(_buffer, _buffer+size, width, height, x, y, ch, font_, color_);
+      auto next = detail::draw_char(_buffer, _buffer+size, width, height, x, y, ch, font_, color_);
+      if (next > x)
+         mark_dirty(x, y, next - x, detail::font_height(font_));
+      return next;
    }
 
    template <std::size_t width, std::size_t height>
    inline int mono_canvas<width, height>::draw_string(char const* str, int x, int y, font font_, color color_)
    {
-      if (str)
+      if (!str)
+         return 0;
+
+      // The whole string in one run, if it is all in the canvas
+      auto next = detail::draw_glyph_run(_buffer, width, height, x, y, str, font_, color_);
+      if (next >= 0)
       {
-         while (*str)
-            x = draw_char(*str++, x, y, font_, color_);
-         return x;
+         if (next > x)
+            mark_dirty(x, y, next - x, detail::font_height(font_));
+         return next;
       }
-      return 0;
+
+      // Otherwise, glyph by glyph, with bounds checks
+      while (*str)
+         x = draw_char(*str++, x, y, font_, color_);
+      return x;
    }
 
    template <std::size_t width, std::size_t height>
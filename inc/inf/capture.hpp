@@ -0,0 +1,293 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_CAPTURE_HPP_NOVEMBER_26_2017)
+#define CYCFI_INFINITY_CAPTURE_HPP_NOVEMBER_26_2017
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // ADC capture format. A capture is a stream of chunks, each starting
+   // with a chunk_header followed by the payload, padded to a multiple of
+   // 4 bytes. All values are little endian and all chunks are 4 byte
+   // aligned, so a capture file can be memory mapped and read in place
+   // (see host/capture.hpp).
+   //
+   //    header         capture_info. Always the first chunk.
+   //
+   //    frames         The sample clock (uint32, the index of the first
+   //                   frame since the start of the capture) followed by
+   //                   the raw ADC frames, exactly as transferred by the
+   //                   DMA: 12-bit samples (uint16), interleaved by
+   //                   channel. One chunk per half buffer.
+   //
+   //    param          A parameter change (capture_param), taking effect
+   //                   at the start of the block beginning with the frame
+   //                   at the given sample clock.
+   //
+   // Dropped chunks (see capture_recorder) show up as gaps in the frames'
+   // sample clocks.
+   ////////////////////////////////////////////////////////////////////////////
+   enum class capture_chunk : std::uint32_t
+   {
+      header = 1,
+      frames = 2,
+      param = 3
+   };
+
+   struct capture_chunk_header
+   {
+      capture_chunk  type;
+      std::uint32_t  size;          // Payload size (without the padding)
+   };
+
+   struct capture_info
+   {
+      char           magic[4];      // "INFR"
+      std::uint32_t  version;
+      std::uint32_t  channels;
+      std::uint32_t  sampling_rate; // ADC sampling rate
+      std::uint32_t  oversampling;
+      std::uint32_t  block_frames;  // Frames per frames chunk
+   };
+
+   struct capture_param
+   {
+      std::uint32_t  sample_clock;
+      std::uint32_t  id;
+      float          value;
+   };
+
+   constexpr std::uint32_t capture_version = 1;
+
+   ////////////////////////////////////////////////////////////////////////////
+   // What capture_recorder does when the ring buffer is full:
+   //
+   //    drop           Drop the new chunk. For streaming, when the main
+   //                   loop drains the ring buffer (see flush).
+   //
+   //    overwrite      Evict the oldest whole chunks to make room. For
+   //                   recording without a consumer: the ring buffer
+   //                   always holds the most recent window, from tail to
+   //                   head, for a debugger to dump. flush must not be
+   //                   called concurrently with the DSP interrupt.
+   ////////////////////////////////////////////////////////////////////////////
+   enum class capture_overflow
+   {
+      drop,
+      overwrite
+   };
+
+   constexpr std::size_t capture_padded(std::size_t size)
+   {
+      return (size + 3) & ~std::size_t(3);
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // capture_recorder: Records the raw ADC frames and parameter changes
+   // into a ring buffer, from the DSP interrupt, and streams them out from
+   // the main loop. Copying a block into the ring buffer is the only work
+   // done in the interrupt. When the ring buffer is full (the main loop
+   // did not keep up), the whole chunk is dropped, or, with
+   // capture_overflow::overwrite, the oldest chunks are evicted.
+   //
+   // The recorder is a single producer (the DSP interrupt), single
+   // consumer (the main loop) queue. start must be called before the DSP
+   // interrupt starts recording.
+   //
+   // Capture is enabled by giving the multi_channel_processor Base a
+   // capture member function (see multi_processor.hpp). The app decides
+   // where the stream goes. For example:
+   //
+   //    // Base
+   //    template <typename Iter>
+   //    void capture(Iter src) { _capture.frames(src); }
+   //
+   //    // main loop
+   //    proc._capture.flush(
+   //       [](std::uint8_t const* data, std::size_t len)
+   //       {
+   //          uart.write(data, len);
+   //       });
+   //
+   // - channels:      The number of ADC channels
+   // - block_frames:  Frames per block (half the ADC buffer size)
+   // - capacity:      The ring buffer size in bytes (a power of 2)
+   // - overflow:      What to do when the ring buffer is full
+   //
+   // With capture_overflow::overwrite, the header chunk is eventually
+   // evicted too. A copy is kept in info() (the _info member).
+   ////////////////////////////////////////////////////////////////////////////
+   template <
+      std::size_t channels
+    , std::size_t block_frames
+    , std::size_t capacity = 16384
+    , capture_overflow overflow = capture_overflow::drop
+   >
+   class capture_recorder
+   {
+   public:
+
+      static constexpr std::size_t frames_size =
+         sizeof(std::uint32_t) + block_frames * channels * sizeof(std::uint16_t);
+
+      static_assert((capacity & (capacity - 1)) == 0,
+         "capacity must be a power of 2");
+
+      static_assert(
+         capacity >= sizeof(capture_chunk_header) + capture_padded(frames_size),
+         "capacity must be large enough for a block");
+
+      // Start a new capture. Call from the main loop, before the DSP
+      // interrupt starts recording.
+      void start(std::uint32_t sampling_rate, std::uint32_t oversampling)
+      {
+         _head.store(0, std::memory_order_relaxed);
+         _tail.store(0, std::memory_order_relaxed);
+         _clock = 0;
+         _dropped = 0;
+
+         std::memcpy(_info.magic, "INFR", 4);
+         _info.version = capture_version;
+         _info.channels = channels;
+         _info.sampling_rate = sampling_rate;
+         _info.oversampling = oversampling;
+         _info.block_frames = block_frames;
+         put(capture_chunk::header, &_info, sizeof(_info), nullptr, 0);
+      }
+
+      // The header of the capture
+      capture_info const& info() const
+      {
+         return _info;
+      }
+
+      // Record a block of ADC frames. src points to the first sample
+      // group of the block (e.g. adc.begin() or adc.middle()). Call from
+      // the DSP interrupt.
+      template <typename Iter>
+      void frames(Iter src)
+      {
+         if (!put(capture_chunk::frames, &_clock, sizeof(_clock),
+            &(*src)[0], block_frames * channels * sizeof(std::uint16_t)))
+         {
+            ++_dropped;
+         }
+         _clock += block_frames;
+      }
+
+      // Record a parameter change, taking effect at the start of the next
+      // block. Call from the DSP interrupt (e.g. from begin_block).
+      void param(std::uint32_t id, float value)
+      {
+         capture_param p{ _clock, id, value };
+         if (!put(capture_chunk::param, &p, sizeof(p), nullptr, 0))
+            ++_dropped;
+      }
+
+      // Send the recorded data to sink, a function object with the
+      // signature void(std::uint8_t const* data, std::size_t len). Call
+      // from the main loop.
+      template <typename Sink>
+      void flush(Sink&& sink)
+      {
+         auto tail = _tail.load(std::memory_order_relaxed);
+         auto head = _head.load(std::memory_order_acquire);
+         while (tail != head)
+         {
+            auto pos = tail & mask;
+            auto len = std::min<std::size_t>(head - tail, capacity - pos);
+            sink(&_ring[pos], len);
+            tail += len;
+         }
+         _tail.store(tail, std::memory_order_release);
+      }
+
+      // Number of chunks dropped because the ring buffer was full
+      std::uint32_t dropped() const
+      {
+         return _dropped;
+      }
+
+   private:
+
+      static constexpr std::size_t mask = capacity - 1;
+
+      bool put(
+         capture_chunk type
+       , void const* a, std::size_t a_len
+       , void const* b, std::size_t b_len)
+      {
+         capture_chunk_header h{ type, std::uint32_t(a_len + b_len) };
+         auto total = sizeof(h) + capture_padded(h.size);
+
+         auto head = _head.load(std::memory_order_relaxed);
+         auto tail = _tail.load(std::memory_order_acquire);
+         if (capacity - (head - tail) < total)
+         {
+            if (overflow == capture_overflow::drop)
+               return false;
+
+            // Evict the oldest whole chunks
+            do
+            {
+               capture_chunk_header old;
+               read(tail, &old, sizeof(old));
+               tail += sizeof(old) + capture_padded(old.size);
+            }
+            while (capacity - (head - tail) < total);
+            _tail.store(tail, std::memory_order_release);
+         }
+
+         auto pos = write(head, &h, sizeof(h));
+         pos = write(pos, a, a_len);
+         pos = write(pos, b, b_len);
+         std::uint32_t const zero = 0;
+         write(pos, &zero, total - (pos - head));
+
+         _head.store(head + total, std::memory_order_release);
+         return true;
+      }
+
+      std::uint32_t write(std::uint32_t pos, void const* data, std::size_t len)
+      {
+         if (len == 0)
+            return pos;
+         auto src = static_cast<std::uint8_t const*>(data);
+         auto i = pos & mask;
+         auto n = std::min(len, capacity - i);
+         std::memcpy(&_ring[i], src, n);
+         std::memcpy(&_ring[0], src + n, len - n);
+         return pos + len;
+      }
+
+      void read(std::uint32_t pos, void* data, std::size_t len) const
+      {
+         auto dest = static_cast<std::uint8_t*>(data);
+         auto i = pos & mask;
+         auto n = std::min(len, capacity - i);
+         std::memcpy(dest, &_ring[i], n);
+         std::memcpy(dest + n, &_ring[0], len - n);
+      }
+
+      using ring_type = std::array<std::uint8_t, capacity>;
+
+      ring_type                  _ring;
+      std::atomic<std::uint32_t> _head{ 0 };
+      std::atomic<std::uint32_t> _tail{ 0 };
+      std::uint32_t              _clock = 0;
+      std::uint32_t              _dropped = 0;
+      capture_info               _info;
+   };
+}}
+
+#endif
@@ -0,0 +1,106 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_CYCLE_COUNTER_HPP_NOVEMBER_23_2017)
+#define CYCFI_INFINITY_CYCLE_COUNTER_HPP_NOVEMBER_23_2017
+
+#include <cstdint>
+
+#if defined(STM32F4)
+# include <inf/support.hpp>
+#elif defined(INFINITY_PROFILER_RDTSC)
+# include <x86intrin.h>
+# include <chrono>
+# include <thread>
+#else
+# include <chrono>
+#endif
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // The Cortex-M DWT cycle counter. Counts CPU clock cycles (see
+   // clock_speed), wrapping around every 2^32 cycles. Always compute
+   // elapsed cycles using unsigned subtraction:
+   //
+   //    auto start = cycles();
+   //    ...
+   //    std::uint32_t elapsed = cycles() - start;
+   //
+   // cycles_per_second() returns the rate of the counter (64 bits: time
+   // stamp counters may run above 4.29GHz).
+   //
+   // On host builds, the counter falls back to std::chrono::steady_clock
+   // nanoseconds, or the x86 time stamp counter if INFINITY_PROFILER_RDTSC
+   // is defined.
+   ////////////////////////////////////////////////////////////////////////////
+#if defined(STM32F4)
+
+   inline void enable_cycle_counter()
+   {
+      CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+      DWT->CYCCNT = 0;
+      DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+   }
+
+   inline std::uint32_t cycles()
+   {
+      return DWT->CYCCNT;
+   }
+
+   inline std::uint64_t cycles_per_second()
+   {
+      return SystemCoreClock;
+   }
+
+#elif defined(INFINITY_PROFILER_RDTSC)
+
+   inline void enable_cycle_counter()
+   {
+   }
+
+   inline std::uint32_t cycles()
+   {
+      return std::uint32_t(__rdtsc());
+   }
+
+   inline std::uint64_t cycles_per_second()
+   {
+      // Calibrate once against the steady clock
+      static std::uint64_t const rate = []
+      {
+         using namespace std::chrono;
+         auto t0 = steady_clock::now();
+         auto c0 = __rdtsc();
+         std::this_thread::sleep_for(milliseconds(50));
+         auto c1 = __rdtsc();
+         duration<double> elapsed = steady_clock::now() - t0;
+         return std::uint64_t((c1 - c0) / elapsed.count());
+      }();
+      return rate;
+   }
+
+#else
+
+   inline void enable_cycle_counter()
+   {
+   }
+
+   inline std::uint32_t cycles()
+   {
+      using namespace std::chrono;
+      auto now = steady_clock::now().time_since_epoch();
+      return std::uint32_t(duration_cast<nanoseconds>(now).count());
+   }
+
+   inline std::uint64_t cycles_per_second()
+   {
+      return 1000000000;
+   }
+
+#endif
+}}
+
+#endif
@@ -6,6 +6,10 @@
 #if !defined(CYCFI_INFINITY_DAC_HPP_FEBRUARY_6_2016)
 #define CYCFI_INFINITY_DAC_HPP_FEBRUARY_6_2016
 
+#if defined(INFINITY_HOST)
+# include <inf/host/dac.hpp>
+#else
+
 #include <inf/config.hpp>
 #include <inf/pin.hpp>
 
@@ -123,4 +127,5 @@ namespace cycfi { namespace infinity
    };
 }}
 
+#endif // INFINITY_HOST
 #endif
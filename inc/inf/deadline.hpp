@@ -0,0 +1,79 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_DEADLINE_HPP_NOVEMBER_20_2017)
+#define CYCFI_INFINITY_DEADLINE_HPP_NOVEMBER_20_2017
+
+#include <cstdint>
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // deadline_monitor: Keeps track of deferred block processing.
+   //
+   // A producer (e.g. the ADC DMA interrupt) posts blocks at a fixed rate.
+   // A consumer (e.g. a lower priority software interrupt) processes the
+   // posted blocks. Each block must be processed completely before the next
+   // block is posted. If not, we have a deadline miss.
+   //
+   //    - post() is called by the producer each time a new block is ready.
+   //      If the previous block was not yet finished (either the consumer
+   //      did not get a chance to start or it is still busy processing
+   //      it), we count a miss.
+   //
+   //    - start() is called by the consumer before processing a block.
+   //      The consumer always processes the latest posted block.
+   //
+   //    - finish() is called by the consumer after processing the block.
+   //
+   // The producer is assumed to preempt the consumer, but not the other way
+   // around. Each counter is written only by one side, and 32-bit reads
+   // and writes are atomic on Cortex-M, so no locking is needed.
+   ////////////////////////////////////////////////////////////////////////////
+   class deadline_monitor
+   {
+   public:
+
+      void post()
+      {
+         if (_finished != _posted)
+            ++_misses;
+         ++_posted;
+      }
+
+      void start()
+      {
+         _started = _posted;
+      }
+
+      // Returns true if the block was finished before the next one was
+      // posted (i.e. the deadline was met).
+      bool finish()
+      {
+         _finished = _started;
+         return _started == _posted;
+      }
+
+      bool busy() const
+      {
+         return _finished != _posted;
+      }
+
+      std::uint32_t posted() const { return _posted; }
+      std::uint32_t misses() const { return _misses; }
+
+   private:
+
+      // Written by the producer
+      std::uint32_t volatile  _posted = 0;
+      std::uint32_t volatile  _misses = 0;
+
+      // Written by the consumer
+      std::uint32_t volatile  _started = 0;
+      std::uint32_t volatile  _finished = 0;
+   };
+}}
+
+#endif
@@ -7,18 +7,69 @@
 #define CYCFI_INFINITY_DELAY_JULY_20_2014
 
 #include <inf/lut.hpp>
+#include <type_traits>
 
 namespace cycfi { namespace infinity
 {
+   ////////////////////////////////////////////////////////////////////////////
+   // The delay in samples, rounded up, for sizing delays at compile time
+   // (see fixed_delay and fixed_single_delay).
+   ////////////////////////////////////////////////////////////////////////////
+   constexpr std::size_t delay_samples(double secs, uint32_t sps)
+   {
+      return std::size_t(secs * sps) + ((secs * sps) > std::size_t(secs * sps));
+   }
+
+   namespace detail
+   {
+      // The buffer size for delays up to max_delay samples
+      template <typename Interpolation>
+      constexpr std::size_t delay_size(std::size_t max_delay)
+      {
+         return max_delay + Interpolation::span;
+      }
+
+      template <typename T>
+      std::size_t delay_size(T max_delay, uint32_t sps)
+      {
+         return std::size_t(std::ceil(max_delay * sps));
+      }
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // delay_tap: a multi-tapped delay's tap
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename T>
+   struct delay_tap
+   {
+      delay_tap() : tsamples(0) {}
+      delay_tap(T secs, uint32_t sps) : tsamples(secs * sps) {}
+      T tsamples; // time in samples
+   };
+
    ////////////////////////////////////////////////////////////////////////////
    // delay: a basic class for implementing multi-tapped delays
+   //
+   // The taps are held in a Taps container: a std::vector (the default) or,
+   // for a fixed number of taps without heap allocation, a std::array (see
+   // fixed_delay).
+   //
+   // For block processing, push a block of n samples, then read the taps
+   // for the block. The reads go back n - 1 samples beyond the taps, so the
+   // max_delay must include the block size.
+   //
+   // The Interpolation must be stateless (the taps share the delay line).
    ////////////////////////////////////////////////////////////////////////////
    template <
       typename T
     , typename Storage = buffer<T>
-    , typename Interpolation = sample_interpolation::none>
+    , typename Interpolation = sample_interpolation::none
+    , typename Taps = std::vector<delay_tap<T>>>
    class delay
    {
+      static_assert(std::is_empty<Interpolation>::value,
+         "delay requires a stateless Interpolation");
+
    public:
 
       typedef T value_type;
@@ -26,22 +77,24 @@ namespace cycfi { namespace infinity
       typedef Interpolation interpolation_type;
 
       // tap representation
-      struct tap
-      {
-         tap(T secs, uint32_t sps) : tsamples(secs * sps) {}
-         T tsamples; // time in samples
-      };
+      typedef delay_tap<T> tap;
 
       // constructor (max_delay in seconds)
       delay(T max_delay, uint32_t sps)
-       : lu(std::size_t(std::ceil(max_delay * sps)))
+       : lu(detail::delay_size<Interpolation>(detail::delay_size(max_delay, sps)))
       {}
 
       // constructor (max_delay in seconds)
-      template <typename Taps>
-      delay(T max_delay, Taps const& taps, uint32_t sps)
-       : lu(std::size_t(std::ceil(max_delay * sps)))
-       , taps(taps)
+      template <typename Taps_>
+      delay(T max_delay, Taps_ const& taps, uint32_t sps)
+       : taps(taps)
+       , lu(detail::delay_size<Interpolation>(detail::delay_size(max_delay, sps)))
+      {}
+
+      // constructor (compile-time capacity Storage and Taps only, see
+      // fixed_delay)
+      delay()
+       : lu()
       {}
 
       // copy and assign
@@ -54,9 +107,8 @@ namespace cycfi { namespace infinity
       template <typename Mixer>
       T operator()(Mixer mixer, T mix = T()) const
       {
-         interpolation_type interpolate;
          for (auto tap : taps)
-            mix = mixer(interpolate(lu, tap.tsamples), mix);
+            mix = mixer(lu[tap.tsamples], mix);
          return mix;
       }
 
@@ -66,8 +118,36 @@ namespace cycfi { namespace infinity
          val >> d.lu;
       }
 
+      // push a block of n fresh samples, oldest first
+      void push(T const* first, std::size_t n)
+      {
+         lu.push(first, n);
+      }
+
+      // read the taps for the latest block of n samples: out[i] gets the
+      // block of taps[i], oldest first
+      void read(T* const* out, std::size_t n) const
+      {
+         for (std::size_t i = 0; i != taps.size(); ++i)
+            lu.read(out[i], taps[i].tsamples, n);
+      }
+
+      // mix the taps for the latest block of n samples
+      template <typename Mixer>
+      void operator()(Mixer mixer, T* out, std::size_t n) const
+      {
+         for (std::size_t i = 0; i != n; ++i)
+         {
+            auto back = T(n - 1 - i);
+            T mix = T();
+            for (auto tap : taps)
+               mix = mixer(lu[tap.tsamples + back], mix);
+            out[i] = mix;
+         }
+      }
+
       // the taps
-      std::vector<tap> taps;
+      Taps taps;
 
    private:
 
@@ -76,6 +156,10 @@ namespace cycfi { namespace infinity
 
    ////////////////////////////////////////////////////////////////////////////
    // single_delay: a basic class for implementing single delays
+   //
+   // With a stateful Interpolation (see sample_interpolation::thiran), the
+   // delayed signal must be read exactly once per sample pushed, e.g. with
+   // operator()(T val). Blocks are then processed one sample at a time.
    ////////////////////////////////////////////////////////////////////////////
    template <
       typename T
@@ -91,28 +175,35 @@ namespace cycfi { namespace infinity
 
       // constructor (max_delay in seconds)
       single_delay(T max_delay, uint32_t sps)
-       : lu(std::size_t(std::ceil(max_delay * sps)))
+       : lu(detail::delay_size<Interpolation>(detail::delay_size(max_delay, sps)))
        , tsamples_delay(max_delay * sps)
       {}
 
       // constructor (max_delay and delay in seconds)
       single_delay(T max_delay, T delay, uint32_t sps)
-       : lu(std::size_t(std::ceil(max_delay * sps)))
+       : lu(detail::delay_size<Interpolation>(detail::delay_size(max_delay, sps)))
        , tsamples_delay(delay * sps)
       {}
 
       // constructor (max_delay in samples)
       single_delay(std::size_t max_delay)
-       : lu(max_delay)
+       : lu(detail::delay_size<Interpolation>(max_delay))
        , tsamples_delay(max_delay)
       {}
 
       // constructor (max_delay and delay in samples)
       single_delay(std::size_t max_delay, std::size_t delay)
-       : lu(max_delay)
+       : lu(detail::delay_size<Interpolation>(max_delay))
        , tsamples_delay(delay)
       {}
 
+      // constructor (compile-time capacity Storage only, see
+      // fixed_single_delay). The delay is set with delay or samples_delay.
+      single_delay()
+       : lu()
+       , tsamples_delay(0)
+      {}
+
       // copy and assign
       single_delay(single_delay const& rhs) = default;
       single_delay(single_delay&& rhs) = default;
@@ -122,8 +213,7 @@ namespace cycfi { namespace infinity
       // get the delayed signal
       T operator()() const
       {
-         interpolation_type interpolate;
-         return interpolate(lu, tsamples_delay);
+         return lu[tsamples_delay];
       }
 
       // push a new signal and return the delayed signal
@@ -134,12 +224,33 @@ namespace cycfi { namespace infinity
          return delayed;
       }
 
+      // push a block of n signals and get the block of delayed signals
+      // (the same as calling operator()(T val) for each signal). in and
+      // out may be the same.
+      void operator()(T const* in, T* out, std::size_t n)
+      {
+         process(in, out, n, std::is_empty<Interpolation>{});
+      }
+
       // push fresh data to the front of the delay
       friend void operator>>(T val, single_delay& d)
       {
          val >> d.lu;
       }
 
+      // push a block of n fresh samples, oldest first
+      void push(T const* first, std::size_t n)
+      {
+         lu.push(first, n);
+      }
+
+      // get the delayed signals for the latest block of n samples, oldest
+      // first. The delay plus n must not exceed the delay line's size.
+      void read(T* out, std::size_t n) const
+      {
+         lu.read(out, tsamples_delay, n);
+      }
+
       // get/set the delay (in seconds)
       void delay(T delay, uint32_t sps) { tsamples_delay = delay * sps; }
       T delay(uint32_t sps) const { return tsamples_delay / sps; }
@@ -150,9 +261,72 @@ namespace cycfi { namespace infinity
 
    private:
 
+      // Stateless interpolation
+      void process(T const* in, T* out, std::size_t n, std::true_type)
+      {
+         // Process in chunks that fit in the delay line along with the
+         // delay (the chunk is pushed before its delayed signals are read)
+         auto const back = tsamples_delay + 1;
+         auto const room = lu.size() - std::size_t(back) - (Interpolation::span - 1);
+         if (room == 0)
+         {
+            // The delay fills the delay line. One at a time.
+            process(in, out, n, std::false_type{});
+            return;
+         }
+
+         while (n)
+         {
+            auto chunk = std::min(n, room);
+            lu.push(in, chunk);
+            lu.read(out, back, chunk);
+            in += chunk;
+            out += chunk;
+            n -= chunk;
+         }
+      }
+
+      // One at a time
+      void process(T const* in, T* out, std::size_t n, std::false_type)
+      {
+         for (std::size_t i = 0; i != n; ++i)
+            out[i] = (*this)(in[i]);
+      }
+
       lut<T, Storage, Interpolation> lu;
       T tsamples_delay;
    };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // fixed_delay and fixed_single_delay: delays with a compile-time
+   // capacity of max_samples (see delay_samples), and fixed_delay with
+   // num_taps taps, stored in place (no heap). The delays given to the
+   // constructors must not exceed max_samples.
+   //
+   //    // Up to 20ms at 20kHz
+   //    inf::fixed_single_delay<float, inf::delay_samples(0.02, 20000)> d{ 0.02f, 0.01f, 20000 };
+   ////////////////////////////////////////////////////////////////////////////
+   template <
+      typename T
+    , std::size_t max_samples
+    , std::size_t num_taps
+    , typename Interpolation = sample_interpolation::none>
+   using fixed_delay = delay<
+      T
+    , fixed_buffer<T, detail::delay_size<Interpolation>(max_samples)>
+    , Interpolation
+    , std::array<delay_tap<T>, num_taps>
+   >;
+
+   template <
+      typename T
+    , std::size_t max_samples
+    , typename Interpolation = sample_interpolation::none>
+   using fixed_single_delay = single_delay<
+      T
+    , fixed_buffer<T, detail::delay_size<Interpolation>(max_samples)>
+    , Interpolation
+   >;
 }}
 
 #endif
@@ -27,7 +27,8 @@ namespace cycfi { namespace infinity { namespace detail
       uint32_t dma_channel,
       IRQn_Type dma_channel_irq,
       uint16_t values[],
-      uint16_t size
+      uint16_t size,
+      uint32_t data_reg = LL_ADC_DMA_REG_REGULAR_DATA
    );
 
    void adc_config(
@@ -37,6 +38,12 @@ namespace cycfi { namespace infinity { namespace detail
       uint32_t num_channels
    );
 
+   void multi_adc_config(
+      uint32_t num_adcs,
+      uint32_t timer_trigger_id,
+      uint32_t num_channels
+   );
+
    inline void activate_adc(ADC_TypeDef* adc)
    {
       // ADC must be disabled at this point
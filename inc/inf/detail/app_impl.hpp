@@ -35,6 +35,14 @@ namespace cycfi { namespace infinity
 
 #endif
 
+#ifdef INFINITY_HOST
+   // Host simulator (see host/simulator.hpp). Same pins as the modified
+   // Nucleo-64 board (avoids conflicts with the DAC).
+   using main_led_type = output_pin<port::portc + 5>;
+   using main_button_type = input_pin<port::portc + 13, port::pull_up>;
+   using main_test_pin_type = output_pin<port::portc + 12>;
+#endif
+
 
 }}
 
@@ -82,10 +82,30 @@ namespace cycfi { namespace infinity { namespace detail
 
    extern I2C_HandleTypeDef i2c_handles[3];
 
+   // A DMA write (see i2c_write_async) is in progress
+   inline bool i2c_busy(std::size_t id)
+   {
+      return HAL_I2C_GetState(&i2c_handles[id-1]) != HAL_I2C_STATE_READY;
+   }
+
+   // The last transfer failed (e.g. no acknowledge)
+   inline bool i2c_failed(std::size_t id)
+   {
+      return HAL_I2C_GetError(&i2c_handles[id-1]) != HAL_I2C_ERROR_NONE;
+   }
+
+   // The blocking transfers wait for a DMA write to complete first
+   inline void i2c_wait(std::size_t id)
+   {
+      while (i2c_busy(id))
+         ;
+   }
+
    inline void i2c_write(
       std::size_t id, std::uint32_t addr,
       uint8_t const* data, uint32_t len, uint32_t timeout)
    {
+      i2c_wait(id);
       HAL_I2C_Master_Transmit(
          &i2c_handles[id-1], addr, const_cast<uint8_t*>(data), len, timeout);
    }
@@ -94,6 +114,7 @@ namespace cycfi { namespace infinity { namespace detail
       std::size_t id, std::uint32_t addr,
       uint8_t* data, uint32_t len, uint32_t timeout)
    {
+      i2c_wait(id);
       HAL_I2C_Master_Receive(
          &i2c_handles[id-1], addr, data, len, timeout);
    }
@@ -102,6 +123,7 @@ namespace cycfi { namespace infinity { namespace detail
       std::size_t id, std::uint32_t addr, uint16_t mem_addr, uint16_t mem_size,
       uint8_t const* data, uint32_t len, uint32_t timeout)
    {
+      i2c_wait(id);
       HAL_I2C_Mem_Write(
          &i2c_handles[id-1], addr, mem_addr, mem_size, const_cast<uint8_t*>(data), len, timeout);
    }
@@ -110,10 +132,20 @@ namespace cycfi { namespace infinity { namespace detail
       std::size_t id, std::uint32_t addr, uint16_t mem_addr, uint16_t mem_size,
       uint8_t* data, uint32_t len, uint32_t timeout)
    {
+      i2c_wait(id);
       HAL_I2C_Mem_Read(
          &i2c_handles[id-1], addr, mem_addr, mem_size, data, len, timeout);
    }
 
+   // Start a DMA write. Does not wait.
+   inline void i2c_write_async(
+      std::size_t id, std::uint32_t addr, uint8_t const* data, uint32_t len)
+   {
+      i2c_wait(id);
+      HAL_I2C_Master_Transmit_DMA(
+         &i2c_handles[id-1], addr, const_cast<uint8_t*>(data), len);
+   }
+
 }}}
 
 #endif
@@ -13,6 +13,8 @@
 #include <inf/pin.hpp>
 #include <inf/timer.hpp>
 #include <inf/adc.hpp>
+#include <inf/software_irq.hpp>
+#include <inf/uart.hpp>
 #include <type_traits>
 
 #if defined(STM32F4)
@@ -143,6 +145,48 @@ extern "C"
       HANDLE_ADC_INTERRUPT(2, 2);
    }
 
+   // All the stream's event flags must be clear before the stream is
+   // enabled again, so all of them are cleared before the completion
+   // task, which may start the next transfer (see uart_send).
+#define HANDLE_UART_TX_INTERRUPT(ID, DMA, STREAM)                              \
+   {                                                                           \
+      bool const tc = LL_DMA_IsActiveFlag_TC##STREAM(DMA) == 1;                \
+      bool const te = LL_DMA_IsActiveFlag_TE##STREAM(DMA) == 1;                \
+                                                                               \
+      LL_DMA_ClearFlag_TC##STREAM(DMA);                                        \
+      LL_DMA_ClearFlag_HT##STREAM(DMA);                                        \
+      LL_DMA_ClearFlag_TE##STREAM(DMA);                                        \
+      LL_DMA_ClearFlag_DME##STREAM(DMA);                                       \
+      LL_DMA_ClearFlag_FE##STREAM(DMA);                                        \
+                                                                               \
+      if (tc)                                                                  \
+         ::config(cycfi::infinity::uart_tx_complete<ID>{});                    \
+                                                                               \
+      if (te)                                                                  \
+         cycfi::infinity::error_handler();                                     \
+   }                                                                           \
+   /***/
+
+   void DMA2_Stream7_IRQHandler(void)
+   {
+      HANDLE_UART_TX_INTERRUPT(1, DMA2, 7);
+   }
+
+   void DMA1_Stream6_IRQHandler(void)
+   {
+      HANDLE_UART_TX_INTERRUPT(2, DMA1, 6);
+   }
+
+   void DMA1_Stream3_IRQHandler(void)
+   {
+      HANDLE_UART_TX_INTERRUPT(3, DMA1, 3);
+   }
+
+   void DMA2_Stream6_IRQHandler(void)
+   {
+      HANDLE_UART_TX_INTERRUPT(6, DMA2, 6);
+   }
+
    void ADC_IRQHandler(void)
    {
       // Check whether ADC group regular overrun caused the ADC interruption
@@ -166,6 +210,11 @@ extern "C"
       }
    }
 
+   void PendSV_Handler(void)
+   {
+      ::config(cycfi::infinity::software_irq_id{});
+   }
+
    void EXTI0_IRQHandler(void)
    {
       cycfi::infinity::detail::handle_exti<0>();
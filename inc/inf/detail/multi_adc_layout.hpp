@@ -0,0 +1,63 @@
+/*=============================================================================
+   Copyright (c) 2015-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_MULTI_ADC_LAYOUT_HPP_NOVEMBER_21_2017)
+#define CYCFI_INFINITY_MULTI_ADC_LAYOUT_HPP_NOVEMBER_21_2017
+
+#include <cstddef>
+
+namespace cycfi { namespace infinity { namespace detail
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // Frame layout for the dual/triple regular simultaneous ADC mode.
+   //
+   // Each conversion trigger starts a scan on all the ADCs at the same
+   // time. The ADCs convert their rank 1 channels simultaneously, then
+   // their rank 2 channels, and so on. With DMA mode 1, the DMA transfers
+   // one half-word per conversion, in this order:
+   //
+   //    ADC1 rank 1, ADC2 rank 1, [ADC3 rank 1], ADC1 rank 2, ADC2 rank 2...
+   //
+   // We assign the channels to the ADCs and ranks following that order, so
+   // that the DMA writes complete frames with logical channel i at index i.
+   // Channels i and i+1 (within the same rank) are sampled at exactly the
+   // same time.
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t num_adcs_, std::size_t channels_>
+   struct multi_adc_layout
+   {
+      static constexpr std::size_t num_adcs = num_adcs_;
+      static constexpr std::size_t channels = channels_;
+      static constexpr std::size_t ranks = channels / num_adcs;
+
+      static_assert(num_adcs == 2 || num_adcs == 3,
+         "Only dual or triple ADC modes are supported");
+
+      static_assert(channels % num_adcs == 0,
+         "The number of channels must be a multiple of the number of ADCs");
+
+      static_assert(ranks >= 1 && ranks <= 16, "Invalid number of channels");
+
+      // The ADC (1, 2 or 3) that converts channel i
+      static constexpr std::size_t adc(std::size_t i)
+      {
+         return (i % num_adcs) + 1;
+      }
+
+      // The sequence rank (1 to 16) of channel i
+      static constexpr std::size_t rank(std::size_t i)
+      {
+         return (i / num_adcs) + 1;
+      }
+
+      // The frame index of the conversion from the given adc and rank
+      static constexpr std::size_t index(std::size_t adc, std::size_t rank)
+      {
+         return ((rank - 1) * num_adcs) + (adc - 1);
+      }
+   };
+}}}
+
+#endif
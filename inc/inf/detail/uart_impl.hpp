@@ -0,0 +1,91 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_UART_IMPL_HPP_NOVEMBER_29_2017)
+#define CYCFI_INFINITY_UART_IMPL_HPP_NOVEMBER_29_2017
+
+#include <stm32f4xx.h>
+#include <stm32f4xx_ll_bus.h>
+#include <stm32f4xx_ll_dma.h>
+#include <stm32f4xx_ll_usart.h>
+#include <cstddef>
+#include <cstdint>
+#include <inf/pin.hpp>
+
+namespace cycfi { namespace infinity { namespace detail
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // The UART TX pins and the DMA streams, for the STM32F4 series. UART
+   // transmission uses the DMA stream of each UART's TX request.
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t pin>
+   struct uart_tx_pin
+   {
+      static const int uart_id = -1;
+   };
+
+#define INFINITY_UART_TX_PIN(pin, uart_id_)                                    \
+   template <>                                                                 \
+   struct uart_tx_pin<pin>                                                     \
+   {                                                                           \
+      static const int uart_id = uart_id_;                                     \
+   };                                                                          \
+   /***/
+
+   template <std::size_t pin>
+   constexpr bool valid_uart_tx_pin()
+   {
+      return uart_tx_pin<pin>::uart_id != -1;
+   }
+
+   INFINITY_UART_TX_PIN(port::porta + 2 , 2);
+   INFINITY_UART_TX_PIN(port::porta + 9 , 1);
+   INFINITY_UART_TX_PIN(port::portb + 6 , 1);
+   INFINITY_UART_TX_PIN(port::portb + 10, 3);
+   INFINITY_UART_TX_PIN(port::portc + 6 , 6);
+   INFINITY_UART_TX_PIN(port::portc + 10, 3);
+   INFINITY_UART_TX_PIN(port::portd + 5 , 2);
+   INFINITY_UART_TX_PIN(port::portd + 8 , 3);
+   INFINITY_UART_TX_PIN(port::portg + 14, 6);
+
+   template <std::size_t id>
+   struct uart_info;
+
+#define INFINITY_UART(id, apb, af, dma_, stream, channel)                      \
+   template <>                                                                 \
+   struct uart_info<id>                                                        \
+   {                                                                           \
+      static constexpr USART_TypeDef* uart = USART##id;                        \
+      static constexpr bool apb2 = (apb == 2);                                 \
+      static constexpr uint32_t periph_id = LL_APB##apb##_GRP1_PERIPH_USART##id;\
+      static constexpr uint32_t alternate = LL_GPIO_AF_##af;                   \
+      static constexpr DMA_TypeDef* dma = dma_;                                \
+      static constexpr IRQn_Type dma_irq_id = dma_##_Stream##stream##_IRQn;    \
+      static constexpr uint32_t dma_stream = LL_DMA_STREAM_##stream;           \
+      static constexpr uint32_t dma_channel = LL_DMA_CHANNEL_##channel;        \
+   };                                                                          \
+   /***/
+
+   INFINITY_UART(1, 2, 7, DMA2, 7, 4)
+   INFINITY_UART(2, 1, 7, DMA1, 6, 4)
+   INFINITY_UART(3, 1, 7, DMA1, 3, 4)
+   INFINITY_UART(6, 2, 8, DMA2, 6, 5)
+
+   void uart_config(
+      USART_TypeDef* uart, bool apb2, uint32_t periph_id,
+      uint32_t baud_rate,
+      GPIO_TypeDef& tx_gpio, uint32_t tx_pin_mask, uint32_t alternate,
+      DMA_TypeDef* dma, uint32_t dma_stream, uint32_t dma_channel,
+      IRQn_Type dma_irq_id
+   );
+
+   // Start a DMA transfer. Does not wait.
+   void uart_send(
+      DMA_TypeDef* dma, uint32_t dma_stream,
+      std::uint8_t const* data, std::size_t len
+   );
+}}}
+
+#endif
@@ -0,0 +1,215 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_FUNCTION_TABLE_HPP_DECEMBER_3_2017)
+#define CYCFI_INFINITY_FUNCTION_TABLE_HPP_DECEMBER_3_2017
+
+#include <inf/interpolation.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // Compile-time math. Double precision, for computing tables at compile
+   // time (see function_table). Not meant to be fast.
+   ////////////////////////////////////////////////////////////////////////////
+   namespace constexpr_math
+   {
+      constexpr double pi = 3.14159265358979323846;
+      constexpr double ln2 = 0.69314718055994530942;
+      constexpr double ln10 = 2.30258509299404568402;
+
+      constexpr double sin(double x)
+      {
+         // Reduce to -pi...pi
+         auto n = x / (2 * pi);
+         auto whole = double(long(n)) - (n < 0);
+         x -= (whole + (n - whole >= 0.5)) * 2 * pi;
+
+         // Taylor series
+         double term = x;
+         double sum = x;
+         for (int i = 1; i != 20; ++i)
+         {
+            term *= -x * x / ((2 * i) * (2 * i + 1));
+            sum += term;
+         }
+         return sum;
+      }
+
+      constexpr double cos(double x)
+      {
+         return sin(x + pi / 2);
+      }
+
+      constexpr double exp(double x)
+      {
+         // exp(x) = 2^n * exp(r), with |r| <= ln2 / 2
+         auto n = long(x / ln2 + ((x < 0)? -0.5 : 0.5));
+         auto r = x - n * ln2;
+
+         double term = 1;
+         double sum = 1;
+         for (int i = 1; i != 20; ++i)
+         {
+            term *= r / i;
+            sum += term;
+         }
+
+         for (; n > 0; --n)
+            sum *= 2;
+         for (; n < 0; ++n)
+            sum /= 2;
+         return sum;
+      }
+
+      // x must be > 0
+      constexpr double log(double x)
+      {
+         // log(x) = e * ln2 + log(m), with 0.5 <= m < 1
+         int e = 0;
+         for (; x >= 1; x /= 2)
+            ++e;
+         for (; x < 0.5; x *= 2)
+            --e;
+
+         // log(m) = 2 * atanh(z), z = (m - 1) / (m + 1)
+         auto z = (x - 1) / (x + 1);
+         auto z2 = z * z;
+         double term = z;
+         double sum = 0;
+         for (int i = 0; i != 40; ++i)
+         {
+            sum += term / (2 * i + 1);
+            term *= z2;
+         }
+         return 2 * sum + e * ln2;
+      }
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // table_functions: functions for function_table. A function has a
+   // compile-time eval, and a domain (min to max). Use your own, or derive
+   // from these to change the domain, e.g.:
+   //
+   //    struct agc_inverse : inf::table_functions::inverse
+   //    {
+   //       static constexpr double min = 1.0 / 128;
+   //       static constexpr double max = 2.0;
+   //    };
+   ////////////////////////////////////////////////////////////////////////////
+   namespace table_functions
+   {
+      // One cycle of sine (the phase in radians)
+      struct sin
+      {
+         static constexpr double min = 0.0;
+         static constexpr double max = 2 * constexpr_math::pi;
+         static constexpr double eval(double x) { return constexpr_math::sin(x); }
+      };
+
+      struct exp
+      {
+         static constexpr double min = -8.0;
+         static constexpr double max = 8.0;
+         static constexpr double eval(double x) { return constexpr_math::exp(x); }
+      };
+
+      struct log
+      {
+         static constexpr double min = 1.0 / 64;
+         static constexpr double max = 1.0;
+         static constexpr double eval(double x) { return constexpr_math::log(x); }
+      };
+
+      // dB to linear gain
+      struct db_to_gain
+      {
+         static constexpr double min = -96.0;
+         static constexpr double max = 24.0;
+         static constexpr double eval(double x)
+         {
+            return constexpr_math::exp(x * constexpr_math::ln10 / 20);
+         }
+      };
+
+      // 1/x
+      struct inverse
+      {
+         static constexpr double min = 1.0 / 64;
+         static constexpr double max = 1.0;
+         static constexpr double eval(double x) { return 1.0 / x; }
+      };
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // function_table: a function F (see table_functions) sampled at N + 1
+   // equally spaced points over its domain, computed entirely at compile
+   // time (in flash, on the target), and interpolated (see
+   // interpolation.hpp) in between:
+   //
+   //    inf::function_table<inf::table_functions::sin, 1024> sin_;
+   //    auto s = sin_(phase);
+   //
+   // The scaling from x to the table index is folded into two constants.
+   // x is clamped to the domain. The Interpolation must be stateless. The
+   // table extends one point below min (for the 4 point interpolators) and
+   // span points past max, so F must be defined there too.
+   ////////////////////////////////////////////////////////////////////////////
+   template <
+      typename F
+    , std::size_t N
+    , typename Interpolation = sample_interpolation::linear
+    , typename T = float>
+   class function_table
+   {
+      static_assert(std::is_empty<Interpolation>::value,
+         "function_table requires a stateless Interpolation");
+      static_assert(F::max > F::min, "The domain is empty");
+
+   public:
+
+      typedef T value_type;
+      typedef F function_type;
+      typedef Interpolation interpolation_type;
+
+      // The table has a point below min, and span points past max
+      static constexpr std::size_t size = N + 1 + Interpolation::span;
+      static constexpr double step = (F::max - F::min) / N;
+
+      // index = x * scale + offset (the point at min is at index 1)
+      static constexpr T scale = T(N / (F::max - F::min));
+      static constexpr T offset = T(1 - F::min * (N / (F::max - F::min)));
+
+      struct table_type
+      {
+         T data[size];
+      };
+
+      static constexpr table_type make_table()
+      {
+         table_type table = {};
+         for (std::size_t i = 0; i != size; ++i)
+            table.data[i] = T(F::eval(F::min + (double(i) - 1) * step));
+         return table;
+      }
+
+      static constexpr table_type table = make_table();
+
+      T operator()(T x) const
+      {
+         auto index = std::min(std::max(x * scale + offset, T(1)), T(N + 1));
+         return interpolation_type{}(table.data, index);
+      }
+   };
+
+   template <typename F, std::size_t N, typename Interpolation, typename T>
+   constexpr typename function_table<F, N, Interpolation, T>::table_type
+   function_table<F, N, Interpolation, T>::table;
+}}
+
+#endif
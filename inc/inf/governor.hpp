@@ -0,0 +1,97 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_GOVERNOR_HPP_NOVEMBER_23_2017)
+#define CYCFI_INFINITY_GOVERNOR_HPP_NOVEMBER_23_2017
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // load_governor: CPU load governor with graceful degradation tiers.
+   //
+   // The governor is updated once per block with the time it took to
+   // process the block and the block period (the budget), both in the same
+   // units (e.g. CPU cycles). The load is the ratio of the two.
+   //
+   // Tier 0 is full quality. Higher tiers degrade gracefully. What each
+   // tier does (e.g. disabling harmonic synthesis, decimating detection,
+   // skipping idle channels) is up to the client.
+   //
+   //    - If the load goes above the high threshold, we step up one tier
+   //      immediately (we are close to an overrun).
+   //
+   //    - If the load stays below the low threshold for hold consecutive
+   //      blocks, we step back down one tier.
+   //
+   // The gap between the high and low thresholds plus the hold time
+   // provide hysteresis, preventing the tiers from oscillating.
+   ////////////////////////////////////////////////////////////////////////////
+   class load_governor
+   {
+   public:
+
+      load_governor(
+         std::size_t tiers
+       , float high_threshold = 0.85f
+       , float low_threshold = 0.6f
+       , std::uint32_t hold = 64
+      )
+       : _tiers(tiers)
+       , _high(high_threshold)
+       , _low(low_threshold)
+       , _hold(hold)
+      {}
+
+      std::size_t operator()(std::uint32_t elapsed, std::uint32_t budget)
+      {
+         float load = float(elapsed) / budget;
+         if (load > _peak)
+            _peak = load;
+         _load = load;
+
+         if (load > _high)
+         {
+            _count = 0;
+            if (_tier < _tiers)
+               _tier = _tier + 1;
+         }
+         else if (load < _low && _tier > 0)
+         {
+            if (++_count >= _hold)
+            {
+               _count = 0;
+               _tier = _tier - 1;
+            }
+         }
+         else
+         {
+            _count = 0;
+         }
+         return _tier;
+      }
+
+      std::size_t tier() const { return _tier; }
+      std::size_t tiers() const { return _tiers; }
+      float load() const { return _load; }
+      float peak_load() const { return _peak; }
+
+   private:
+
+      std::size_t             _tiers;
+      float                   _high;
+      float                   _low;
+      std::uint32_t           _hold;
+
+      std::uint32_t           _count = 0;
+      std::size_t volatile    _tier = 0;
+      float volatile          _load = 0.0f;
+      float volatile          _peak = 0.0f;
+   };
+}}
+
+#endif
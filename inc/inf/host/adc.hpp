@@ -0,0 +1,159 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_HOST_ADC_HPP_NOVEMBER_24_2017)
+#define CYCFI_INFINITY_HOST_ADC_HPP_NOVEMBER_24_2017
+
+#include <inf/host/simulator.hpp>
+#include <inf/timer.hpp>
+#include <inf/support.hpp>
+#include <inf/pin.hpp>
+#include <inf/config.hpp>
+#include <algorithm>
+#include <array>
+#include <utility>
+
+///////////////////////////////////////////////////////////////////////////////
+// Host implementation of inf/adc.hpp. The conversions are supplied by the
+// simulator's adc_source (see host/simulator.hpp). Note that ADC pin
+// conflicts are checked only by the target build.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace cycfi { namespace infinity
+{
+   namespace detail
+   {
+      constexpr bool valid_adc(std::size_t id)
+      {
+         return id >= 1 && id <= 3;
+      }
+
+      constexpr bool valid_adc_channels()
+      {
+         return true;
+      }
+
+      template <typename... Rest>
+      constexpr bool valid_adc_channels(std::size_t channel, Rest... rest)
+      {
+         return channel <= 15 && valid_adc_channels(rest...);
+      }
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // adc
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t id>
+   struct adc_conversion_half_complete {};
+
+   template <std::size_t id>
+   struct adc_conversion_complete {};
+
+   template <
+      std::size_t id_
+    , std::size_t channels_
+    , std::size_t buffer_size_ = 8
+   >
+   class adc
+   {
+   public:
+
+      static_assert(detail::valid_adc(id_), "Invalid ADC id");
+
+      using adc_type = adc;
+      using self_type = adc_type;
+      using sample_group_type = std::array<uint16_t, channels_>;
+      using buffer_type = std::array<sample_group_type, buffer_size_> ;
+      using buffer_iterator_type = typename buffer_type::const_iterator;
+
+      static constexpr std::size_t id = id_;
+      static constexpr std::size_t channels = channels_;
+      static constexpr std::size_t buffer_size = buffer_size_;
+      static constexpr std::size_t resolution = 4096;
+
+      using half_complete_id = adc_conversion_half_complete<id>;
+      using complete_id = adc_conversion_complete<id>;
+
+      template <std::size_t tid>
+      void init(timer<tid> const&)
+      {
+         detail::system_clock_config();
+
+         host::simulator::instance().adc_init(
+            id, tid, &_data[0][0], channels, buffer_size);
+
+         // Clear the ADC buffer
+         clear();
+      }
+
+      template <std::size_t tid, typename F>
+      auto setup(timer<tid> const& tmr, F complete_task)
+      {
+         init(tmr);
+         return [complete_task](auto base)
+         {
+            return make_task_config<complete_id>(base, complete_task);
+         };
+      }
+
+      template <std::size_t tid, typename F1, typename F2>
+      auto setup(timer<tid> const& tmr, F1 half_complete_task, F2 complete_task)
+      {
+         init(tmr);
+         return [complete_task, half_complete_task](auto base)
+         {
+            auto cfg1 = make_task_config<complete_id>(base, complete_task);
+            return make_task_config<half_complete_id>(cfg1, half_complete_task);
+         };
+      }
+
+      template <std::size_t... channels>
+      auto enable_channels()
+      {
+         static_assert(sizeof...(channels) == channels_,
+            "Invalid number of channnels");
+
+         static_assert(detail::valid_adc_channels(channels...),
+            "Invalid ADC Channel");
+
+         return [](auto base)
+         {
+            return make_basic_config<self_type>(base);
+         };
+      }
+
+      void clear()
+      {
+         for (auto& buff : _data)
+            buff.fill(0);
+      }
+
+      void start()
+      {
+         host::simulator::instance().adc_start(id);
+      }
+
+      void stop()
+      {
+         host::simulator::instance().adc_stop(id);
+      }
+
+      constexpr std::size_t size() { return buffer_size; }
+      constexpr std::size_t num_channels() { return channels; }
+
+      buffer_iterator_type begin() const { return _data.begin(); }
+      buffer_iterator_type middle() const { return _data.begin() + (buffer_size / 2); }
+      buffer_iterator_type end() const { return _data.end(); }
+
+      sample_group_type& operator[](std::size_t i) { return _data[i]; }
+      sample_group_type const& operator[](std::size_t i) const { return _data[i]; }
+
+   private:
+
+      buffer_type _data;
+   };
+}}
+
+#endif
@@ -0,0 +1,135 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_HOST_CAPTURE_HPP_NOVEMBER_26_2017)
+#define CYCFI_INFINITY_HOST_CAPTURE_HPP_NOVEMBER_26_2017
+
+#include <inf/host/simulator.hpp>
+#include <inf/capture.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+namespace cycfi { namespace infinity { namespace host
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // capture_file: A memory mapped capture (see capture.hpp). The chunks
+   // are read in place. Throws std::runtime_error if the file cannot be
+   // mapped or is not a valid capture.
+   ////////////////////////////////////////////////////////////////////////////
+   class capture_file
+   {
+   public:
+
+      struct chunk
+      {
+         capture_chunk        type;
+         std::uint8_t const*  data;
+         std::uint32_t        size;
+      };
+
+      capture_file(std::string const& path);
+      ~capture_file();
+
+      capture_file(capture_file const&) = delete;
+      capture_file& operator=(capture_file const&) = delete;
+
+      capture_info const&     info() const { return _info; }
+
+      // Total number of frames (excluding dropped chunks)
+      std::size_t             frames() const { return _frames; }
+
+      // Iterate over the chunks, starting from offset 0. next returns
+      // false at the end of the file (or at a truncated chunk).
+      bool                    next(std::size_t& offset, chunk& c) const;
+
+      // Call f(chunk) for each frames and param chunk, in order
+      template <typename F>
+      void                    for_each(F f) const;
+
+   private:
+
+      std::uint8_t const*     _data = nullptr;
+      std::size_t             _size = 0;
+      capture_info            _info;
+      std::size_t             _frames = 0;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // replay_source: Feeds the ADC from a capture file, bit exactly. The
+   // param chunks are passed to the param handler (see param_handler),
+   // just before the frame they apply to is converted, so the processor
+   // picks them up at the same block as the recording. After the last
+   // frame, the ADC reads mid-scale silence. Gaps in the capture (dropped
+   // chunks) are reported to stderr; the replay is not bit exact past a
+   // gap.
+   ////////////////////////////////////////////////////////////////////////////
+   class replay_source : public adc_source
+   {
+   public:
+
+      replay_source(std::string const& path);
+
+      void operator()(
+         std::size_t adc_id, double time,
+         std::uint16_t* frame, std::size_t channels) override;
+
+      // The duration of the capture (seconds)
+      double seconds() const;
+
+   private:
+
+      capture_file            _file;
+      std::size_t             _offset = 0;
+      std::uint16_t const*    _frame = nullptr;
+      std::uint16_t const*    _end = nullptr;
+      std::uint32_t           _clock = 0;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Parameter changes from a replay. The app installs a handler that
+   // applies the parameter the same way the main loop does. For example:
+   //
+   //    host::param_handler(
+   //       [](std::uint32_t id, float value)
+   //       {
+   //          if (id == param_level)
+   //             proc.update_level(value);
+   //       });
+   ////////////////////////////////////////////////////////////////////////////
+   using param_function = std::function<void(std::uint32_t id, float value)>;
+   void param_handler(param_function f);
+
+   // True if the ADCs are fed by a replay_source. While replaying, the
+   // app should leave the parameters to the replay.
+   bool replaying();
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Write captured data to the --capture file (see init), if any. Can be
+   // passed directly to capture_recorder::flush.
+   ////////////////////////////////////////////////////////////////////////////
+   void capture_write(std::uint8_t const* data, std::size_t len);
+
+   // Open the file for capture_write
+   void capture_output(std::string const& path);
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Implementation
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename F>
+   inline void capture_file::for_each(F f) const
+   {
+      std::size_t offset = 0;
+      chunk c;
+      while (next(offset, c))
+      {
+         if (c.type == capture_chunk::frames || c.type == capture_chunk::param)
+            f(c);
+      }
+   }
+}}}
+
+#endif
@@ -0,0 +1,169 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_HOST_CORPUS_HPP_NOVEMBER_25_2017)
+#define CYCFI_INFINITY_HOST_CORPUS_HPP_NOVEMBER_25_2017
+
+#include <inf/host/string_model.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace cycfi { namespace infinity { namespace host
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // Synthetic test corpus with ground truth. A corpus file holds a
+   // sequence of plucked notes (see plucked_string) with background noise
+   // and hum. Each sample comes with the ground-truth fundamental
+   // frequency (Hz, zero between notes) and phase (in cycles) of the note
+   // at that sample.
+   //
+   // File format (little endian):
+   //
+   //    header         "INFC", version (uint32), sps (uint32),
+   //                   frames (uint32)
+   //    frames         signal, f0, phase (float32 each)
+   ////////////////////////////////////////////////////////////////////////////
+   struct corpus_frame
+   {
+      float    signal;
+      float    f0;
+      float    phase;
+   };
+
+   struct corpus
+   {
+      std::uint32_t              sps = 0;
+      std::vector<corpus_frame>  frames;
+   };
+
+   namespace detail
+   {
+      struct corpus_header
+      {
+         char           magic[4];
+         std::uint32_t  version;
+         std::uint32_t  sps;
+         std::uint32_t  frames;
+      };
+
+      constexpr std::uint32_t corpus_version = 1;
+   }
+
+   inline bool write_corpus(std::string const& path, corpus const& c)
+   {
+      auto file = std::fopen(path.c_str(), "wb");
+      if (!file)
+         return false;
+
+      detail::corpus_header h;
+      std::memcpy(h.magic, "INFC", 4);
+      h.version = detail::corpus_version;
+      h.sps = c.sps;
+      h.frames = c.frames.size();
+
+      bool ok =
+         std::fwrite(&h, sizeof(h), 1, file) == 1 &&
+         std::fwrite(c.frames.data(), sizeof(corpus_frame), c.frames.size(), file)
+            == c.frames.size();
+      return (std::fclose(file) == 0) && ok;
+   }
+
+   inline bool read_corpus(std::string const& path, corpus& c)
+   {
+      auto file = std::fopen(path.c_str(), "rb");
+      if (!file)
+         return false;
+
+      detail::corpus_header h;
+      bool ok =
+         std::fread(&h, sizeof(h), 1, file) == 1 &&
+         std::memcmp(h.magic, "INFC", 4) == 0 &&
+         h.version == detail::corpus_version;
+
+      if (ok)
+      {
+         c.sps = h.sps;
+         c.frames.resize(h.frames);
+         ok = std::fread(c.frames.data(), sizeof(corpus_frame), h.frames, file)
+            == h.frames;
+      }
+      std::fclose(file);
+      return ok;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Generate a corpus of plucked notes, separated by short silences, with
+   // randomized parameters: fundamentals across the guitar range (E2 to
+   // E5), pick positions, decay and rolloff, string stiffness, bends and
+   // vibrato, plus random amounts of noise and 50 or 60 Hz hum. The same
+   // seed always generates the same corpus.
+   ////////////////////////////////////////////////////////////////////////////
+   inline corpus generate_corpus(
+      std::uint32_t seed, std::uint32_t sps, double seconds)
+   {
+      random rnd{ seed };
+      corpus c;
+      c.sps = sps;
+      c.frames.resize(std::size_t(seconds * sps));
+
+      noise_hum nh;
+      nh.noise_level = rnd(0.0, 0.01);
+      nh.hum_level = rnd(0.0, 0.02);
+      nh.hum_freq = (rnd() < 0.5)? 50.0 : 60.0;
+
+      plucked_string str{ sps };
+      std::size_t next = std::size_t(rnd(0.1, 0.5) * sps);
+
+      for (std::size_t i = 0; i != c.frames.size(); ++i)
+      {
+         if (i == next)
+         {
+            pluck p;
+            p.onset = double(i) / sps;
+            p.duration = rnd(1.0, 3.0);
+            p.f0 = 82.41 * std::pow(2.0, rnd(0.0, 3.0));
+            p.level = rnd(0.05, 0.5);
+            p.inharmonicity = rnd(0.0, 1e-4);
+            p.pick_position = rnd(0.05, 0.45);
+            p.decay = rnd(1.0, 6.0);
+            p.rolloff = rnd(0.0, 0.05);
+            if (rnd() < 0.3)
+            {
+               p.bend_cents = rnd(-200.0, 200.0);
+               p.bend_start = rnd(0.2, 0.8);
+               p.bend_time = rnd(0.05, 0.3);
+            }
+            if (rnd() < 0.3)
+            {
+               p.vibrato_rate = rnd(4.0, 7.0);
+               p.vibrato_cents = rnd(5.0, 30.0);
+            }
+            str.start(p);
+
+            // The next note starts after this one is damped, plus a gap
+            next = i + std::size_t((p.duration + 0.1 + rnd(0.2, 1.0)) * sps);
+         }
+
+         constexpr double _2pi = 2.0 * 3.14159265358979323846;
+         auto t = double(i) / sps;
+         auto s = str();
+         s += nh.noise_level * rnd.normal();
+         s += nh.hum_level * std::sin(_2pi * nh.hum_freq * t);
+         s += (nh.hum_level / 3) * std::sin(_2pi * 3 * nh.hum_freq * t);
+
+         auto& f = c.frames[i];
+         f.signal = s;
+         f.f0 = str.f0();
+         f.phase = str.phase();
+      }
+      return c;
+   }
+}}}
+
+#endif
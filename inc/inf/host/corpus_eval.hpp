@@ -0,0 +1,194 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_HOST_CORPUS_EVAL_HPP_NOVEMBER_27_2017)
+#define CYCFI_INFINITY_HOST_CORPUS_EVAL_HPP_NOVEMBER_27_2017
+
+#include <inf/host/corpus.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace cycfi { namespace infinity { namespace host
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // Evaluates a pitch and phase tracker (e.g. the pls) against a corpus
+   // (see corpus.hpp). The measurements are taken at the rising zero
+   // crossings of the tracker's output (linearly interpolated):
+   //
+   //    lock time      From the note onset until the output period stays
+   //                   within 3% of the true period for at least 5 cycles
+   //    octave errors  Output cycles, after the onset, whose period is off
+   //                   by one or more octaves
+   //    phase          The phase of the output relative to the input, after
+   //                   lock. The input phase is taken one latency period
+   //                   later, since the pls advances its output by the
+   //                   latency.
+   //
+   // Results of several corpus files can be accumulated (operator+=) and
+   // summarized with score.
+   ////////////////////////////////////////////////////////////////////////////
+   struct corpus_result
+   {
+      bool                 ok = false;
+      std::size_t          notes = 0;
+      std::size_t          cycles = 0;
+      std::size_t          octave_errors = 0;
+      std::vector<double>  lock_times;    // ms, locked notes only
+      double               phase_cos = 0;
+      double               phase_sin = 0;
+      std::size_t          phase_count = 0;
+
+      void operator+=(corpus_result const& r)
+      {
+         notes += r.notes;
+         cycles += r.cycles;
+         octave_errors += r.octave_errors;
+         lock_times.insert(lock_times.end(), r.lock_times.begin(), r.lock_times.end());
+         phase_cos += r.phase_cos;
+         phase_sin += r.phase_sin;
+         phase_count += r.phase_count;
+      }
+   };
+
+   struct corpus_score
+   {
+      double   locked = 0;          // Fraction of the notes that locked
+      double   lock_ms = 0;         // Mean lock time (ms)
+      double   lock_p90_ms = 0;     // 90th percentile lock time (ms)
+      double   octave_errors = 0;   // Fraction of the output cycles
+      double   phase_offset = 0;    // Mean phase offset (cycles)
+      double   phase_jitter = 0;    // Circular standard deviation (cycles)
+   };
+
+   constexpr double lock_tolerance = 0.03;
+   constexpr std::size_t lock_cycles = 5;
+
+   template <typename Target>
+   corpus_result evaluate(corpus const& c, Target& target, std::uint32_t latency)
+   {
+      struct note_state
+      {
+         double         onset = 0;
+         bool           locked = false;
+         std::size_t    in_tolerance = 0;
+         double         first_in_tolerance = 0;
+      };
+
+      constexpr double _2pi = 2.0 * 3.14159265358979323846;
+      auto const& frames = c.frames;
+      auto const n = frames.size();
+      auto const sps = c.sps;
+
+      corpus_result r;
+      r.ok = true;
+      note_state note;
+      double prev_out = 0;
+      double prev_cross = -1;
+      bool in_note = false;
+
+      for (std::size_t i = 0; i != n; ++i)
+      {
+         auto const& f = frames[i];
+         double out = target(f.signal);
+
+         if (f.f0 > 0 && !in_note)
+         {
+            // Note onset. Record the previous note's lock time.
+            if (r.notes && note.locked)
+               r.lock_times.push_back(note.first_in_tolerance - note.onset);
+            ++r.notes;
+            note = note_state{};
+            note.onset = i;
+            prev_cross = -1;
+         }
+         in_note = f.f0 > 0;
+
+         // Rising zero crossing of the output, linearly interpolated
+         if (in_note && prev_out < 0 && out > 0)
+         {
+            double mu = -prev_out / (out - prev_out);
+            double cross = (i - 1) + mu;
+            if (prev_cross >= 0)
+            {
+               double period = cross - prev_cross;
+               double ratio = (f.f0 * period) / sps;
+               double octaves = std::log2(ratio);
+               double rounded = std::round(octaves);
+               ++r.cycles;
+               if (rounded != 0 && std::abs(octaves - rounded) < 0.1)
+                  ++r.octave_errors;
+
+               if (!note.locked)
+               {
+                  if (std::abs(ratio - 1.0) < lock_tolerance)
+                  {
+                     if (note.in_tolerance++ == 0)
+                        note.first_in_tolerance = prev_cross;
+                     if (note.in_tolerance >= lock_cycles)
+                        note.locked = true;
+                  }
+                  else
+                  {
+                     note.in_tolerance = 0;
+                  }
+               }
+               else
+               {
+                  // Phase error against the input, one latency period later
+                  auto j = i - 1 + latency;
+                  if (j + 1 < n && frames[j].f0 > 0 && frames[j+1].f0 > 0)
+                  {
+                     double ph = frames[j].phase + mu * (frames[j].f0 / sps);
+                     double err = -ph;
+                     r.phase_cos += std::cos(_2pi * err);
+                     r.phase_sin += std::sin(_2pi * err);
+                     ++r.phase_count;
+                  }
+               }
+            }
+            prev_cross = cross;
+         }
+         prev_out = out;
+      }
+
+      if (r.notes && note.locked)
+         r.lock_times.push_back(note.first_in_tolerance - note.onset);
+
+      for (auto& t : r.lock_times)
+         t = t * 1000 / sps;
+      return r;
+   }
+
+   inline corpus_score score(corpus_result r)
+   {
+      constexpr double _2pi = 2.0 * 3.14159265358979323846;
+
+      corpus_score s;
+      s.locked = r.notes? double(r.lock_times.size()) / r.notes : 0;
+      if (!r.lock_times.empty())
+      {
+         for (auto t : r.lock_times)
+            s.lock_ms += t;
+         s.lock_ms /= r.lock_times.size();
+         std::sort(r.lock_times.begin(), r.lock_times.end());
+         s.lock_p90_ms = r.lock_times[(r.lock_times.size() - 1) * 9 / 10];
+      }
+      s.octave_errors = r.cycles? double(r.octave_errors) / r.cycles : 0;
+
+      if (r.phase_count)
+      {
+         auto c = r.phase_cos / r.phase_count;
+         auto si = r.phase_sin / r.phase_count;
+         auto len = std::min(std::sqrt(c*c + si*si), 1.0);
+         s.phase_offset = std::atan2(si, c) / _2pi;
+         s.phase_jitter = (len > 0)? std::sqrt(-2 * std::log(len)) / _2pi : 0.5;
+      }
+      return s;
+   }
+}}}
+
+#endif
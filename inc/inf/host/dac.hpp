@@ -0,0 +1,65 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_HOST_DAC_HPP_NOVEMBER_24_2017)
+#define CYCFI_INFINITY_HOST_DAC_HPP_NOVEMBER_24_2017
+
+#include <inf/host/simulator.hpp>
+#include <inf/config.hpp>
+#include <inf/pin.hpp>
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////////////
+// Host implementation of inf/dac.hpp. The outputs are recorded by the
+// simulator's dac_sink (see host/simulator.hpp).
+///////////////////////////////////////////////////////////////////////////////
+
+namespace cycfi { namespace infinity
+{
+   template <std::size_t Channel>
+   class dac
+   {
+      using dac_peripheral_id = io_pin_id<
+         port::porta + ((Channel == 0) ? 4 : 5)>
+      ;
+
+   public:
+
+      static_assert(Channel >=0 && Channel <= 1, "Invalid DAC Channel");
+
+      void init(uint16_t init_val = 2048)
+      {
+         detail::system_clock_config();
+         start();
+         (*this)(init_val);
+      }
+
+      auto setup(uint16_t init_val = 2048)
+      {
+         init(init_val);
+         return [](auto base)
+         {
+            return make_basic_config<dac_peripheral_id>(base);
+         };
+      }
+
+      void start()
+      {
+      }
+
+      void stop()
+      {
+      }
+
+      void operator()(uint16_t val)
+      {
+         // Write a new value
+         val = std::min<uint16_t>(val, 4095);
+         host::simulator::instance().dac_write(Channel, val);
+      }
+   };
+}}
+
+#endif
@@ -0,0 +1,128 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_HOST_I2C_HPP_NOVEMBER_24_2017)
+#define CYCFI_INFINITY_HOST_I2C_HPP_NOVEMBER_24_2017
+
+#include <inf/host/simulator.hpp>
+#include <inf/pin.hpp>
+#include <inf/config.hpp>
+#include <cstdint>
+
+///////////////////////////////////////////////////////////////////////////////
+// Host implementation of inf/i2c.hpp. Transfers go to the devices
+// attached to the simulator (see host::i2c_device) and take the same
+// (simulated) time as on a 400kHz bus. write_async delivers the data at
+// once and is busy for the transfer time. Note that the SCL and SDA pin
+// assignments are checked only by the target build.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // i2c
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t scl_pin_, std::size_t sda_pin_>
+   struct i2c_master
+   {
+      static constexpr std::size_t scl_pin = scl_pin_;
+      static constexpr std::size_t sda_pin = sda_pin_;
+      using scl_peripheral_id = io_pin_id<scl_pin>;
+      using sda_peripheral_id = io_pin_id<sda_pin>;
+
+      void init()
+      {
+      }
+
+      auto setup()
+      {
+         init();
+         return [](auto base)
+         {
+            auto cfg1 = make_basic_config<scl_peripheral_id>(base);
+            return make_basic_config<sda_peripheral_id>(cfg1);
+         };
+      }
+
+      void write(
+         std::uint32_t addr, std::uint8_t const* data,
+         std::size_t len, uint32_t /*timeout*/ = 0xffffffff
+      )
+      {
+         host::simulator::instance().i2c_write(addr, data, len);
+      }
+
+      void read(
+         std::uint32_t addr, std::uint8_t* data,
+         std::size_t len, uint32_t /*timeout*/ = 0xffffffff
+      )
+      {
+         host::simulator::instance().i2c_read(addr, data, len);
+      }
+
+      void mem_write8(
+         std::uint32_t addr, std::uint16_t mem_addr, std::uint8_t data,
+         uint32_t /*timeout*/ = 0xffffffff
+      )
+      {
+         std::uint8_t buff[] = { std::uint8_t(mem_addr), data };
+         write(addr, buff, sizeof(buff));
+      }
+
+      void mem_write16(
+         std::uint32_t addr, std::uint16_t mem_addr, std::uint16_t data,
+         uint32_t /*timeout*/ = 0xffffffff
+      )
+      {
+         std::uint8_t buff[] =
+         {
+            std::uint8_t(mem_addr >> 8), std::uint8_t(mem_addr),
+            std::uint8_t(data), std::uint8_t(data >> 8)
+         };
+         write(addr, buff, sizeof(buff));
+      }
+
+      std::uint8_t mem_read8(
+         std::uint32_t addr, std::uint16_t mem_addr, uint32_t /*timeout*/ = 0xffffffff
+      )
+      {
+         std::uint8_t reg = mem_addr;
+         std::uint8_t result;
+         write(addr, &reg, 1);
+         read(addr, &result, 1);
+         return result;
+      }
+
+      std::uint16_t mem_read16(
+         std::uint32_t addr, std::uint16_t mem_addr, uint32_t /*timeout*/ = 0xffffffff
+      )
+      {
+         std::uint8_t reg[] = { std::uint8_t(mem_addr >> 8), std::uint8_t(mem_addr) };
+         std::uint8_t result[2];
+         write(addr, reg, sizeof(reg));
+         read(addr, result, sizeof(result));
+         return result[0] | (result[1] << 8);
+      }
+
+      void write_async(
+         std::uint32_t addr, std::uint8_t const* data, std::size_t len
+      )
+      {
+         host::simulator::instance().i2c_write_async(addr, data, len);
+      }
+
+      bool busy() const
+      {
+         return host::simulator::instance().i2c_busy();
+      }
+
+      bool failed() const
+      {
+         return false;
+      }
+   };
+}}
+
+#endif
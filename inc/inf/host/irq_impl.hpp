@@ -0,0 +1,99 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_HOST_IRQ_IMPL_HPP_NOVEMBER_24_2017)
+#define CYCFI_INFINITY_HOST_IRQ_IMPL_HPP_NOVEMBER_24_2017
+
+///////////////////////////////////////////////////////////////////////////////
+// This implementation is for the host simulator. Instead of defining the
+// "C" interrupt handlers, we install the interrupt vectors in the
+// simulator. Like the target version, this must be included after the
+// global config variable is defined.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <inf/host/simulator.hpp>
+#include <inf/pin.hpp>
+#include <inf/timer.hpp>
+#include <inf/adc.hpp>
+#include <inf/software_irq.hpp>
+#include <inf/uart.hpp>
+#include <utility>
+
+namespace cycfi { namespace infinity { namespace host { namespace detail
+{
+   template <std::size_t N>
+   void handle_timer_interrupt()
+   {
+      ::config(identity<cycfi::infinity::timer<N>>{});
+   }
+
+   template <std::size_t N>
+   void handle_exti()
+   {
+      ::config(identity<cycfi::infinity::exti_id<N>>{});
+   }
+
+   template <std::size_t N>
+   void handle_adc_half_complete()
+   {
+      ::config(cycfi::infinity::adc_conversion_half_complete<N>{});
+   }
+
+   template <std::size_t N>
+   void handle_adc_complete()
+   {
+      ::config(cycfi::infinity::adc_conversion_complete<N>{});
+   }
+
+   template <std::size_t N>
+   void handle_uart_tx_complete()
+   {
+      ::config(cycfi::infinity::uart_tx_complete<N>{});
+   }
+
+   inline void handle_software_irq()
+   {
+      ::config(cycfi::infinity::software_irq_id{});
+   }
+
+   template <
+      std::size_t... timers, std::size_t... extis
+    , std::size_t... adcs, std::size_t... uarts>
+   inline void install_vectors(
+      std::index_sequence<timers...>
+    , std::index_sequence<extis...>
+    , std::index_sequence<adcs...>
+    , std::index_sequence<uarts...>)
+   {
+      auto& v = simulator::instance().vectors();
+      int dummy[] =
+      {
+         (v.timer[timers + 1] = &handle_timer_interrupt<timers + 1>, 0)...,
+         (v.exti[extis] = &handle_exti<extis>, 0)...,
+         (v.adc_half_complete[adcs + 1] = &handle_adc_half_complete<adcs + 1>, 0)...,
+         (v.adc_complete[adcs + 1] = &handle_adc_complete<adcs + 1>, 0)...,
+         (v.uart_tx_complete[uarts + 1] = &handle_uart_tx_complete<uarts + 1>, 0)...
+      };
+      (void) dummy;
+      v.software_irq = &handle_software_irq;
+   }
+
+   struct vector_installer
+   {
+      vector_installer()
+      {
+         install_vectors(
+            std::make_index_sequence<14>{}     // Timers 1 to 14
+          , std::make_index_sequence<16>{}     // EXTI 0 to 15
+          , std::make_index_sequence<3>{}      // ADC 1 to 3
+          , std::make_index_sequence<6>{}      // UART 1 to 6
+         );
+      }
+   };
+
+   vector_installer const install;
+}}}}
+
+#endif
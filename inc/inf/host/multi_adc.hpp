@@ -0,0 +1,34 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_HOST_MULTI_ADC_HPP_NOVEMBER_24_2017)
+#define CYCFI_INFINITY_HOST_MULTI_ADC_HPP_NOVEMBER_24_2017
+
+#include <inf/adc.hpp>
+#include <inf/detail/multi_adc_layout.hpp>
+
+///////////////////////////////////////////////////////////////////////////////
+// Host implementation of multi_adc (see inf/multi_adc.hpp). All the
+// channels are converted at the same instant, so the simultaneous modes
+// behave exactly like a single ADC (ADC1, the master).
+///////////////////////////////////////////////////////////////////////////////
+
+namespace cycfi { namespace infinity
+{
+   template <
+      std::size_t num_adcs_
+    , std::size_t channels_
+    , std::size_t buffer_size_ = 8
+   >
+   class multi_adc : public adc<1, channels_, buffer_size_>
+   {
+   public:
+
+      using layout = detail::multi_adc_layout<num_adcs_, channels_>;
+      static constexpr std::size_t num_adcs = num_adcs_;
+   };
+}}
+
+#endif
@@ -0,0 +1,307 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_HOST_PIN_HPP_NOVEMBER_24_2017)
+#define CYCFI_INFINITY_HOST_PIN_HPP_NOVEMBER_24_2017
+
+#include <inf/host/simulator.hpp>
+#include <inf/config.hpp>
+#include <inf/support.hpp>
+
+///////////////////////////////////////////////////////////////////////////////
+// Host implementation of inf/pin.hpp. The port registers are simulated
+// (see host/simulator.hpp).
+///////////////////////////////////////////////////////////////////////////////
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // Constants
+   ////////////////////////////////////////////////////////////////////////////
+
+   namespace port
+   {
+      constexpr uint16_t porta = 0 * 16;
+      constexpr uint16_t portb = 1 * 16;
+      constexpr uint16_t portc = 2 * 16;
+      constexpr uint16_t portd = 3 * 16;
+      constexpr uint16_t porte = 4 * 16;
+      constexpr uint16_t portf = 5 * 16;
+      constexpr uint16_t portg = 6 * 16;
+      constexpr uint16_t porth = 7 * 16;
+      constexpr uint16_t porti = 8 * 16;
+   }
+
+   enum class port_output_speed
+   {
+      low_speed,
+      mid_speed,
+      high_speed,
+      very_high_speed
+   };
+
+   enum class port_output_type
+   {
+      push_pull,
+      open_drain
+   };
+
+   namespace port
+   {
+      auto constexpr low_speed = port_output_speed::low_speed;
+      auto constexpr mid_speed = port_output_speed::mid_speed;
+      auto constexpr high_speed = port_output_speed::high_speed;
+      auto constexpr very_high_speed = port_output_speed::very_high_speed;
+
+      auto constexpr push_pull = port_output_type::push_pull;
+      auto constexpr open_drain = port_output_type::open_drain;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename T>
+   struct inverse_pin
+   {
+      operator bool() const
+      {
+         return pin.off();
+      }
+
+      T operator!() const
+      {
+         return pin;
+      }
+
+      T pin;
+   };
+
+   struct on_type
+   {
+      operator bool() const
+      {
+         return true;
+      }
+
+      bool operator!() const
+      {
+         return false;
+      }
+   };
+
+   struct off_type
+   {
+      operator bool() const
+      {
+         return false;
+      }
+
+      bool operator!() const
+      {
+         return true;
+      }
+   };
+
+   namespace port
+   {
+      constexpr on_type on = {};
+      constexpr off_type off = {};
+   }
+
+   template <std::size_t N>
+   struct io_pin_id {};
+
+   ////////////////////////////////////////////////////////////////////////////
+   // output_pin
+   ////////////////////////////////////////////////////////////////////////////
+   template <
+      std::size_t N,
+      port_output_speed speed = port::high_speed,
+      port_output_type type = port::push_pull
+   >
+   struct output_pin
+   {
+      static constexpr size_t    n = N;
+      static constexpr uint16_t  bit = N % 16;
+      static constexpr uint16_t  port = N / 16;
+      static constexpr uint32_t  mask = 1 << bit;
+
+      // there are only 9 ports
+      static_assert(port < 9, "Invalid port");
+
+      using self_type = output_pin;
+      using inverse_type = inverse_pin<output_pin>;
+      using peripheral_id = io_pin_id<N>;
+
+      output_pin() = default;
+      output_pin(output_pin const&) = default;
+
+      void init()
+      {
+      }
+
+      auto setup()
+      {
+         init();
+         return [](auto base)
+            -> basic_config<peripheral_id, decltype(base)>
+         {
+            return {base};
+         };
+      }
+
+      volatile uint32_t& ref() const
+      {
+         return host::simulator::instance().odr(port);
+      }
+
+      bool state() const
+      {
+         return (ref() & mask) != 0;
+      }
+
+      inverse_type operator!() const
+      {
+         return { *this };
+      }
+
+      output_pin& operator=(bool val)
+      {
+         ref() ^= (-uint16_t(val) ^ ref()) & mask;
+         return *this;
+      }
+
+      output_pin& operator=(self_type)
+      {
+         return *this;
+      }
+
+      output_pin& operator=(inverse_type)
+      {
+         ref() ^= mask;
+         return *this;
+      }
+
+      output_pin& operator=(on_type)
+      {
+         ref() |= mask;
+         return *this;
+      }
+
+      output_pin& operator=(off_type)
+      {
+         ref() &= ~mask;
+         return *this;
+      }
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // input_pin. Use host::simulator::set_input to drive the pin.
+   ////////////////////////////////////////////////////////////////////////////
+   enum class port_input_type
+   {
+      normal,
+      pull_up,
+      pull_down
+   };
+
+   enum class port_edge
+   {
+      rising,
+      falling
+   };
+
+   namespace port
+   {
+      auto constexpr pull_up = port_input_type::pull_up;
+      auto constexpr pull_down = port_input_type::pull_down;
+      auto constexpr rising_edge = port_edge::rising;
+      auto constexpr falling_edge = port_edge::falling;
+   }
+
+   template <std::size_t N>
+   struct exti_id {};
+
+   template <std::size_t N, port_input_type type = port_input_type::normal>
+   struct input_pin
+   {
+      static constexpr size_t    n = N;
+      static constexpr uint16_t  bit = N % 16;
+      static constexpr uint16_t  port = N / 16;
+      static constexpr uint32_t  mask = 1 << bit;
+
+      // there are only 8 ports
+      static_assert(port < 8, "Invalid port");
+
+      using self_type = input_pin;
+      using peripheral_id = io_pin_id<N>;
+      using interrupt_id = exti_id<bit>;
+
+      input_pin() = default;
+      input_pin(input_pin const&) = default;
+
+      void init()
+      {
+         // An unconnected input follows its pull-up or pull-down resistor
+         host::simulator::instance().set_input(N, type == port::pull_up);
+      }
+
+      auto setup()
+      {
+         init();
+         return [](auto base)
+         {
+            return make_basic_config<peripheral_id>(base);
+         };
+      }
+
+      template <typename F>
+      auto setup(F task, std::size_t /*priority*/ = 0)
+      {
+         init();
+         enable_interrupt();
+
+         return [task](auto base)
+         {
+            auto cfg1 = make_basic_config<peripheral_id>(base);
+            return make_task_config<interrupt_id>(cfg1, task);
+         };
+      }
+
+      void enable_interrupt(std::size_t /*priority*/ = 0)
+      {
+      }
+
+      void start(port_edge edge = port::falling_edge)
+      {
+         host::simulator::instance().exti_enable(N, edge == port_edge::rising);
+      }
+
+      void stop(port_edge edge)
+      {
+         host::simulator::instance().exti_disable(N);
+      }
+
+      auto& ref() const
+      {
+         return host::simulator::instance().idr(port);
+      }
+
+      bool state() const
+      {
+         return (ref() & mask) != 0;
+      }
+
+      operator bool() const
+      {
+         return state();
+      }
+
+      bool operator!() const
+      {
+         return !state();
+      }
+   };
+}}
+
+#endif
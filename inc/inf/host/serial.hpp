@@ -0,0 +1,48 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_HOST_SERIAL_HPP_NOVEMBER_29_2017)
+#define CYCFI_INFINITY_HOST_SERIAL_HPP_NOVEMBER_29_2017
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace cycfi { namespace infinity { namespace host
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // serial_port: Reads from a serial device (e.g. the ST-LINK virtual COM
+   // port, /dev/ttyACM0), in raw mode, 8N1 at the given baud rate. Also
+   // reads plain files and FIFOs (e.g. the simulator's --uart output), in
+   // which case the baud rate is ignored. Throws std::runtime_error if the
+   // device cannot be opened or the baud rate is not supported.
+   ////////////////////////////////////////////////////////////////////////////
+   class serial_port
+   {
+   public:
+
+      serial_port(std::string const& path, std::uint32_t baud_rate = 115200);
+      ~serial_port();
+
+      serial_port(serial_port const&) = delete;
+      serial_port& operator=(serial_port const&) = delete;
+
+      // Read up to len bytes. Waits up to timeout_ms milliseconds for data
+      // (-1: forever). Returns the number of bytes read: 0 on timeout, -1
+      // at the end of a file (or if the device is gone).
+      int                     read(
+                                 std::uint8_t* data, std::size_t len
+                               , int timeout_ms = -1);
+
+      bool                    is_tty() const { return _tty; }
+
+   private:
+
+      int                     _fd;
+      bool                    _tty = false;
+   };
+}}}
+
+#endif
@@ -0,0 +1,353 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_HOST_SIMULATOR_HPP_NOVEMBER_24_2017)
+#define CYCFI_INFINITY_HOST_SIMULATOR_HPP_NOVEMBER_24_2017
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cycfi { namespace infinity { namespace host
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // The host (Linux) backend. Define INFINITY_HOST to build inc/inf and
+   // the apps against simulated peripherals instead of the STM32F4 LL
+   // drivers. The timer, adc, multi_adc, dac, pin, i2c, uart and
+   // software_irq headers then include their host counterparts in
+   // inc/inf/host. For example:
+   //
+   //    g++ -O2 -std=c++14 -DINFINITY_HOST -I inc -I q/q_lib/include
+   //       app/start.cpp src/main.cpp src/host/simulator.cpp
+   //       src/host/capture.cpp src/inf/canvas.cpp -o start
+   //
+   //    ./start --duration 30 --sine 82.4,110,146.8 --output out.raw
+   //
+   // Time is simulated. The simulator keeps a virtual core clock (see
+   // core_clock) that advances only when the main loop waits (delay_ms) or
+   // does blocking I/O (i2c). While advancing, all the timer, ADC (DMA),
+   // EXTI and software interrupts that fall due are dispatched in order.
+   // Each interrupt runs to completion in zero simulated time, so apps run
+   // as fast as the host can process the interrupts, typically much faster
+   // than real time.
+   //
+   // The ADCs are fed by an adc_source (mid-scale silence by default) and
+   // the DACs are recorded by a dac_sink (none by default). The simulation
+   // ends, and the process exits, when the simulated time reaches the
+   // configured duration.
+   ////////////////////////////////////////////////////////////////////////////
+
+   // The simulated core clock (the STM32F446 at full speed)
+   constexpr std::uint32_t core_clock = 180000000;
+
+   // Interrupt service routine
+   using isr_type = void(*)();
+
+   // The interrupt vectors, installed by inf/irq.hpp
+   struct vector_table
+   {
+      std::array<isr_type, 15>   timer = {{}};              // by timer id
+      std::array<isr_type, 4>    adc_half_complete = {{}};  // by adc id
+      std::array<isr_type, 4>    adc_complete = {{}};       // by adc id
+      std::array<isr_type, 16>   exti = {{}};               // by pin bit
+      std::array<isr_type, 7>    uart_tx_complete = {{}};   // by uart id
+      isr_type                   software_irq = nullptr;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // adc_source: Supplies the ADC conversions. Called once per conversion
+   // (timer trigger) with the ADC id, the simulated time in seconds, and
+   // the frame to fill with 12-bit samples.
+   ////////////////////////////////////////////////////////////////////////////
+   class adc_source
+   {
+   public:
+
+      virtual ~adc_source() = default;
+      virtual void operator()(
+         std::size_t adc_id, double time,
+         std::uint16_t* frame, std::size_t channels) = 0;
+   };
+
+   // Generates signals from a function of time and channel returning
+   // -1.0 to 1.0, mapped to the full 12-bit range.
+   class signal_source : public adc_source
+   {
+   public:
+
+      using function = std::function<float(double time, std::size_t channel)>;
+
+      signal_source(function f);
+
+      void operator()(
+         std::size_t adc_id, double time,
+         std::uint16_t* frame, std::size_t channels) override;
+
+   private:
+
+      function _f;
+   };
+
+   // Channel i gets a sine wave at frequencies[i] (the last frequency is
+   // used for the remaining channels).
+   std::unique_ptr<adc_source>
+   sine_source(std::vector<float> frequencies, float level = 0.5f);
+
+   // Reads interleaved frames of 16-bit (little endian, 12-bit right
+   // aligned) samples from a raw file. The file must have the same number
+   // of channels as the ADC. Loops back to the start at the end of the
+   // file.
+   class file_source : public adc_source
+   {
+   public:
+
+      file_source(std::string const& path);
+
+      void operator()(
+         std::size_t adc_id, double time,
+         std::uint16_t* frame, std::size_t channels) override;
+
+   private:
+
+      std::vector<std::uint16_t> _data;
+      std::size_t _pos = 0;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // dac_sink: Records the DAC outputs. Called once per interrupt that
+   // wrote to any of the DACs, with the simulated time in seconds and the
+   // current values of both channels.
+   ////////////////////////////////////////////////////////////////////////////
+   class dac_sink
+   {
+   public:
+
+      virtual ~dac_sink() = default;
+      virtual void operator()(
+         double time, std::uint16_t left, std::uint16_t right) = 0;
+   };
+
+   // Writes interleaved (left, right) frames of 16-bit samples to a raw
+   // file.
+   class file_sink : public dac_sink
+   {
+   public:
+
+      file_sink(std::string const& path);
+      ~file_sink();
+
+      file_sink(file_sink const&) = delete;
+      file_sink& operator=(file_sink const&) = delete;
+
+      void operator()(
+         double time, std::uint16_t left, std::uint16_t right) override;
+
+   private:
+
+      std::FILE* _file;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // i2c_device: A device attached to the simulated I2C bus. Transfers to
+   // addresses without a device are discarded (reads return zeroes).
+   ////////////////////////////////////////////////////////////////////////////
+   class i2c_device
+   {
+   public:
+
+      virtual ~i2c_device() = default;
+      virtual void write(std::uint8_t const* data, std::size_t len) = 0;
+      virtual void read(std::uint8_t* data, std::size_t len) = 0;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // simulator
+   ////////////////////////////////////////////////////////////////////////////
+   class simulator
+   {
+   public:
+
+      static constexpr std::size_t num_timers = 15;   // 1 to 14
+      static constexpr std::size_t num_adcs = 4;      // 1 to 3
+      static constexpr std::size_t num_ports = 9;
+      static constexpr std::size_t num_uarts = 7;     // 1 to 6
+      static constexpr std::uint32_t i2c_clock_speed = 400000;
+
+      static simulator&       instance();
+
+      // Time
+      std::uint64_t           now() const { return _now; }
+      double                  time() const { return double(_now) / core_clock; }
+      void                    advance(std::uint64_t cycles);
+      void                    duration(double seconds);
+
+      vector_table&           vectors() { return _vectors; }
+
+      // Timers. The period is in core clock cycles.
+      void                    timer_init(std::size_t id, std::uint64_t period);
+      void                    timer_enable_interrupt(std::size_t id);
+      void                    timer_start(std::size_t id);
+      void                    timer_stop(std::size_t id);
+
+      // ADCs. A conversion of all channels is done on each update of the
+      // trigger timer. The conversions are transferred (DMA) to the
+      // circular buffer, generating the half-complete and complete
+      // interrupts.
+      void                    adc_init(
+                                 std::size_t id, std::size_t timer_id
+                               , std::uint16_t* buffer
+                               , std::size_t channels, std::size_t frames);
+      void                    adc_start(std::size_t id);
+      void                    adc_stop(std::size_t id);
+      void                    source(std::unique_ptr<adc_source> src);
+
+      // DACs
+      void                    dac_write(std::size_t channel, std::uint16_t val);
+      std::uint16_t           dac(std::size_t channel) const { return _dac[channel]; }
+      void                    sink(std::unique_ptr<dac_sink> snk);
+
+      // GPIO. set_input drives an input pin, triggering its EXTI interrupt
+      // on the enabled edge.
+      std::uint32_t volatile& odr(std::size_t port) { return _odr[port]; }
+      std::uint32_t volatile& idr(std::size_t port) { return _idr[port]; }
+      void                    set_input(std::size_t pin, bool state);
+      void                    exti_enable(std::size_t pin, bool rising);
+      void                    exti_disable(std::size_t pin);
+
+      // I2C. Blocking transfers; the simulated time advances by the bus
+      // transfer time. i2c_write_async (DMA) does not wait: the bus is
+      // busy for the transfer time, and the blocking transfers wait for
+      // it first.
+      void                    attach(std::uint32_t addr, i2c_device* dev);
+      void                    i2c_write(
+                                 std::uint32_t addr
+                               , std::uint8_t const* data, std::size_t len);
+      void                    i2c_read(
+                                 std::uint32_t addr
+                               , std::uint8_t* data, std::size_t len);
+      void                    i2c_write_async(
+                                 std::uint32_t addr
+                               , std::uint8_t const* data, std::size_t len);
+      bool                    i2c_busy() const { return _now < _i2c_complete; }
+
+      // Software interrupt (PendSV)
+      void                    pend_software_irq();
+
+      // UART transmit (DMA). Non-blocking: the data is written to the UART
+      // output (see uart_output) and the transfer complete interrupt is
+      // dispatched after the transfer time (8N1 at the baud rate).
+      void                    uart_write(
+                                 std::size_t id
+                               , std::uint8_t const* data, std::size_t len
+                               , std::uint32_t baud_rate);
+
+      // Send the UART output to a file, FIFO or tty (raw mode). Without
+      // an output, UART data is discarded.
+      void                    uart_output(std::string const& path);
+
+      // Write the trace ring (see trace.hpp) to a file when the simulation
+      // ends
+      void                    trace_output(std::string path) { _trace_path = path; }
+
+   private:
+
+      simulator();
+      simulator(simulator const&) = delete;
+      simulator& operator=(simulator const&) = delete;
+
+      struct timer_state
+      {
+         std::uint64_t        period = 0;
+         std::uint64_t        next = 0;
+         bool                 running = false;
+         bool                 interrupt = false;
+      };
+
+      struct adc_state
+      {
+         std::size_t          timer_id = 0;
+         std::uint16_t*       buffer = nullptr;
+         std::size_t          channels = 0;
+         std::size_t          frames = 0;
+         std::size_t          pos = 0;
+         bool                 running = false;
+      };
+
+      struct exti_state
+      {
+         std::size_t          port = 0;
+         bool                 enabled = false;
+         bool                 rising = false;
+      };
+
+      struct uart_state
+      {
+         std::uint64_t        complete = 0;
+         bool                 busy = false;
+      };
+
+      void                    update(std::size_t timer_id);
+      void                    convert(std::size_t adc_id);
+      void                    dispatch(isr_type isr);
+      void                    i2c_transfer(std::size_t bytes);
+      void                    i2c_deliver(
+                                 std::uint32_t addr
+                               , std::uint8_t const* data, std::size_t len);
+      void                    i2c_wait();
+      [[noreturn]] void       finish();
+
+      using timer_array = std::array<timer_state, num_timers>;
+      using adc_array = std::array<adc_state, num_adcs>;
+      using exti_array = std::array<exti_state, 16>;
+      using uart_array = std::array<uart_state, num_uarts>;
+      using port_array = std::array<std::uint32_t volatile, num_ports>;
+
+      std::uint64_t           _now = 0;
+      std::uint64_t           _end;
+      vector_table            _vectors;
+      timer_array             _timers;
+      adc_array               _adcs;
+      exti_array              _exti;
+      uart_array              _uarts;
+      port_array              _odr = {{}};
+      port_array              _idr = {{}};
+      std::uint16_t           _dac[2] = { 2048, 2048 };
+      bool                    _dac_written = false;
+      bool                    _pend_software_irq = false;
+      std::size_t             _depth = 0;
+      std::unique_ptr<adc_source> _source;
+      std::unique_ptr<dac_sink> _sink;
+      std::vector<std::pair<std::uint32_t, i2c_device*>> _i2c_devices;
+      std::uint64_t           _i2c_complete = 0;
+      std::string             _trace_path;
+      int                     _uart_fd = -1;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Parse the command line and configure the simulator. Options:
+   //
+   //    --duration <seconds>    Simulated run time (default: 10 seconds)
+   //    --sine <f0,f1,...>      Feed the ADC channels with sine waves
+   //    --input <file>          Feed the ADCs from a raw file (see file_source)
+   //    --output <file>         Record the DACs to a raw file (see file_sink)
+   //    --replay <file>         Feed the ADCs from a capture file (see
+   //                            replay_source). Unless --duration is given,
+   //                            runs until the end of the capture.
+   //    --capture <file>        Write the app's ADC capture to a file (see
+   //                            capture_write)
+   //    --trace <file>          Write the trace ring to a file at the end
+   //                            (see trace.hpp and tools/trace_decode.cpp)
+   //    --uart <file>           Send the UART output to a file, FIFO or tty
+   //                            (see telemetry.hpp and
+   //                            tools/telemetry_view.cpp)
+   ////////////////////////////////////////////////////////////////////////////
+   void init(int argc, char const* argv[]);
+}}}
+
+#endif
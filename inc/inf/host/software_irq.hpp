@@ -0,0 +1,48 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_HOST_SOFTWARE_IRQ_HPP_NOVEMBER_24_2017)
+#define CYCFI_INFINITY_HOST_SOFTWARE_IRQ_HPP_NOVEMBER_24_2017
+
+#include <inf/host/simulator.hpp>
+#include <inf/support.hpp>
+#include <inf/config.hpp>
+
+///////////////////////////////////////////////////////////////////////////////
+// Host implementation of inf/software_irq.hpp. The simulator runs the
+// pending task as soon as no other interrupt is active.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace cycfi { namespace infinity
+{
+   struct software_irq_id {};
+
+   struct software_irq
+   {
+      using self_type = software_irq;
+      using id = software_irq_id;
+
+      void init()
+      {
+      }
+
+      template <typename F>
+      auto setup(F task)
+      {
+         init();
+         return [task](auto base)
+         {
+            return make_task_config<id>(base, task);
+         };
+      }
+
+      static void pend()
+      {
+         host::simulator::instance().pend_software_irq();
+      }
+   };
+}}
+
+#endif
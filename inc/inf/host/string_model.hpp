@@ -0,0 +1,314 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_HOST_STRING_MODEL_HPP_NOVEMBER_25_2017)
+#define CYCFI_INFINITY_HOST_STRING_MODEL_HPP_NOVEMBER_25_2017
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace cycfi { namespace infinity { namespace host
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // random: A portable random number source. The std distributions are
+   // implementation defined, so we derive our own from mt19937 to make
+   // sure a given seed generates the same corpus everywhere.
+   ////////////////////////////////////////////////////////////////////////////
+   class random
+   {
+   public:
+
+      random(std::uint32_t seed)
+       : _gen(seed)
+      {}
+
+      // Uniform in [0, 1)
+      double operator()()
+      {
+         return _gen() / 4294967296.0;
+      }
+
+      // Uniform in [lo, hi)
+      double operator()(double lo, double hi)
+      {
+         return lo + (hi - lo) * (*this)();
+      }
+
+      // Normal, zero mean, unit variance (Box-Muller)
+      double normal()
+      {
+         constexpr double _2pi = 2.0 * 3.14159265358979323846;
+         auto u1 = 1.0 - (*this)();
+         auto u2 = (*this)();
+         return std::sqrt(-2.0 * std::log(u1)) * std::cos(_2pi * u2);
+      }
+
+   private:
+
+      std::mt19937 _gen;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // pluck: The parameters of a plucked note (see plucked_string)
+   ////////////////////////////////////////////////////////////////////////////
+   struct pluck
+   {
+      double   onset = 0.0;         // Note start (seconds)
+      double   duration = 1.0;      // Note length, then a quick damp (seconds)
+      double   f0 = 110.0;          // Nominal frequency (Hz)
+      double   level = 0.3;         // Peak level of the fundamental
+      double   inharmonicity = 0.0; // Stiffness coefficient B
+      double   pick_position = 0.2; // Relative to the string length (0 to 0.5)
+      double   decay = 4.0;         // Fundamental decay time constant (seconds)
+      double   rolloff = 0.02;      // Faster decay of the upper partials
+      double   bend_cents = 0.0;    // Bend amount (cents)
+      double   bend_start = 0.0;    // Bend start, relative to onset (seconds)
+      double   bend_time = 0.0;     // Bend duration (seconds)
+      double   vibrato_rate = 0.0;  // Vibrato rate (Hz)
+      double   vibrato_cents = 0.0; // Vibrato depth (cents)
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // plucked_string: An additive stiff-string model. Partial n of a string
+   // with fundamental f and inharmonicity B has the frequency:
+   //
+   //    f(n) = n * f * sqrt(1 + B * n^2)
+   //
+   // Its initial amplitude is shaped by the pick position p (sin(n*pi*p)
+   // / n^2, for an ideal pluck) and it decays exponentially, with the
+   // upper partials decaying faster (see pluck::rolloff). Bends and
+   // vibrato modulate all the partials. Partials above 0.45 * sps are
+   // omitted.
+   //
+   // Since the partials are synthesized directly, the ground truth is
+   // exact: f0() is the instantaneous frequency of the first partial and
+   // phase() its phase (in cycles, 0 to 1; the first partial is a sine, so
+   // phase 0 is its positive going zero crossing).
+   ////////////////////////////////////////////////////////////////////////////
+   class plucked_string
+   {
+   public:
+
+      static constexpr std::size_t max_partials = 32;
+
+      plucked_string(std::uint32_t sps)
+       : _sps(sps)
+      {}
+
+      void start(pluck const& p)
+      {
+         _pluck = p;
+         _t = 0.0;
+         _partials.clear();
+         for (std::size_t n = 1; n <= max_partials; ++n)
+         {
+            auto ratio = n * std::sqrt(1.0 + p.inharmonicity * n * n);
+            if (ratio * p.f0 > 0.45 * _sps)
+               break;
+
+            constexpr double pi = 3.14159265358979323846;
+            partial pt;
+            pt.ratio = ratio;
+            pt.amplitude = p.level * std::sin(n * pi * p.pick_position)
+               / (n * n * std::sin(pi * p.pick_position));
+            pt.decay = std::exp(
+               -(1.0 + p.rolloff * n * n) / (p.decay * _sps));
+            pt.phase = 0.0;
+            _partials.push_back(pt);
+         }
+         _active = true;
+      }
+
+      double operator()()
+      {
+         if (!_active)
+            return 0.0;
+
+         auto const& p = _pluck;
+         double cents = 0.0;
+         if (p.bend_cents != 0.0 && _t > p.bend_start)
+         {
+            auto x = (p.bend_time > 0.0)?
+               std::min((_t - p.bend_start) / p.bend_time, 1.0) : 1.0;
+            cents += p.bend_cents * x;
+         }
+         if (p.vibrato_cents != 0.0)
+         {
+            constexpr double _2pi = 2.0 * 3.14159265358979323846;
+            cents += p.vibrato_cents * std::sin(_2pi * p.vibrato_rate * _t);
+         }
+
+         // Damp quickly (20ms) after the note duration
+         double damp = 1.0;
+         if (_t > p.duration)
+         {
+            damp = std::exp(-(_t - p.duration) / 0.02);
+            if (damp < 1e-5)
+               _active = false;
+         }
+
+         _f = p.f0 * std::pow(2.0, cents / 1200.0);
+
+         constexpr double _2pi = 2.0 * 3.14159265358979323846;
+         double s = 0.0;
+         _phase = _partials.empty()? 0.0 : _partials[0].phase;
+         for (auto& pt : _partials)
+         {
+            s += pt.amplitude * std::sin(_2pi * pt.phase);
+            pt.phase += (_f * pt.ratio) / _sps;
+            pt.phase -= std::floor(pt.phase);
+            pt.amplitude *= pt.decay;
+         }
+
+         _t += 1.0 / _sps;
+         return s * damp;
+      }
+
+      bool active() const { return _active; }
+
+      // Ground truth for the last sample returned by operator()
+      // (zero if not active)
+      double f0() const
+      {
+         return (_active && !_partials.empty())? _f * _partials[0].ratio : 0.0;
+      }
+
+      double phase() const
+      {
+         return _active? _phase : 0.0;
+      }
+
+   private:
+
+      struct partial
+      {
+         double   ratio;
+         double   amplitude;
+         double   decay;
+         double   phase;
+      };
+
+      std::uint32_t        _sps;
+      pluck                _pluck;
+      std::vector<partial> _partials;
+      double               _t = 0.0;
+      double               _f = 0.0;
+      double               _phase = 0.0;
+      bool                 _active = false;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // string_resonator: A modal model of a damped string that can be driven
+   // by an external force, for closed-loop (sustain) simulation. Each
+   // partial (see plucked_string) is a complex one-pole resonator with
+   // the partial's frequency and decay:
+   //
+   //    z(n) = r * exp(j * w) * z(n-1) + g * x(n)
+   //
+   // The force x is coupled to each partial by the mode shape at the
+   // driver position. g is normalized such that a unit force at the
+   // fundamental frequency sustains a unit amplitude fundamental. The
+   // output is the displacement read by the pickup, normalized to the
+   // fundamental.
+   ////////////////////////////////////////////////////////////////////////////
+   class string_resonator
+   {
+   public:
+
+      struct config
+      {
+         double   f0 = 110.0;             // Fundamental frequency (Hz)
+         double   inharmonicity = 0.0;    // Stiffness coefficient B
+         double   decay = 3.0;            // Fundamental decay time constant (seconds)
+         double   rolloff = 0.02;         // Faster decay of the upper partials
+         double   driver_position = 0.3;  // Relative to the string length
+         double   pickup_position = 0.1;  // Relative to the string length
+      };
+
+      string_resonator(std::uint32_t sps, config const& cfg)
+       : _f0(cfg.f0)
+      {
+         constexpr double pi = 3.14159265358979323846;
+         auto r1 = std::exp(-1.0 / (cfg.decay * sps));
+         for (std::size_t n = 1; n <= plucked_string::max_partials; ++n)
+         {
+            auto ratio = n * std::sqrt(1.0 + cfg.inharmonicity * n * n);
+            if (ratio * cfg.f0 > 0.45 * sps)
+               break;
+
+            auto r = std::exp(-(1.0 + cfg.rolloff * n * n) / (cfg.decay * sps));
+            auto w = 2.0 * pi * ratio * cfg.f0 / sps;
+
+            mode m;
+            m.a_re = r * std::cos(w);
+            m.a_im = r * std::sin(w);
+            m.drive = (1.0 - r1) * std::sin(n * pi * cfg.driver_position)
+               / std::sin(pi * cfg.driver_position);
+            m.pickup = std::sin(n * pi * cfg.pickup_position)
+               / std::sin(pi * cfg.pickup_position);
+            _modes.push_back(m);
+         }
+      }
+
+      // Pluck the string (see plucked_string)
+      void pluck(double level, double pick_position)
+      {
+         constexpr double pi = 3.14159265358979323846;
+         for (std::size_t i = 0; i != _modes.size(); ++i)
+         {
+            auto n = double(i + 1);
+            auto& m = _modes[i];
+            m.z_re = 0.0;
+            m.z_im = -level * std::sin(n * pi * pick_position)
+               / (n * n * std::sin(pi * pick_position));
+         }
+      }
+
+      double operator()(double force)
+      {
+         double s = 0.0;
+         for (auto& m : _modes)
+         {
+            auto re = m.a_re * m.z_re - m.a_im * m.z_im + m.drive * force;
+            auto im = m.a_im * m.z_re + m.a_re * m.z_im;
+            m.z_re = re;
+            m.z_im = im;
+            s += m.pickup * re;
+         }
+         return s;
+      }
+
+      double f0() const { return _f0; }
+
+   private:
+
+      struct mode
+      {
+         double   a_re, a_im;    // r * exp(j * w)
+         double   drive;         // Force coupling
+         double   pickup;        // Pickup coupling
+         double   z_re = 0.0;
+         double   z_im = 0.0;
+      };
+
+      double               _f0;
+      std::vector<mode>    _modes;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Background noise and mains hum (fundamental plus 3rd harmonic)
+   ////////////////////////////////////////////////////////////////////////////
+   struct noise_hum
+   {
+      double   noise_level = 0.0;   // White noise standard deviation
+      double   hum_level = 0.0;     // Hum fundamental level
+      double   hum_freq = 50.0;     // 50 or 60 Hz
+   };
+}}}
+
+#endif
@@ -0,0 +1,98 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_HOST_TELEMETRY_HPP_NOVEMBER_29_2017)
+#define CYCFI_INFINITY_HOST_TELEMETRY_HPP_NOVEMBER_29_2017
+
+#include <inf/telemetry.hpp>
+#include <vector>
+
+namespace cycfi { namespace infinity { namespace host
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // Telemetry stream decoder (see telemetry.hpp).
+   //
+   // feed takes the bytes as they arrive, in chunks of any size, and calls
+   // the handler for each valid frame:
+   //
+   //    handler(telemetry_frame type, std::uint8_t seq,
+   //       std::uint8_t const* payload, std::size_t len)
+   //
+   // Bytes that are not part of a valid frame (e.g. when the receiver
+   // starts in the middle of a frame, or after a corrupted frame) are
+   // skipped until the next sync bytes with a good crc. Frames lost on the
+   // link are detected by the gaps in the seq numbers. (Frames dropped by
+   // the sender's telemetry_stream do not use up a seq; the sender counts
+   // them, see telemetry_system::dropped.)
+   ////////////////////////////////////////////////////////////////////////////
+   class telemetry_decoder
+   {
+   public:
+
+      template <typename F>
+      void feed(std::uint8_t const* data, std::size_t len, F&& handler)
+      {
+         _buf.insert(_buf.end(), data, data + len);
+
+         std::size_t i = 0;
+         while (i + telemetry_header_size <= _buf.size())
+         {
+            if (_buf[i] != telemetry_sync[0] || _buf[i+1] != telemetry_sync[1])
+            {
+               ++i;
+               ++_skipped;
+               continue;
+            }
+
+            std::size_t payload_len = _buf[i+4];
+            std::size_t total = telemetry_overhead + payload_len;
+            if (i + total > _buf.size())
+               break;   // Wait for the rest of the frame
+
+            auto p = _buf.data() + i;
+            auto crc = telemetry_crc(0xFFFF, p + 2, total - 4);
+            if ((p[total-2] | (p[total-1] << 8)) != crc)
+            {
+               // Not a frame, or a corrupted one. Resync past the sync
+               // bytes.
+               ++_crc_errors;
+               ++i;
+               ++_skipped;
+               continue;
+            }
+
+            std::uint8_t seq = p[3];
+            if (_frames != 0)
+               _lost += std::uint8_t(seq - _seq - 1);
+            _seq = seq;
+            ++_frames;
+
+            handler(
+               telemetry_frame(p[2]), seq,
+               p + telemetry_header_size, payload_len);
+            i += total;
+         }
+
+         // Keep the rest (a partial frame) for the next feed
+         _buf.erase(_buf.begin(), _buf.begin() + i);
+      }
+
+      std::size_t frames() const { return _frames; }        // Valid frames
+      std::size_t crc_errors() const { return _crc_errors; }
+      std::size_t lost() const { return _lost; }            // From seq gaps
+      std::size_t skipped() const { return _skipped; }      // Bytes skipped
+
+   private:
+
+      std::vector<std::uint8_t>  _buf;
+      std::uint8_t               _seq = 0;
+      std::size_t                _frames = 0;
+      std::size_t                _crc_errors = 0;
+      std::size_t                _lost = 0;
+      std::size_t                _skipped = 0;
+   };
+}}}
+
+#endif
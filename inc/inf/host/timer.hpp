@@ -0,0 +1,114 @@
+/*=============================================================================
+   Copyright (c) 2015-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_HOST_TIMER_HPP_NOVEMBER_24_2017)
+#define CYCFI_INFINITY_HOST_TIMER_HPP_NOVEMBER_24_2017
+
+#include <inf/host/simulator.hpp>
+#include <inf/pin.hpp>
+#include <inf/support.hpp>
+#include <inf/config.hpp>
+
+///////////////////////////////////////////////////////////////////////////////
+// Host implementation of inf/timer.hpp. The update rate is computed with
+// the same prescaler and auto-reload rounding as the STM32F4 timers.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace cycfi { namespace infinity
+{
+   namespace detail
+   {
+      constexpr bool check_valid_timer(std::size_t id)
+      {
+         return (id >= 1 && id <= 14);
+      }
+
+      constexpr bool timer_has_irq(std::size_t id)
+      {
+         return (id >= 2 && id <= 5) || id == 7;
+      }
+
+      // The APB1 timers are clocked at half the core clock
+      constexpr std::size_t timer_clock_div(std::size_t id)
+      {
+         return (id == 1 || (id >= 8 && id <= 11))? 1 : 2;
+      }
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // timer
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t id_>
+   struct timer
+   {
+      using self_type = timer<id_>;
+      static constexpr std::size_t id = id_;
+      static_assert(detail::check_valid_timer(id), "Invalid Timer id");
+
+      timer() = default;
+      timer(timer const&) = delete;
+      timer& operator=(timer const&) = delete;
+
+      void init(uint32_t clock_frequency, uint32_t frequency)
+      {
+         detail::system_clock_config();
+
+         constexpr auto div = detail::timer_clock_div(id);
+         std::uint64_t timer_clock = host::core_clock / div;
+         std::uint64_t psc = (timer_clock >= clock_frequency)?
+            (timer_clock / clock_frequency) - 1 : 0;
+         std::uint64_t arr = (timer_clock / (psc + 1)) / frequency;
+         if (arr > 0)
+            --arr;
+
+         host::simulator::instance().timer_init(id, div * (psc + 1) * (arr + 1));
+      }
+
+      void enable_interrupt(std::size_t /*priority*/ = 0)
+      {
+         static_assert(detail::timer_has_irq(id),
+            "Timer has no interrupt capability.");
+
+         host::simulator::instance().timer_enable_interrupt(id);
+      }
+
+      void start()
+      {
+         host::simulator::instance().timer_start(id);
+      }
+
+      void stop()
+      {
+         host::simulator::instance().timer_stop(id);
+      }
+
+      auto setup(
+         uint32_t clock_frequency, uint32_t frequency,
+         std::size_t /*priority*/ = 0)
+      {
+         init(clock_frequency, frequency);
+         enable_interrupt();
+         return [](auto base)
+         {
+            return make_basic_config<self_type>(base);
+         };
+      }
+
+      template <typename F>
+      auto setup(
+         uint32_t clock_frequency, uint32_t frequency,
+         F task, std::size_t /*priority*/ = 0)
+      {
+         init(clock_frequency, frequency);
+         enable_interrupt();
+         return [task](auto base)
+         {
+            return make_task_config<self_type>(base, task);
+         };
+      }
+   };
+}}
+
+#endif
@@ -0,0 +1,114 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_HOST_TRACE_HPP_NOVEMBER_28_2017)
+#define CYCFI_INFINITY_HOST_TRACE_HPP_NOVEMBER_28_2017
+
+#include <inf/trace.hpp>
+#include <cstring>
+#include <vector>
+
+namespace cycfi { namespace infinity { namespace host
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // Trace dump decoder (see trace.hpp).
+   //
+   // decode_trace finds the trace ring in a memory dump (either the ring
+   // alone, as sent by trace_dump, or any memory region containing it, as
+   // read by the debugger) and returns its events, oldest first. The dump
+   // may come from a build with a different trace capacity; the capacity is
+   // read from the ring's header. Returns false if there is no trace ring
+   // in the dump.
+   ////////////////////////////////////////////////////////////////////////////
+   struct trace_entry
+   {
+      std::uint32_t  index;         // Running event number
+      std::uint32_t  sample_clock;
+      trace_event    event;
+      std::uint8_t   channel;
+      std::uint16_t  data;
+   };
+
+   struct trace_dump_info
+   {
+      std::size_t    offset = 0;    // Of the ring in the dump
+      std::uint32_t  capacity = 0;
+      std::uint32_t  count = 0;     // Total events recorded
+   };
+
+   inline std::uint32_t trace_le(std::uint8_t const* p, std::size_t bytes)
+   {
+      std::uint32_t val = 0;
+      for (std::size_t i = 0; i != bytes; ++i)
+         val |= std::uint32_t(p[i]) << (8 * i);
+      return val;
+   }
+
+   inline bool decode_trace(
+      std::uint8_t const* dump, std::size_t size
+    , std::vector<trace_entry>& events, trace_dump_info* info_ = nullptr)
+   {
+      constexpr std::size_t header_size = 16;
+      constexpr std::size_t record_size = sizeof(trace_record);
+
+      // The ring is word aligned
+      for (std::size_t offset = 0; offset + header_size <= size; offset += 4)
+      {
+         auto p = dump + offset;
+         if (std::memcmp(p, "INFT", 4) != 0
+            || trace_le(p + 4, 2) != trace_version
+            || trace_le(p + 6, 2) != record_size)
+            continue;
+
+         auto capacity = trace_le(p + 8, 4);
+         if (capacity == 0 || (capacity & (capacity - 1)) != 0
+            || (size - offset - header_size) / record_size < capacity)
+            continue;
+
+         trace_dump_info info;
+         info.offset = offset;
+         info.capacity = capacity;
+         info.count = trace_le(p + 12, 4);
+
+         auto records = p + header_size;
+         auto first = (info.count > capacity)? info.count - capacity : 0;
+         events.clear();
+         for (auto i = first; i != info.count; ++i)
+         {
+            auto r = records + (i & (capacity - 1)) * record_size;
+            events.push_back(
+               {
+                  i
+                , trace_le(r, 4)
+                , trace_event(r[6])
+                , r[7]
+                , std::uint16_t(trace_le(r + 4, 2))
+               });
+         }
+
+         if (info_)
+            *info_ = info;
+         return true;
+      }
+      return false;
+   }
+
+   inline char const* trace_event_name(trace_event event)
+   {
+      static char const* const names[] =
+      {
+         "edge", "sync", "stage", "gate_open", "gate_close", "xrun",
+         "param", "tier"
+      };
+      static_assert(
+         sizeof(names) / sizeof(names[0]) == std::size_t(trace_event::_count),
+         "missing trace_event name");
+
+      auto i = std::size_t(event);
+      return (i < std::size_t(trace_event::_count))? names[i] : "unknown";
+   }
+}}}
+
+#endif
@@ -0,0 +1,91 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_HOST_UART_HPP_NOVEMBER_29_2017)
+#define CYCFI_INFINITY_HOST_UART_HPP_NOVEMBER_29_2017
+
+#include <inf/host/simulator.hpp>
+#include <inf/pin.hpp>
+#include <inf/config.hpp>
+#include <cstdint>
+
+///////////////////////////////////////////////////////////////////////////////
+// Host implementation of inf/uart.hpp. The data goes to the simulator's
+// UART output (see the --uart option) and the transfer takes the same
+// (simulated) time as on the real link: 10 bits per byte (8N1) at the
+// baud rate. The transfer complete interrupt is dispatched at the end.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace cycfi { namespace infinity
+{
+   namespace detail
+   {
+      // See detail/uart_impl.hpp
+      constexpr int host_uart_id(std::size_t pin)
+      {
+         return
+            (pin == port::porta + 2 || pin == port::portd + 5)? 2 :
+            (pin == port::porta + 9 || pin == port::portb + 6)? 1 :
+            (pin == port::portb + 10 || pin == port::portc + 10
+               || pin == port::portd + 8)? 3 :
+            (pin == port::portc + 6 || pin == port::portg + 14)? 6 :
+            -1;
+      }
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // uart_tx
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t tx_pin_, std::uint32_t baud_rate_ = 115200>
+   class uart_tx
+   {
+   public:
+
+      static_assert(detail::host_uart_id(tx_pin_) != -1, "Invalid TX pin");
+
+      static constexpr std::size_t tx_pin = tx_pin_;
+      static constexpr std::size_t id = detail::host_uart_id(tx_pin);
+      static constexpr std::uint32_t baud_rate = baud_rate_;
+      using tx_peripheral_id = io_pin_id<tx_pin>;
+      using complete_id = uart_tx_complete<id>;
+
+      void init()
+      {
+      }
+
+      template <typename F>
+      auto setup(F task)
+      {
+         init();
+         return [this, task](auto base)
+         {
+            auto cfg1 = make_basic_config<tx_peripheral_id>(base);
+            return make_task_config<complete_id>(cfg1,
+               [this, task]()
+               {
+                  _busy = false;
+                  task();
+               });
+         };
+      }
+
+      bool busy() const
+      {
+         return _busy;
+      }
+
+      void send(std::uint8_t const* data, std::size_t len)
+      {
+         _busy = true;
+         host::simulator::instance().uart_write(id, data, len, baud_rate);
+      }
+
+   private:
+
+      bool volatile _busy = false;
+   };
+}}
+
+#endif
@@ -0,0 +1,228 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_HOST_WAV_HPP_NOVEMBER_27_2017)
+#define CYCFI_INFINITY_HOST_WAV_HPP_NOVEMBER_27_2017
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace cycfi { namespace infinity { namespace host
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // wav_reader: Streams interleaved samples from a WAV file, block by
+   // block, converted to float (-1.0 to 1.0). Supports 16, 24 and 32 bit
+   // PCM and 32 bit float. Throws std::runtime_error if the file cannot
+   // be opened or is not a supported WAV file.
+   ////////////////////////////////////////////////////////////////////////////
+   class wav_reader
+   {
+   public:
+
+      wav_reader(std::string const& path)
+       : _file(std::fopen(path.c_str(), "rb"))
+      {
+         if (!_file)
+            throw std::runtime_error("wav_reader: cannot open " + path);
+         if (!parse())
+         {
+            std::fclose(_file);
+            throw std::runtime_error("wav_reader: unsupported file " + path);
+         }
+      }
+
+      ~wav_reader()
+      {
+         std::fclose(_file);
+      }
+
+      wav_reader(wav_reader const&) = delete;
+      wav_reader& operator=(wav_reader const&) = delete;
+
+      std::uint32_t  channels() const { return _channels; }
+      std::uint32_t  sps() const { return _sps; }
+      std::size_t    frames() const { return _frames; }
+
+      // Read up to n frames of interleaved samples into out (n * channels
+      // floats). Returns the number of frames read (0 at the end).
+      std::size_t read(float* out, std::size_t n)
+      {
+         n = std::min(n, _frames - _pos);
+         auto bytes = _bytes * _channels;
+         _raw.resize(n * bytes);
+         n = std::fread(_raw.data(), bytes, n, _file);
+         _pos += n;
+
+         auto src = _raw.data();
+         for (std::size_t i = 0; i != n * _channels; ++i, src += _bytes)
+            out[i] = convert(src);
+         return n;
+      }
+
+   private:
+
+      static std::uint32_t le(std::uint8_t const* p, std::size_t bytes)
+      {
+         std::uint32_t val = 0;
+         for (std::size_t i = 0; i != bytes; ++i)
+            val |= std::uint32_t(p[i]) << (8 * i);
+         return val;
+      }
+
+      bool parse()
+      {
+         std::uint8_t h[12];
+         if (std::fread(h, 1, 12, _file) != 12
+            || std::memcmp(h, "RIFF", 4) != 0 || std::memcmp(h + 8, "WAVE", 4) != 0)
+            return false;
+
+         bool has_fmt = false;
+         std::uint8_t ch[8];
+         while (std::fread(ch, 1, 8, _file) == 8)
+         {
+            auto size = le(ch + 4, 4);
+            if (std::memcmp(ch, "fmt ", 4) == 0 && size >= 16)
+            {
+               std::vector<std::uint8_t> fmt(size + (size & 1));
+               if (std::fread(fmt.data(), 1, fmt.size(), _file) != fmt.size())
+                  return false;
+               auto format = le(&fmt[0], 2);
+               if (format == 0xFFFE && size >= 26)       // WAVE_FORMAT_EXTENSIBLE
+                  format = le(&fmt[24], 2);
+               _channels = le(&fmt[2], 2);
+               _sps = le(&fmt[4], 4);
+               auto bits = le(&fmt[14], 2);
+               _bytes = bits / 8;
+               _float = (format == 3);
+               if (!(format == 1 && (bits == 16 || bits == 24 || bits == 32))
+                  && !(format == 3 && bits == 32))
+                  return false;
+               has_fmt = _channels > 0;
+            }
+            else if (std::memcmp(ch, "data", 4) == 0 && has_fmt)
+            {
+               _frames = size / (_bytes * _channels);
+               return true;
+            }
+            else if (std::fseek(_file, size + (size & 1), SEEK_CUR) != 0)
+            {
+               return false;
+            }
+         }
+         return false;
+      }
+
+      float convert(std::uint8_t const* p) const
+      {
+         auto val = le(p, _bytes);
+         if (_float)
+         {
+            float f;
+            std::memcpy(&f, &val, sizeof(f));
+            return f;
+         }
+         // Sign extend, then normalize
+         auto shift = 32 - 8 * _bytes;
+         auto s = std::int32_t(val << shift);
+         return s * (1.0f / 2147483648.0f);
+      }
+
+      std::FILE*                 _file;
+      std::uint32_t              _channels = 0;
+      std::uint32_t              _sps = 0;
+      std::size_t                _bytes = 0;
+      bool                       _float = false;
+      std::size_t                _frames = 0;
+      std::size_t                _pos = 0;
+      std::vector<std::uint8_t>  _raw;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // wav_writer: Streams interleaved float samples to a 32 bit float WAV
+   // file. The header sizes are updated when the writer is closed.
+   ////////////////////////////////////////////////////////////////////////////
+   class wav_writer
+   {
+   public:
+
+      wav_writer(std::string const& path, std::uint32_t channels, std::uint32_t sps)
+       : _file(std::fopen(path.c_str(), "wb"))
+       , _channels(channels)
+       , _sps(sps)
+      {
+         if (!_file)
+            throw std::runtime_error("wav_writer: cannot open " + path);
+         header();
+      }
+
+      ~wav_writer()
+      {
+         close();
+      }
+
+      wav_writer(wav_writer const&) = delete;
+      wav_writer& operator=(wav_writer const&) = delete;
+
+      // Write n frames of interleaved samples (n * channels floats)
+      void write(float const* in, std::size_t n)
+      {
+         _frames += std::fwrite(in, sizeof(float) * _channels, n, _file);
+      }
+
+      void close()
+      {
+         if (_file)
+         {
+            header();
+            std::fclose(_file);
+            _file = nullptr;
+         }
+      }
+
+   private:
+
+      static void le(std::uint8_t* p, std::uint32_t val, std::size_t bytes)
+      {
+         for (std::size_t i = 0; i != bytes; ++i)
+            p[i] = (val >> (8 * i)) & 0xFF;
+      }
+
+      void header()
+      {
+         auto data_size = std::uint32_t(_frames * _channels * sizeof(float));
+         std::uint8_t h[44];
+         std::memcpy(h, "RIFF", 4);
+         le(h + 4, 36 + data_size, 4);
+         std::memcpy(h + 8, "WAVEfmt ", 8);
+         le(h + 16, 16, 4);
+         le(h + 20, 3, 2);                               // float
+         le(h + 22, _channels, 2);
+         le(h + 24, _sps, 4);
+         le(h + 28, _sps * _channels * sizeof(float), 4);
+         le(h + 32, _channels * sizeof(float), 2);
+         le(h + 34, 32, 2);
+         std::memcpy(h + 36, "data", 4);
+         le(h + 40, data_size, 4);
+
+         auto pos = std::ftell(_file);
+         std::fseek(_file, 0, SEEK_SET);
+         std::fwrite(h, 1, sizeof(h), _file);
+         if (pos > long(sizeof(h)))
+            std::fseek(_file, pos, SEEK_SET);
+      }
+
+      std::FILE*     _file;
+      std::uint32_t  _channels;
+      std::uint32_t  _sps;
+      std::size_t    _frames = 0;
+   };
+}}}
+
+#endif
@@ -6,6 +6,10 @@
 #if !defined(CYCFI_INFINITY_I2C_HPP_AUGUST_16_2017)
 #define CYCFI_INFINITY_I2C_HPP_AUGUST_16_2017
 
+#if defined(INFINITY_HOST)
+# include <inf/host/i2c.hpp>
+#else
+
 #include <inf/detail/i2c_impl.hpp>
 #include <inf/pin.hpp>
 #include <inf/config.hpp>
@@ -15,6 +19,13 @@ namespace cycfi { namespace infinity
 {
    ////////////////////////////////////////////////////////////////////////////
    // i2c
+   //
+   // The transfers are blocking, except write_async, which starts a DMA
+   // transfer of the data and returns immediately. The data must stay
+   // valid until the transfer is complete (busy() is false), and must be
+   // in DMA accessible memory (i.e. not CCM RAM). The other transfers wait
+   // for a DMA transfer in progress to complete first. failed() tells if
+   // the last transfer failed.
    ////////////////////////////////////////////////////////////////////////////
    template <std::size_t scl_pin_, std::size_t sda_pin_>
    struct i2c_master
@@ -67,6 +78,13 @@ namespace cycfi { namespace infinity
       std::uint16_t mem_read16(
          std::uint32_t addr, std::uint16_t mem_addr, uint32_t timeout = 0xffffffff
       );
+
+      void write_async(
+         std::uint32_t addr, std::uint8_t const* data, std::size_t len
+      );
+
+      bool busy() const;
+      bool failed() const;
    };
 
    ////////////////////////////////////////////////////////////////////////////
@@ -148,6 +166,27 @@ namespace cycfi { namespace infinity
          reinterpret_cast<std::uint8_t*>(&result), 2, timeout);
       return result; 
    }
+
+   template <std::size_t scl_pin, std::size_t sda_pin>
+   inline void i2c_master<scl_pin, sda_pin>::write_async(
+      std::uint32_t addr, std::uint8_t const* data, std::size_t len
+   )
+   {
+      detail::i2c_write_async(id, addr, data, len);
+   }
+
+   template <std::size_t scl_pin, std::size_t sda_pin>
+   inline bool i2c_master<scl_pin, sda_pin>::busy() const
+   {
+      return detail::i2c_busy(id);
+   }
+
+   template <std::size_t scl_pin, std::size_t sda_pin>
+   inline bool i2c_master<scl_pin, sda_pin>::failed() const
+   {
+      return detail::i2c_failed(id);
+   }
 }}
 
+#endif // INFINITY_HOST
 #endif
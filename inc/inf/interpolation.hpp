@@ -12,10 +12,45 @@
 
 namespace cycfi { namespace infinity
 {
+   ////////////////////////////////////////////////////////////////////////////
+   // linear_interpolate: Interpolates between y1 and y2 given mu (0 to 1).
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename T>
+   constexpr T linear_interpolate(T y1, T y2, T mu)
+   {
+      return y1 + mu * (y2 - y1);
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // sample_interpolation: Fractional reads from a buffer. span is the
+   // number of samples read, from index onwards (a delay of n samples needs
+   // a buffer of n + span samples).
+   //
+   //    none           Truncates the index. Cheapest. No interpolation.
+   //    linear         2 points. Cheap, but attenuates the high frequencies
+   //                   (-3dB at a quarter of the sample rate, with a
+   //                   fraction of 0.5).
+   //    cubic_hermite  4 points (Catmull-Rom spline). Much flatter
+   //                   response.
+   //    lagrange4      4 points (3rd order Lagrange). Maximally flat at DC;
+   //                   the best for slowly varying fractional delays.
+   //    tabulated      cubic_hermite or lagrange4 with the coefficients
+   //                   looked up from a table indexed by the quantized
+   //                   fraction, instead of computed.
+   //    thiran         1st order allpass. Flat magnitude response (no high
+   //                   frequency loss), but has state: it must read exactly
+   //                   once per sample pushed, at a slowly varying delay of
+   //                   at least 0.5. For single_delay only.
+   //
+   // The 4 point interpolators read one sample ahead of the index (index -
+   // 1, except at 0 where the first sample is repeated).
+   ////////////////////////////////////////////////////////////////////////////
    namespace sample_interpolation
    {
       struct none
       {
+         static constexpr std::size_t span = 1;
+
          template <typename Storage, typename T>
          T operator()(Storage const& buffer, T index) const
          {
@@ -25,15 +60,165 @@ namespace cycfi { namespace infinity
 
       struct linear
       {
+         static constexpr std::size_t span = 2;
+
          template <typename Storage, typename T>
          T operator()(Storage const& buffer, T index) const
          {
-            auto y1 = buffer[std::size_t(index)];
-            auto y2 = buffer[std::size_t(index) + 1];
-            auto mu = index - std::floor(index);
+            // index is never negative: truncation is floor
+            auto i = std::size_t(index);
+            auto y1 = buffer[i];
+            auto y2 = buffer[i + 1];
+            auto mu = index - T(i);
             return linear_interpolate(y1, y2, mu);
          }
       };
+
+      namespace detail
+      {
+         // 4 point FIR interpolation, given the coefficients
+         template <typename Storage, typename T, typename C>
+         T fir4(Storage const& buffer, std::size_t i, C const* c)
+         {
+            auto y0 = buffer[i - (i != 0)];
+            auto y1 = buffer[i];
+            auto y2 = buffer[i + 1];
+            auto y3 = buffer[i + 2];
+            return T(c[0] * y0 + c[1] * y1 + c[2] * y2 + c[3] * y3);
+         }
+
+         // 4 point interpolation, with the coefficients computed by Kernel
+         template <typename Kernel>
+         struct interpolate4
+         {
+            static constexpr std::size_t span = 3;
+
+            template <typename Storage, typename T>
+            T operator()(Storage const& buffer, T index) const
+            {
+               auto i = std::size_t(index);
+               T c[4] = {};
+               Kernel::coefficients(index - T(i), c);
+               return fir4<Storage, T>(buffer, i, c);
+            }
+         };
+
+         struct hermite_kernel
+         {
+            template <typename T>
+            static constexpr void coefficients(T mu, T* c)
+            {
+               auto mu2 = mu * mu;
+               auto mu3 = mu2 * mu;
+               c[0] = T(0.5) * (-mu3 + 2 * mu2 - mu);
+               c[1] = T(0.5) * (3 * mu3 - 5 * mu2 + 2);
+               c[2] = T(0.5) * (-3 * mu3 + 4 * mu2 + mu);
+               c[3] = T(0.5) * (mu3 - mu2);
+            }
+         };
+
+         struct lagrange4_kernel
+         {
+            template <typename T>
+            static constexpr void coefficients(T mu, T* c)
+            {
+               // The points are at -1, 0, 1 and 2
+               auto d0 = mu + 1;
+               auto d1 = mu;
+               auto d2 = mu - 1;
+               auto d3 = mu - 2;
+               c[0] = -d1 * d2 * d3 / 6;
+               c[1] = d0 * d2 * d3 / 2;
+               c[2] = -d0 * d1 * d3 / 2;
+               c[3] = d0 * d1 * d2 / 6;
+            }
+         };
+      }
+
+      struct cubic_hermite : detail::interpolate4<detail::hermite_kernel> {};
+      struct lagrange4 : detail::interpolate4<detail::lagrange4_kernel> {};
+
+      //////////////////////////////////////////////////////////////////////////
+      // tabulated: A 4 point interpolator (cubic_hermite or lagrange4) with
+      // precomputed coefficients, for resolution fractions between samples.
+      // The fraction is rounded to the nearest 1/resolution. The table
+      // (resolution + 1 sets of 4 coefficients) is computed at compile time.
+      //////////////////////////////////////////////////////////////////////////
+      template <typename Interpolation, std::size_t resolution = 256, typename C = float>
+      struct tabulated;
+
+      template <typename Kernel, std::size_t resolution, typename C>
+      struct tabulated<detail::interpolate4<Kernel>, resolution, C>
+      {
+         static constexpr std::size_t span = 3;
+
+         struct table_type
+         {
+            C c[resolution + 1][4];
+         };
+
+         static constexpr table_type make_table()
+         {
+            table_type table = {};
+            for (std::size_t i = 0; i <= resolution; ++i)
+               Kernel::coefficients(C(i) / resolution, table.c[i]);
+            return table;
+         }
+
+         static constexpr table_type table = make_table();
+
+         template <typename Storage, typename T>
+         T operator()(Storage const& buffer, T index) const
+         {
+            auto i = std::size_t(index);
+            auto q = std::size_t((index - T(i)) * resolution + T(0.5));
+            return detail::fir4<Storage, T>(buffer, i, table.c[q]);
+         }
+      };
+
+      template <typename Kernel, std::size_t resolution, typename C>
+      constexpr typename tabulated<detail::interpolate4<Kernel>, resolution, C>::table_type
+      tabulated<detail::interpolate4<Kernel>, resolution, C>::table;
+
+      template <std::size_t resolution, typename C>
+      struct tabulated<cubic_hermite, resolution, C>
+       : tabulated<detail::interpolate4<detail::hermite_kernel>, resolution, C> {};
+
+      template <std::size_t resolution, typename C>
+      struct tabulated<lagrange4, resolution, C>
+       : tabulated<detail::interpolate4<detail::lagrange4_kernel>, resolution, C> {};
+
+      //////////////////////////////////////////////////////////////////////////
+      // thiran: 1st order Thiran allpass fractional delay. The index is split
+      // into an integer delay m and an allpass delay d (0.5 <= d < 1.5):
+      //
+      //    y[n] = a * x[n-m] + x[n-m-1] - a * y[n-1], a = (1 - d) / (1 + d)
+      //
+      // The coefficient is recomputed only when the index changes.
+      //////////////////////////////////////////////////////////////////////////
+      struct thiran
+      {
+         static constexpr std::size_t span = 2;
+
+         template <typename Storage, typename T>
+         T operator()(Storage const& buffer, T index)
+         {
+            auto m = (index < T(1.5))? 0 : std::size_t(index - T(0.5));
+            if (index != _index)
+            {
+               auto d = index - T(m);
+               _a = (1 - d) / (1 + d);
+               _index = index;
+            }
+            auto y = _a * (buffer[m] - _y) + buffer[m + 1];
+            _y = y;
+            return T(y);
+         }
+
+         float _index = -1.0f;
+         float _a = 0.0f;
+         float _y = 0.0f;
+      };
    }
 }}
 
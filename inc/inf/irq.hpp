@@ -6,6 +6,10 @@
 #if !defined(CYCFI_INFINITY_IRQ_HPP_DECEMBER_22_2015)
 #define CYCFI_INFINITY_IRQ_HPP_DECEMBER_22_2015
 
-#include <inf/detail/irq_impl.hpp>
+#if defined(INFINITY_HOST)
+# include <inf/host/irq_impl.hpp>
+#else
+# include <inf/detail/irq_impl.hpp>
+#endif
 
 #endif
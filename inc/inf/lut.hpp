@@ -9,11 +9,15 @@
 #include <inf/interpolation.hpp>
 #include <inf/buffer.hpp>
 #include <math.h>
+#include <type_traits>
 
 namespace cycfi { namespace infinity
 {
    ////////////////////////////////////////////////////////////////////////////
    // lut: a basic fractional lookup table (lut)
+   //
+   // The Interpolation may have state (see sample_interpolation::thiran).
+   // Such a lut must be read once per sample pushed, and not in blocks.
    ////////////////////////////////////////////////////////////////////////////
    template <
       typename T
@@ -32,6 +36,11 @@ namespace cycfi { namespace infinity
        : buffer(std::size_t(ceil(max_size)))
       {}
 
+      // constructor (compile-time capacity Storage only, see fixed_lut)
+      lut()
+       : buffer()
+      {}
+
       // copy and assign
       lut(lut const& rhs) = default;
       lut(lut&& rhs) = default;
@@ -53,14 +62,52 @@ namespace cycfi { namespace infinity
       // get data (index can be fractional)
       T operator[](T index) const
       {
-         interpolation_type interpolate;
          return interpolate(buffer, index);
       }
 
+      // push n fresh samples, oldest first
+      void push(T const* first, std::size_t n)
+      {
+         buffer.push(first, n);
+      }
+
+      // get n samples, oldest first, ending at index (out[n-1] is
+      // (*this)[index]). index + n must not exceed the size.
+      void read(T* out, T index, std::size_t n) const
+      {
+         read(out, index, n, interpolation_type{});
+      }
+
    private:
 
+      // Integral indices: a straight copy
+      void read(T* out, T index, std::size_t n, sample_interpolation::none) const
+      {
+         buffer.read(out, std::size_t(index), n);
+      }
+
+      template <typename Interpolate>
+      void read(T* out, T index, std::size_t n, Interpolate interpolate) const
+      {
+         static_assert(std::is_empty<Interpolate>::value,
+            "Block reads require a stateless Interpolation");
+         for (std::size_t i = 0; i != n; ++i)
+            out[i] = interpolate(buffer, index + T(n - 1 - i));
+      }
+
         storage_type buffer;
+        mutable interpolation_type interpolate;
    };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // fixed_lut: a lut with a compile-time capacity of at least N elements,
+   // stored in place (no heap).
+   ////////////////////////////////////////////////////////////////////////////
+   template <
+      typename T
+    , std::size_t N
+    , typename Interpolation = sample_interpolation::linear>
+   using fixed_lut = lut<T, fixed_buffer<T, N>, Interpolation>;
 }}
 
 #endif
@@ -0,0 +1,73 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_MAILBOX_HPP_NOVEMBER_22_2017)
+#define CYCFI_INFINITY_MAILBOX_HPP_NOVEMBER_22_2017
+
+#include <atomic>
+#include <cstdint>
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // mailbox: A wait-free, single producer, single consumer mailbox holding
+   // the latest value of T (e.g. a struct of parameters).
+   //
+   // The mailbox is double buffered. The producer writes into the back
+   // buffer, then publishes it by bumping the sequence counter. The low bit
+   // of the sequence counter tells which buffer is the front buffer. The
+   // consumer copies the front buffer only when the sequence counter has
+   // changed since its last read. No locks and no retries.
+   //
+   // The consumer must not be preempted by the producer. This is the case
+   // when the consumer is an interrupt (e.g. the DSP interrupt picking up
+   // parameter changes at block boundaries) and the producer is the main
+   // loop. Hence, the consumer never sees a partially written value.
+   //
+   // Example:
+   //
+   //    // main loop
+   //    params.write(ui.level());
+   //
+   //    // DSP interrupt, at the start of each block
+   //    float level;
+   //    if (params.read(level))
+   //       update_level(level);
+   //
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename T>
+   class mailbox
+   {
+   public:
+
+      // Producer: post a new value
+      void write(T const& val)
+      {
+         auto seq = _seq.load(std::memory_order_relaxed) + 1;
+         _data[seq & 1] = val;
+         _seq.store(seq, std::memory_order_release);
+      }
+
+      // Consumer: get the latest value, if it changed since the last read.
+      // Returns true if val was updated.
+      bool read(T& val)
+      {
+         auto seq = _seq.load(std::memory_order_acquire);
+         if (seq == _seen)
+            return false;
+         _seen = seq;
+         val = _data[seq & 1];
+         return true;
+      }
+
+   private:
+
+      T                          _data[2] = {};
+      std::atomic<std::uint32_t> _seq = { 0 };
+      std::uint32_t              _seen = 0;
+   };
+}}
+
+#endif
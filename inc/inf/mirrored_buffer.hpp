@@ -0,0 +1,118 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_MIRRORED_BUFFER_HPP_DECEMBER_1_2017)
+#define CYCFI_INFINITY_MIRRORED_BUFFER_HPP_DECEMBER_1_2017
+
+#include <inf/buffer.hpp>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // mirrored_buffer: a ring buffer (see buffer.hpp) that writes each
+   // element twice, into both halves of a 2N array, so that the latest N
+   // elements are always contiguous in memory, latest first:
+   //
+   //    auto p = b.data();   // p[0] is the latest, p[N-1] the oldest
+   //
+   // Reads (operator[] and data) need no index masking, and the latest N
+   // elements can be processed with plain pointer loops (e.g. correlation
+   // kernels and FIR filters). The price is twice the memory and a second
+   // write on each push.
+   //
+   // mirrored_buffer has the same interface as buffer (except that the
+   // elements are read-only: push is the only way to write, to keep both
+   // halves in sync), so it can be used as the Storage of lut and delay.
+   // operator[] accepts indices up to N (one past the oldest element,
+   // which wraps to the latest, as in buffer), which is what the
+   // interpolators read at the end of the buffer.
+   //
+   // The capacity N is rounded up to a power of 2. The data is stored in
+   // place (no heap).
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename T, std::size_t N>
+   class mirrored_buffer
+   {
+   public:
+
+      static constexpr std::size_t capacity = detail::smallest_pow2(N);
+
+      mirrored_buffer()
+      {
+         _data.fill(T{});
+      }
+
+      // For compatibility with buffer. The size must fit the capacity
+      // (error_handler is called).
+      explicit mirrored_buffer(std::size_t size)
+       : mirrored_buffer()
+      {
+         if (size > capacity)
+            error_handler();
+      }
+
+      mirrored_buffer(mirrored_buffer const& rhs) = default;
+      mirrored_buffer& operator=(mirrored_buffer const& rhs) = default;
+
+      // size of buffer
+      std::size_t size() const
+      {
+         return capacity;
+      }
+
+      // push the latest element, overwriting the oldest element
+      void push(T val)
+      {
+         --_pos &= mask;
+         _data[_pos] = val;
+         _data[_pos + capacity] = val;
+      }
+
+      // push n elements, oldest first (first[n-1] becomes the latest element)
+      void push(T const* first, std::size_t n)
+      {
+         if (n > capacity)
+         {
+            // Only the latest capacity elements are kept
+            first += n - capacity;
+            n = capacity;
+         }
+         for (auto last = first + n; first != last; ++first)
+            push(*first);
+      }
+
+      // read n elements, oldest first, ending at the nth latest element
+      // (out[n-1] is b[delay]). delay + n must not exceed the capacity + 1.
+      void read(T* out, std::size_t delay, std::size_t n) const
+      {
+         auto p = data() + delay;
+         std::reverse_copy(p, p + n, out);
+      }
+
+      // get the nth latest element (b[0] is latest element. b[1] is the second latest)
+      T operator[](std::size_t index) const
+      {
+         return _data[_pos + index];
+      }
+
+      // The latest capacity elements, contiguous, latest first
+      T const* data() const
+      {
+         return &_data[_pos];
+      }
+
+   private:
+
+      static constexpr std::size_t mask = capacity - 1;
+
+      std::size_t _pos = 0;
+      std::array<T, capacity * 2> _data;
+   };
+}}
+
+#endif
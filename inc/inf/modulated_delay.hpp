@@ -0,0 +1,186 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_MODULATED_DELAY_HPP_DECEMBER_2_2017)
+#define CYCFI_INFINITY_MODULATED_DELAY_HPP_DECEMBER_2_2017
+
+#include <inf/interpolation.hpp>
+#include <inf/mirrored_buffer.hpp>
+#include <algorithm>
+#include <array>
+#include <type_traits>
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // modulated_delay: a multi-tapped delay with a compile-time capacity of
+   // max_samples and num_taps taps, with smoothly changing tap delays, for
+   // e.g. chorus and doubling voices, or to align a dry signal with a
+   // processed one.
+   //
+   // A new tap delay is reached with a linear ramp over a given number of
+   // samples, instead of a jump, to avoid zipper noise. Each tap also has a
+   // gain.
+   //
+   // The delay line is a mirrored_buffer (see mirrored_buffer.hpp): the
+   // latest samples are contiguous in memory, and a block of samples is
+   // mixed one tap at a time, in one pass over the block, with no index
+   // masking. Blocks larger than max_block are processed in chunks.
+   //
+   // A tap delay of 0 is the latest sample pushed (the input, undelayed).
+   // The taps start with a delay of 0 and a gain of 1. The Interpolation
+   // must be stateless (see interpolation.hpp).
+   //
+   //    // A 2 voice chorus, up to 20ms at 20kHz
+   //    inf::modulated_delay<float, 400, 2> chorus;
+   //    chorus.gain(0, 0.5f);
+   //    chorus.gain(1, 0.5f);
+   //    ...
+   //    chorus.delay(0, 120 + lfo0 * 40, 64);  // ramp over 64 samples
+   //    chorus.delay(1, 200 + lfo1 * 40, 64);
+   //    chorus(in, out, n);
+   ////////////////////////////////////////////////////////////////////////////
+   template <
+      typename T
+    , std::size_t max_samples
+    , std::size_t num_taps
+    , std::size_t max_block = 64
+    , typename Interpolation = sample_interpolation::linear>
+   class modulated_delay
+   {
+      static_assert(std::is_empty<Interpolation>::value,
+         "modulated_delay requires a stateless Interpolation");
+
+   public:
+
+      typedef T value_type;
+      typedef Interpolation interpolation_type;
+
+      static constexpr std::size_t taps = num_taps;
+
+      // get/set the delay of a tap (in samples, up to max_samples), reached
+      // linearly in ramp_samples
+      void delay(std::size_t tap, T samples, std::size_t ramp_samples = 0)
+      {
+         auto& t = _taps[tap];
+         t.target = std::min(std::max(samples, T(0)), T(max_samples));
+         t.ramp = ramp_samples;
+         if (ramp_samples == 0)
+            t.delay = t.target;
+         else
+            t.step = (t.target - t.delay) / ramp_samples;
+      }
+
+      T delay(std::size_t tap) const { return _taps[tap].delay; }
+
+      // get/set the gain of a tap
+      void gain(std::size_t tap, T gain) { _taps[tap].gain = gain; }
+      T gain(std::size_t tap) const { return _taps[tap].gain; }
+
+      // push a new signal and return the mix of the taps
+      T operator()(T val)
+      {
+         T out;
+         (*this)(&val, &out, 1);
+         return out;
+      }
+
+      // push a block of n signals and get the block of mixes of the taps.
+      // in and out may be the same.
+      void operator()(T const* in, T* out, std::size_t n)
+      {
+         while (n)
+         {
+            auto chunk = std::min(n, max_block);
+            _buffer.push(in, chunk);
+            std::fill(out, out + chunk, T(0));
+            for (auto& tap : _taps)
+               tap_block(tap, _buffer.data(), chunk,
+                  [out](std::size_t i, T s) { out[i] += s; });
+            in += chunk;
+            out += chunk;
+            n -= chunk;
+         }
+      }
+
+      // push a block of n signals and get the block of each tap (with its
+      // gain): out[i] gets the block of tap i. in may be one of the out.
+      void operator()(T const* in, T* const* out, std::size_t n)
+      {
+         for (std::size_t pos = 0; pos < n; pos += max_block)
+         {
+            auto chunk = std::min(n - pos, max_block);
+            _buffer.push(in + pos, chunk);
+            for (std::size_t j = 0; j != num_taps; ++j)
+            {
+               auto dest = out[j] + pos;
+               tap_block(_taps[j], _buffer.data(), chunk,
+                  [dest](std::size_t i, T s) { dest[i] = s; });
+            }
+         }
+      }
+
+   private:
+
+      struct tap_state
+      {
+         T              delay = 0;
+         T              target = 0;
+         T              step = 0;
+         std::size_t    ramp = 0;
+         T              gain = 1;
+      };
+
+      // Process a block of n samples of a tap. p is the latest sample.
+      // Sample i of the block (oldest first) is n - 1 - i samples back.
+      template <typename F>
+      static void tap_block(tap_state& tap, T const* p, std::size_t n, F f)
+      {
+         interpolation_type interpolate;
+         auto const gain = tap.gain;
+         auto const step = tap.step;
+
+         // The indices are computed from i, instead of accumulated, to
+         // keep the samples independent of each other (no loop carried
+         // dependency).
+         int const last = int(n) - 1;
+
+         // Ramping: the fraction changes with each sample
+         auto const m = int(std::min(n, tap.ramp));
+         auto const start = tap.delay + T(last);
+         for (int i = 0; i != m; ++i)
+            f(i, gain * interpolate(p, start + T(i + 1) * step - T(i)));
+         if (m != 0)
+         {
+            tap.ramp -= m;
+            tap.delay = (tap.ramp == 0)? tap.target : tap.delay + T(m) * step;
+         }
+
+         // Steady: the fraction is constant, and each sample is one sample
+         // further in the (contiguous) delay line. We interpolate at the
+         // constant index 1 + fraction, from a moving pointer, so the
+         // index computations are hoisted out of the loop and the loop
+         // can be vectorized. The samples with an index below 1 (delays
+         // less than 1) use the plain index.
+         auto const index = tap.delay + T(last);
+         auto const whole = int(index);
+         auto const fraction = 1 + (index - T(whole));
+         auto const q = p + (whole - 1);
+         auto const split = std::max(m, std::min(whole, last + 1));
+         for (int i = m; i < split; ++i)
+            f(i, gain * interpolate(q - i, fraction));
+         for (int i = split; i <= last; ++i)
+            f(i, gain * interpolate(p, index - T(i)));
+      }
+
+      using storage_type =
+         mirrored_buffer<T, max_samples + max_block + Interpolation::span>;
+
+      storage_type                     _buffer;
+      std::array<tap_state, num_taps>  _taps;
+   };
+}}
+
+#endif
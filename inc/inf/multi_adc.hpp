@@ -0,0 +1,252 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_MULTI_ADC_HPP_NOVEMBER_21_2017)
+#define CYCFI_INFINITY_MULTI_ADC_HPP_NOVEMBER_21_2017
+
+#include <inf/adc.hpp>
+#include <inf/detail/multi_adc_layout.hpp>
+
+#if defined(INFINITY_HOST)
+# include <inf/host/multi_adc.hpp>
+#else
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // multi_adc: Drives ADC1 and ADC2 (dual) or ADC1, ADC2 and ADC3 (triple)
+   // in regular simultaneous mode. ADC1 is the master. All the conversions
+   // are transferred through a single DMA stream (that of ADC1).
+   //
+   // The channels are distributed among the ADCs (see multi_adc_layout.hpp).
+   // Channels 0 to num_adcs-1 are sampled simultaneously, then channels
+   // num_adcs to (2 * num_adcs) - 1, and so on. For example, for 6 strings
+   // using the triple mode, strings 0, 1 and 2 are sampled together, then
+   // strings 3, 4 and 5. The sample groups (frames) are arranged in logical
+   // channel order, the same as with the single adc, so multi_adc can be
+   // used as a drop-in replacement.
+   //
+   // Note that a channel must be routed to the ADC that converts it. For
+   // example, ADC channel 4 is PA4 on ADC1 and ADC2, but PF6 on ADC3.
+   ////////////////////////////////////////////////////////////////////////////
+   template <
+      std::size_t num_adcs_
+    , std::size_t channels_
+    , std::size_t buffer_size_ = 8
+   >
+   class multi_adc
+   {
+   public:
+
+      using layout = detail::multi_adc_layout<num_adcs_, channels_>;
+      using adc_type = multi_adc;
+      using self_type = adc_type;
+      using sample_group_type = std::array<uint16_t, channels_>;
+      using buffer_type = std::array<sample_group_type, buffer_size_> ;
+      using buffer_iterator_type = typename buffer_type::const_iterator;
+
+      static constexpr std::size_t id = 1; // The master ADC
+      static constexpr std::size_t num_adcs = num_adcs_;
+      static constexpr std::size_t channels = channels_;
+      static constexpr std::size_t buffer_size = buffer_size_;
+      static constexpr std::size_t resolution = 4096;
+
+      using half_complete_id = adc_conversion_half_complete<id>;
+      using complete_id = adc_conversion_complete<id>;
+
+      template <std::size_t tid>
+      void init(timer<tid> const&)
+      {
+         static_assert(detail::valid_adc_timer(tid), "Invalid Timer for ADC");
+
+         detail::system_clock_config();
+
+         detail::adc_dma_config(
+            get_adc<1>(),
+            detail::adc_info<1>::dma_stream,
+            detail::adc_info<1>::dma_channel,
+            detail::adc_info<1>::dma_irq_id,
+            &_data[0][0], buffer_size * channels,
+            LL_ADC_DMA_REG_REGULAR_DATA_MULTI
+         );
+
+         detail::multi_adc_config(
+            num_adcs,
+            detail::adc_timer_trigger_id<tid>(),
+            layout::ranks
+         );
+
+         // Slaves first, then the master
+         if (num_adcs == 3)
+            detail::activate_adc(get_adc<3>());
+         detail::activate_adc(get_adc<2>());
+         detail::activate_adc(get_adc<1>());
+
+         // Set timer the trigger output (TRGO)
+         LL_TIM_SetTriggerOutput(&detail::get_timer<tid>(), LL_TIM_TRGO_UPDATE);
+
+         // Clear the ADC buffer
+         clear();
+      }
+
+      template <std::size_t tid, typename F>
+      auto setup(timer<tid> const& tmr, F complete_task)
+      {
+         init(tmr);
+         return [complete_task](auto base)
+         {
+            return make_task_config<complete_id>(base, complete_task);
+         };
+      }
+
+      template <std::size_t tid, typename F1, typename F2>
+      auto setup(timer<tid> const& tmr, F1 half_complete_task, F2 complete_task)
+      {
+         init(tmr);
+         return [complete_task, half_complete_task](auto base)
+         {
+            auto cfg1 = make_task_config<complete_id>(base, complete_task);
+            return make_task_config<half_complete_id>(cfg1, half_complete_task);
+         };
+      }
+
+      template <std::size_t... channels>
+      auto enable_channels()
+      {
+         static_assert(sizeof...(channels) == channels_,
+            "Invalid number of channnels");
+
+         using iseq = std::index_sequence<channels...>;
+         enable_all_channels<0>(iseq{});
+
+         return [](auto base)
+         {
+            auto cfg1 = make_basic_config<self_type>(base);
+            return self_type::config_all_channels<0>(cfg1, iseq{});
+         };
+      }
+
+      void clear()
+      {
+         for (auto& buff : _data)
+            buff.fill(0);
+      }
+
+      void start()
+      {
+         // The slaves are triggered by the master
+         detail::start_adc(get_adc<1>());
+      }
+
+      void stop()
+      {
+         detail::stop_adc(get_adc<1>());
+      }
+
+      constexpr std::size_t size() { return buffer_size; }
+      constexpr std::size_t num_channels() { return channels; }
+
+      buffer_iterator_type begin() const { return _data.begin(); }
+      buffer_iterator_type middle() const { return _data.begin() + (buffer_size / 2); }
+      buffer_iterator_type end() const { return _data.end(); }
+
+      sample_group_type& operator[](std::size_t i) { return _data[i]; }
+      sample_group_type const& operator[](std::size_t i) const { return _data[i]; }
+
+   private:
+
+      template <std::size_t i, typename T>
+      static auto config_all_channels(T base, std::index_sequence<>)
+      {
+         // end recursion
+         return base;
+      }
+
+      template <std::size_t i, typename T, std::size_t channel, std::size_t... rest>
+      static auto config_all_channels(T base, std::index_sequence<channel, rest...>)
+      {
+         static constexpr std::size_t pin =
+            detail::get_adc_pin<channel>(layout::adc(i));
+         auto cfg = make_basic_config<io_pin_id<pin>>(base);
+         return config_all_channels<i + 1>(cfg, std::index_sequence<rest...>{});
+      }
+
+      template <std::size_t channel, std::size_t adc_id, std::size_t rank>
+      static void enable_one_channel()
+      {
+         static_assert(detail::valid_adc_channel(channel), "Invalid ADC Channel");
+
+         static constexpr std::size_t pin = detail::get_adc_pin<channel>(adc_id);
+         static constexpr uint16_t bit = pin % 16;
+         static constexpr uint16_t port = pin / 16;
+         static constexpr uint32_t mask = 1 << bit;
+
+         auto* gpio = &detail::get_port<port>();
+
+         // Enable GPIO peripheral clock
+         detail::enable_port_clock<port>();
+
+         // Configure GPIO in analog mode to be used as ADC input
+         LL_GPIO_SetPinMode(gpio, mask, LL_GPIO_MODE_ANALOG);
+
+         // Enable the ADC channel on the selected sequence rank.
+         detail::enable_adc_channel(
+            get_adc<adc_id>(), detail::adc_channel<channel>(), detail::adc_rank<rank>());
+      }
+
+      template <std::size_t i>
+      static void enable_all_channels(std::index_sequence<>)
+      {
+         // end recursion
+      }
+
+      template <std::size_t i, std::size_t channel, std::size_t... rest>
+      static void enable_all_channels(std::index_sequence<channel, rest...>)
+      {
+         enable_one_channel<channel, layout::adc(i), layout::rank(i)>();
+         enable_all_channels<i + 1>(std::index_sequence<rest...>{});
+      }
+
+      template <std::size_t adc_id>
+      static ADC_TypeDef* get_adc()
+      {
+         return detail::adc_info<adc_id>::adc;
+      }
+
+      buffer_type _data;
+   };
+}}
+
+#endif // INFINITY_HOST
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // ADC selection by id. Use adc12 for the dual and adc123 for the triple
+   // regular simultaneous modes (see multi_processor.hpp).
+   ////////////////////////////////////////////////////////////////////////////
+   constexpr std::size_t adc12 = 12;
+   constexpr std::size_t adc123 = 123;
+
+   template <std::size_t id, std::size_t channels, std::size_t buffer_size>
+   struct select_adc
+   {
+      using type = adc<id, channels, buffer_size>;
+   };
+
+   template <std::size_t channels, std::size_t buffer_size>
+   struct select_adc<adc12, channels, buffer_size>
+   {
+      using type = multi_adc<2, channels, buffer_size>;
+   };
+
+   template <std::size_t channels, std::size_t buffer_size>
+   struct select_adc<adc123, channels, buffer_size>
+   {
+      using type = multi_adc<3, channels, buffer_size>;
+   };
+}}
+
+#endif
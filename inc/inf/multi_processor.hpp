@@ -7,12 +7,20 @@
 #define CYCFI_INFINITY_MULTI_PROCESSOR_HPP_MAY_16_2017
 
 #include <inf/adc.hpp>
+#include <inf/multi_adc.hpp>
 #include <inf/dac.hpp>
 #include <inf/dbuff.hpp>
 #include <inf/support.hpp>
 #include <inf/app.hpp>
 #include <inf/pin.hpp>
 #include <inf/processor.hpp>
+#include <inf/sample_convert.hpp>
+#include <inf/software_irq.hpp>
+#include <inf/deadline.hpp>
+#include <inf/governor.hpp>
+#include <inf/cycle_counter.hpp>
+#include <inf/profiler.hpp>
+#include <inf/trace.hpp>
 
 namespace cycfi { namespace infinity
 {
@@ -27,7 +35,10 @@ namespace cycfi { namespace infinity
    // - Base must declare some configuration constants:
    //
    //   - oversampling:    The oversampling factor
-   //   - adc_id:          The id of the ADC we want to use (see adc.hpp)
+   //   - adc_id:          The id of the ADC we want to use (see adc.hpp),
+   //                      or adc12 or adc123 to sample the channels using
+   //                      the dual or triple ADC simultaneous mode (see
+   //                      multi_adc.hpp)
    //   - timer_id:        The id of the timer we want to use (see timer.hpp)
    //   - channels:        The number of ADC channels
    //   - sampling_rate:   The ADC sampling rate
@@ -81,8 +92,99 @@ namespace cycfi { namespace infinity
    // - The irq_timer_task() member function must be called from the
    //   irq(timer_task<timer_id>) interrupt function.
    //
+   // Execution mode:
+   //
+   // - execution::immediate (the default) processes the whole block right
+   //   inside the DMA interrupt. All interrupts of lower or equal priority
+   //   (e.g. the rotary encoder EXTI) are blocked while processing.
+   //
+   // - execution::deferred only flips the buffer pointers in the DMA
+   //   interrupt and pends a software interrupt (see software_irq.hpp),
+   //   running at the lowest priority, that does the actual processing.
+   //   Processing must finish before the next half-transfer. Otherwise, it
+   //   is counted as a deadline miss (see deadline_misses()) and traced as
+   //   an xrun event (see trace.hpp).
+   //
+   // Load governor:
+   //
+   // The processing time of each block is measured against the block period
+   // using the cycle counter (see cycle_counter.hpp). The load is fed to a
+   // load_governor (see governor.hpp) that steps through degradation tiers
+   // when the load gets too high, and back with hysteresis. Base may
+   // optionally declare the number of tiers and a degrade member function
+   // that is called, from the interrupt, whenever the tier changes:
+   //
+   //       static constexpr std::size_t load_tiers = 2;
+   //
+   //       void degrade(std::size_t tier)
+   //       {
+   //          // 0: full quality, 1: no harmonics, 2: skip idle channels
+   //       }
+   //
+   // The current tier and load are available via load_tier(), load() and
+   // peak_load() (e.g. for the UI and telemetry). Tier changes are traced
+   // as tier events (see trace.hpp).
+   //
+   // Capture:
+   //
+   // Base may optionally have a capture member function that is called
+   // with the raw ADC data of each block, after processing (see
+   // capture.hpp):
+   //
+   //       template <typename Iter>
+   //       void capture(Iter src);
+   //
+   //   - src: The first sample group of the block (buffer_size / 2
+   //     sample groups of channels 12-bit samples)
+   //
    ////////////////////////////////////////////////////////////////////////////
-   template <typename Base>
+   enum class execution
+   {
+      immediate,
+      deferred
+   };
+
+   namespace detail
+   {
+      // Base::load_tiers, if present. Otherwise, 0.
+      template <typename B>
+      constexpr auto load_tiers(int) -> decltype(std::size_t(B::load_tiers))
+      {
+         return B::load_tiers;
+      }
+
+      template <typename B>
+      constexpr std::size_t load_tiers(long)
+      {
+         return 0;
+      }
+
+      // Calls base.degrade(tier), if present.
+      template <typename B>
+      auto degrade(B& base, std::size_t tier, int) -> decltype(base.degrade(tier))
+      {
+         return base.degrade(tier);
+      }
+
+      template <typename B>
+      void degrade(B&, std::size_t, long)
+      {
+      }
+
+      // Calls base.capture(src), if present.
+      template <typename B, typename I>
+      auto capture(B& base, I src, int) -> decltype(base.capture(src))
+      {
+         return base.capture(src);
+      }
+
+      template <typename B, typename I>
+      void capture(B&, I, long)
+      {
+      }
+   }
+
+   template <typename Base, execution exec = execution::immediate>
    class multi_channel_processor : public Base
    {
    public:
@@ -93,13 +195,14 @@ namespace cycfi { namespace infinity
       static constexpr auto buffer_size = Base::buffer_size;
       static constexpr auto adc_clock_rate = 2000000;
 
-      using adc_type = adc<adc_id, channels, buffer_size>;
+      using adc_type = typename select_adc<adc_id, channels, buffer_size>::type;
       using timer_type = timer<timer_id>;
 
       static constexpr auto sampling_rate = Base::sampling_rate;
       static constexpr auto resolution = adc_type::resolution;
       static constexpr auto half_resolution = resolution / 2;
       static constexpr auto oversampling = Base::oversampling;
+      static constexpr bool deferred = (exec == execution::deferred);
 
       static_assert(q::is_pow2(buffer_size),
          "buffer_size must be a power of 2, except 0"
@@ -109,9 +212,12 @@ namespace cycfi { namespace infinity
          "buffer_size must be greater than Base::oversampling"
       );
 
+      static constexpr std::size_t load_tiers = detail::load_tiers<Base>(0);
+
       multi_channel_processor()
-       : _out(_obuff.end())
+       : _out(_obuff.begin())
        , _ocount(0)
+       , _governor(load_tiers)
       {}
 
       template <std::size_t... channels>
@@ -138,21 +244,22 @@ namespace cycfi { namespace infinity
          auto cfg4 = _dac_l.setup();
          auto cfg5 = _dac_r.setup();
 
-#ifdef INFINITY_PROFILER
-         auto cfg6 = _profile_pin.setup();
-#endif
+         // Config the software interrupt (deferred execution only)
+         auto cfg6 = setup_software_irq(bool_<deferred>{});
+
          return [=](auto base)
          {
-#ifdef INFINITY_PROFILER
             return cfg1(cfg2(cfg3(cfg4(cfg5(cfg6(base))))));
-#else
-            return cfg1(cfg2(cfg3(cfg4(cfg5(base)))));
-#endif
          };
       }
 
       void start()
       {
+         // The block period in CPU cycles
+         _budget = std::uint32_t(
+            (cycles_per_second() / sampling_rate) * (buffer_size / 2));
+         enable_cycle_counter();
+
          _adc.start();
          _clock.start();
          _clock.enable_interrupt();
@@ -161,51 +268,40 @@ namespace cycfi { namespace infinity
       /////////////////////////////////////////////////////////////////////////
       // Interrupt handlers
       /////////////////////////////////////////////////////////////////////////
+      using converter = sample_convert<resolution, oversampling>;
+
       static float convert(std::uint32_t sample)
       {
-         return (sample / float(half_resolution * oversampling)) - 1.0f;
+         return converter::to_float(sample);
       }
 
       void irq_conversion_half_complete()
       {
          _out = _obuff.middle();
-
-#ifdef INFINITY_PROFILER
-         _profile_pin = 1;
-#endif
-         // process channels and place them in the output buffer
-         Base::process(
-            _obuff.begin(), _obuff.middle(), _adc.begin(),
-            [](std::uint32_t sample) { return convert(sample); }
-         );
-
-#ifdef INFINITY_PROFILER
-         _profile_pin = 0;
-#endif
+         schedule(false, bool_<deferred>{});
       }
 
       void irq_conversion_complete()
       {
          _out = _obuff.begin();
+         schedule(true, bool_<deferred>{});
+      }
 
-#ifdef INFINITY_PROFILER
-         _profile_pin = 1;
-#endif
-         // process channels and place them in the output buffer
-         Base::process(
-            _obuff.middle(), _obuff.end(), _adc.middle(),
-            [](std::uint32_t sample) { return convert(sample); }
-         );
-
-#ifdef INFINITY_PROFILER
-         _profile_pin = 0;
-#endif
+      // Called from the software interrupt (deferred execution only)
+      void irq_software_task()
+      {
+         bool const second_half = _posted_half;
+         _deadline.start();
+         process_block(second_half);
+         _deadline.finish();
       }
 
       void irq_timer_task()
       {
          if ((Base::oversampling == 1) || ((_ocount++ & (Base::oversampling-1)) == 0))
          {
+            profile_scope scope{ profile_id::output };
+
             // We generate the output signals
             _dac_l(((*_out)[0] * (half_resolution-1)) + half_resolution);
             _dac_r(((*_out)[1] * (half_resolution-1)) + half_resolution);
@@ -213,8 +309,101 @@ namespace cycfi { namespace infinity
          }
       }
 
+      // Number of blocks that were not processed before the next
+      // half-transfer (deferred execution only)
+      std::uint32_t deadline_misses() const
+      {
+         return _deadline.misses();
+      }
+
+      // The current degradation tier (0: full quality)
+      std::size_t load_tier() const
+      {
+         return _governor.tier();
+      }
+
+      // The load of the latest block (processing time / block period)
+      float load() const
+      {
+         return _governor.load();
+      }
+
+      // The highest load so far
+      float peak_load() const
+      {
+         return _governor.peak_load();
+      }
+
    private:
 
+      // Immediate execution: process the block right away
+      void schedule(bool second_half, std::false_type)
+      {
+         process_block(second_half);
+      }
+
+      // Deferred execution: let the software interrupt do the processing
+      void schedule(bool second_half, std::true_type)
+      {
+         auto misses = _deadline.misses();
+         _posted_half = second_half;
+         _deadline.post();
+         if (_deadline.misses() != misses)
+            trace(trace_event::xrun, _trace_clock, 0, std::uint16_t(misses + 1));
+         _software_irq.pend();
+      }
+
+      void process_block(bool second_half)
+      {
+         auto start_time = cycles();
+         profile_scope scope{ profile_id::block };
+
+         // process channels and place them in the output buffer
+         if (second_half)
+         {
+            Base::process(
+               _obuff.middle(), _obuff.end(), _adc.middle(),
+               [this](std::uint32_t sample) { return timed_convert(sample); }
+            );
+            detail::capture(static_cast<Base&>(*this), _adc.middle(), 0);
+         }
+         else
+         {
+            Base::process(
+               _obuff.begin(), _obuff.middle(), _adc.begin(),
+               [this](std::uint32_t sample) { return timed_convert(sample); }
+            );
+            detail::capture(static_cast<Base&>(*this), _adc.begin(), 0);
+         }
+         _convert_time.record();
+
+         // Update the load governor
+         auto tier = _governor.tier();
+         if (_governor(cycles() - start_time, _budget) != tier)
+         {
+            trace(trace_event::tier, _trace_clock, 0, std::uint16_t(_governor.tier()));
+            detail::degrade(static_cast<Base&>(*this), _governor.tier(), 0);
+         }
+         _trace_clock += block_samples;
+      }
+
+      // Converts a sample, accumulating the conversion time of the block
+      // (profiler only, recorded once per block)
+      float timed_convert(std::uint32_t sample)
+      {
+         return _convert_time([=]{ return convert(sample); });
+      }
+
+      auto setup_software_irq(std::false_type)
+      {
+         return [](auto base) { return base; };
+      }
+
+      auto setup_software_irq(std::true_type)
+      {
+         return _software_irq.setup([this]() { this->irq_software_task(); });
+      }
+
       using out_type = std::array<float, 2>;
       using obuff_type = dbuff<out_type, buffer_size / (2 * Base::oversampling)>;
       using oiter_type = typename obuff_type::iterator;
@@ -236,10 +425,22 @@ namespace cycfi { namespace infinity
       // output count (for downsampling)
       int _ocount;
 
-#ifdef INFINITY_PROFILER
-      // For profiling
-      main_test_pin_type _profile_pin;
-#endif
+      // Deferred execution. _posted_half is the half of the ADC buffer
+      // of the latest posted block, latched by the DMA interrupt.
+      software_irq _software_irq;
+      deadline_monitor _deadline;
+      bool volatile _posted_half = false;
+
+      // Load governor
+      load_governor _governor;
+      std::uint32_t _budget = 1;
+
+      // Output samples processed so far (for the trace timestamps)
+      static constexpr std::uint32_t block_samples = buffer_size / (2 * Base::oversampling);
+      std::uint32_t volatile _trace_clock = 0;
+
+      // ADC conversion time (see profiler.hpp)
+      profile_accumulator _convert_time{ profile_id::convert };
    };
 
 }}
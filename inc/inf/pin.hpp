@@ -6,6 +6,10 @@
 #if !defined(CYCFI_INFINITY_PIN_HPP_DECEMBER_20_2015)
 #define CYCFI_INFINITY_PIN_HPP_DECEMBER_20_2015
 
+#if defined(INFINITY_HOST)
+# include <inf/host/pin.hpp>
+#else
+
 #include <inf/detail/pin_impl.hpp>
 #include <inf/config.hpp>
 #include <inf/support.hpp>
@@ -352,4 +356,5 @@ namespace cycfi { namespace infinity
    };
 }}
 
+#endif // INFINITY_HOST
 #endif
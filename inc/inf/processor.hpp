@@ -6,6 +6,7 @@
 #if !defined(CYCFI_INFINITY_PROCESSOR_HPP_MAY_20_2017)
 #define CYCFI_INFINITY_PROCESSOR_HPP_MAY_20_2017
 
+#include <inf/support.hpp>
 #include <q/support.hpp>
 
 namespace cycfi { namespace infinity
@@ -37,6 +38,15 @@ namespace cycfi { namespace infinity
    //
    //    3) Stores the processed data to the output buffer
    //
+   // The base Processor class may optionally have a begin_block member
+   // function with the signature:
+   //
+   //       void begin_block();
+   //
+   // If present, begin_block is called at the start of each block, before
+   // any sample is processed. This is the place to pick up parameter
+   // changes from the main loop (see mailbox.hpp).
+   //
    // If oversampling > 1, we perform down-sampling. Samples from the ADC
    // are accumulated. The sum is divided by the oversampling factor before
    // calling base Processor process function. Thus, the base Processor
@@ -59,11 +69,25 @@ namespace cycfi { namespace infinity
       template <typename I1, typename I2, typename Convert>
       void process(I1 first, I1 last, I2 src, Convert convert)
       {
+         call_begin_block(static_cast<Base&>(*this), 0);
          process_impl(first, last, src, convert, bool_<oversampling == 1>{});
       }
 
    private:
 
+      // case Base has a begin_block member function
+      template <typename B>
+      static auto call_begin_block(B& base, int) -> decltype(base.begin_block())
+      {
+         return base.begin_block();
+      }
+
+      // case Base has no begin_block member function
+      template <typename B>
+      static void call_begin_block(B&, long)
+      {
+      }
+
       // case oversampling == 1
       template <typename I1, typename I2, typename Convert>
       void process_impl(
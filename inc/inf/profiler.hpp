@@ -0,0 +1,208 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_PROFILER_HPP_NOVEMBER_25_2017)
+#define CYCFI_INFINITY_PROFILER_HPP_NOVEMBER_25_2017
+
+#include <inf/cycle_counter.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // Profiler based on the cycle counter (see cycle_counter.hpp).
+   //
+   // Code is profiled using named scopes. The time spent in each scope is
+   // recorded in a static table of profile_stats (count, min, mean, max,
+   // and a histogram), one for each profile_id, that can be read from the
+   // main loop:
+   //
+   //    {
+   //       profile_scope scope{ profile_id::agc };
+   //       auto agc_out = _agc(s);
+   //    }
+   //
+   //    auto const& stats = profile_stats_of(profile_id::agc);
+   //
+   // or, for single expressions:
+   //
+   //    auto agc_out = profile(profile_id::agc, [&]{ return _agc(s); });
+   //
+   // Sections too short for a profile_scope each (e.g. one per sample) are
+   // timed with a profile_accumulator, which records their total time once,
+   // e.g. per block:
+   //
+   //    profile_accumulator convert_time{ profile_id::convert };
+   //    ...
+   //    auto s = convert_time([&]{ return convert(sample); });
+   //    ...
+   //    convert_time.record();  // at the end of the block
+   //
+   // The histogram bins are powers of two: bin n counts the samples taking
+   // 2^n to (2^(n+1))-1 cycles.
+   //
+   // The profiler is compiled in only if INFINITY_PROFILER is defined.
+   // Otherwise, profile_scope does nothing. The stats are updated from
+   // interrupts and read from the main loop without synchronisation, so
+   // readings may occasionally be slightly inconsistent.
+   ////////////////////////////////////////////////////////////////////////////
+   enum class profile_id : std::uint8_t
+   {
+      block,      // A whole block (see multi_processor.hpp)
+      convert,    // ADC sample conversion (per block)
+      agc,        // Automatic gain control
+      trigger,    // Period trigger
+      detector,   // Period detector
+      synth,      // Synthesizer
+      output,     // DAC output
+
+      _count
+   };
+
+   constexpr std::size_t profile_ids = std::size_t(profile_id::_count);
+
+   struct profile_stats
+   {
+      static constexpr std::size_t bins = 32;
+
+      void record(std::uint32_t elapsed)
+      {
+         if (elapsed < min)
+            min = elapsed;
+         if (elapsed > max)
+            max = elapsed;
+         total += elapsed;
+         ++count;
+         ++histogram[bin(elapsed)];
+      }
+
+      void reset()
+      {
+         *this = profile_stats{};
+      }
+
+      std::uint32_t mean() const
+      {
+         return count ? std::uint32_t(total / count) : 0;
+      }
+
+      static std::size_t bin(std::uint32_t elapsed)
+      {
+         return elapsed ? 31 - __builtin_clz(elapsed) : 0;
+      }
+
+      std::uint32_t                    count = 0;
+      std::uint32_t                    min = 0xffffffff;
+      std::uint32_t                    max = 0;
+      std::uint64_t                    total = 0;
+      std::array<std::uint32_t, bins>  histogram = {};
+   };
+
+   using profile_table_type = std::array<profile_stats, profile_ids>;
+
+   inline profile_table_type& profile_table()
+   {
+      static profile_table_type table;
+      return table;
+   }
+
+   inline profile_stats const& profile_stats_of(profile_id id)
+   {
+      return profile_table()[std::size_t(id)];
+   }
+
+   inline void profile_reset()
+   {
+      for (auto& stats : profile_table())
+         stats.reset();
+   }
+
+#if defined(INFINITY_PROFILER)
+
+   class profile_scope
+   {
+   public:
+
+      profile_scope(profile_id id)
+       : _id(id)
+       , _start(cycles())
+      {}
+
+      ~profile_scope()
+      {
+         profile_table()[std::size_t(_id)].record(cycles() - _start);
+      }
+
+      profile_scope(profile_scope const&) = delete;
+      profile_scope& operator=(profile_scope const&) = delete;
+
+   private:
+
+      profile_id     _id;
+      std::uint32_t  _start;
+   };
+
+   class profile_accumulator
+   {
+   public:
+
+      profile_accumulator(profile_id id)
+       : _id(id)
+      {}
+
+      template <typename F>
+      auto operator()(F f) -> decltype(f())
+      {
+         auto start = cycles();
+         auto result = f();
+         _total += cycles() - start;
+         return result;
+      }
+
+      void record()
+      {
+         profile_table()[std::size_t(_id)].record(_total);
+         _total = 0;
+      }
+
+   private:
+
+      profile_id     _id;
+      std::uint32_t  _total = 0;
+   };
+
+#else
+
+   struct profile_scope
+   {
+      profile_scope(profile_id) {}
+   };
+
+   struct profile_accumulator
+   {
+      profile_accumulator(profile_id) {}
+
+      template <typename F>
+      auto operator()(F f) -> decltype(f())
+      {
+         return f();
+      }
+
+      void record() {}
+   };
+
+#endif
+
+   template <typename F>
+   inline auto profile(profile_id id, F f) -> decltype(f())
+   {
+      profile_scope scope{ id };
+      return f();
+   }
+}}
+
+#endif
@@ -0,0 +1,122 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_SAMPLE_CONVERT_HPP_NOVEMBER_24_2017)
+#define CYCFI_INFINITY_SAMPLE_CONVERT_HPP_NOVEMBER_24_2017
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // sample_convert: Converts raw (unsigned) ADC samples of a given
+   // resolution to float (-1.0f...1.0f), Q15 or Q31.
+   //
+   // If oversampling > 1, the inputs are sums of oversampling samples
+   // (see processor.hpp). The conversion takes care of the division by the
+   // oversampling factor.
+   //
+   // The float conversion is a single multiply-add with constant factors,
+   // no division. resolution * oversampling must be a power of 2. The Q15
+   // and Q31 conversions are done entirely in the integer domain using
+   // shifts. The offset binary result is converted to two's complement by
+   // flipping the sign bit.
+   //
+   // The block member functions convert a whole block of ADC frames (arrays
+   // of channel samples), down-sampling by the oversampling factor. The
+   // output holds (last - first) / oversampling frames.
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t resolution, std::size_t oversampling>
+   struct sample_convert
+   {
+      static constexpr std::size_t full_scale = resolution * oversampling;
+
+      static_assert((full_scale & (full_scale - 1)) == 0,
+         "resolution * oversampling must be a power of 2"
+      );
+
+      static constexpr float scale = 2.0f / full_scale;
+
+      static constexpr std::uint32_t log2(std::size_t n)
+      {
+         return (n <= 1) ? 0 : 1 + log2(n / 2);
+      }
+
+      static constexpr std::uint32_t bits = log2(full_scale);
+
+      static_assert(bits <= 32, "resolution * oversampling is too large");
+
+      static float to_float(std::uint32_t sum)
+      {
+         return (float(sum) * scale) - 1.0f;
+      }
+
+      static std::int16_t to_q15(std::uint32_t sum)
+      {
+         auto u = std::uint16_t(rescale(sum, 16));
+         return std::int16_t(u ^ 0x8000);
+      }
+
+      static std::int32_t to_q31(std::uint32_t sum)
+      {
+         auto u = rescale(sum, 32);
+         return std::int32_t(u ^ 0x80000000);
+      }
+
+      template <typename I, typename O>
+      static void block_to_float(I first, I last, O out)
+      {
+         block(first, last, out, [](std::uint32_t sum) { return to_float(sum); });
+      }
+
+      template <typename I, typename O>
+      static void block_to_q15(I first, I last, O out)
+      {
+         block(first, last, out, [](std::uint32_t sum) { return to_q15(sum); });
+      }
+
+      template <typename I, typename O>
+      static void block_to_q31(I first, I last, O out)
+      {
+         block(first, last, out, [](std::uint32_t sum) { return to_q31(sum); });
+      }
+
+   private:
+
+      // Rescale sum to the given number of bits. The shifts are constant
+      // (bits and to_bits are known at compile time). The masks avoid
+      // compiler warnings on the branch not taken.
+      static std::uint32_t rescale(std::uint32_t sum, std::uint32_t to_bits)
+      {
+         return (bits <= to_bits)?
+            sum << ((to_bits - bits) & 31) :
+            sum >> ((bits - to_bits) & 31);
+      }
+
+      template <typename I, typename O, typename F>
+      static void block(I first, I last, O out, F f)
+      {
+         constexpr std::size_t channels = std::tuple_size<
+            typename std::iterator_traits<I>::value_type>::value;
+
+         for (; first != last; first += oversampling, ++out)
+         {
+            // Accumulate the oversampled frames
+            std::array<std::uint32_t, channels> sum = {};
+            for (std::size_t j = 0; j != oversampling; ++j)
+               for (std::size_t c = 0; c != channels; ++c)
+                  sum[c] += first[j][c];
+
+            for (std::size_t c = 0; c != channels; ++c)
+               (*out)[c] = f(sum[c]);
+         }
+      }
+   };
+}}
+
+#endif
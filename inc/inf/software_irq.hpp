@@ -0,0 +1,62 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_SOFTWARE_IRQ_HPP_NOVEMBER_20_2017)
+#define CYCFI_INFINITY_SOFTWARE_IRQ_HPP_NOVEMBER_20_2017
+
+#if defined(INFINITY_HOST)
+# include <inf/host/software_irq.hpp>
+#else
+
+#include <inf/support.hpp>
+#include <inf/config.hpp>
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // software_irq: A software triggered interrupt using the Cortex-M PendSV
+   // exception. PendSV is set to the lowest priority, so that any work
+   // scheduled through it is preempted by all the other peripheral
+   // interrupts (e.g. the DMA, timer, and EXTI interrupts).
+   //
+   // Call pend() from any context (typically from a higher priority
+   // interrupt) to schedule the task. The task runs as soon as no other
+   // interrupt of higher priority is active. Multiple calls to pend()
+   // before the task gets to run are coalesced into one.
+   ////////////////////////////////////////////////////////////////////////////
+   struct software_irq_id {};
+
+   struct software_irq
+   {
+      using self_type = software_irq;
+      using id = software_irq_id;
+
+      // The lowest possible priority
+      static constexpr std::uint32_t priority = (1 << __NVIC_PRIO_BITS) - 1;
+
+      void init()
+      {
+         NVIC_SetPriority(PendSV_IRQn, priority);
+      }
+
+      template <typename F>
+      auto setup(F task)
+      {
+         init();
+         return [task](auto base)
+         {
+            return make_task_config<id>(base, task);
+         };
+      }
+
+      static void pend()
+      {
+         SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+      }
+   };
+}}
+
+#endif // INFINITY_HOST
+#endif
@@ -8,12 +8,29 @@
 
 #include <inf/support.hpp>
 #include <inf/canvas.hpp>
+#include <algorithm>
 #include <cstdint>
 
 namespace cycfi { namespace infinity
 {
    ////////////////////////////////////////////////////////////////////////////
    // ssd1306 driver
+   //
+   // refresh sends only the dirty columns of each page (see mono_canvas),
+   // each in a column_addr/page_addr window. Consecutive pages that are
+   // dirty across the full width go in a single window. At 400kHz, the
+   // whole display (513 bytes) takes about 12ms; a page window costs 8
+   // bytes of setup plus one byte per column (about 23us per byte).
+   //
+   // refresh_async does not wait. It copies the window enclosing all the
+   // dirty columns and pages to a second (transmit) buffer and starts an
+   // asynchronous (DMA) write of it, as a single transfer, with the
+   // window setup commands in front. The canvas can be drawn on right
+   // away, while the transfer is in progress. If the previous transfer is
+   // still in progress, refresh_async does nothing and returns false: the
+   // canvas stays dirty, and the changes go with the next refresh_async.
+   // A window that failed to transfer is sent again. The Port must
+   // support write_async, busy and failed (see i2c.hpp).
    ////////////////////////////////////////////////////////////////////////////
    template <typename Port, typename Canvas, std::size_t timeout_ = 0xffffffff>
    struct ssd1306 : Canvas
@@ -31,6 +48,8 @@ namespace cycfi { namespace infinity
       ssd1306(Port& out);
 
       void refresh();
+      bool refresh_async();
+      bool busy() const { return _out.busy(); }
       void on();
       void off();
 
@@ -41,8 +60,22 @@ namespace cycfi { namespace infinity
 
       void command(std::uint8_t cmd);
       void out(std::uint8_t const* data, std::size_t len);
+      void window(std::size_t first_page, std::size_t last_page
+       , std::size_t first_col, std::size_t last_col);
+
+      struct window_type
+      {
+         std::uint8_t first_page, last_page;    // last is exclusive
+         std::uint8_t first_col, last_col;      // last is exclusive
+      };
+
+      // The window setup commands, each with its control byte, plus the
+      // data control byte
+      static std::size_t const setup_size = 13;
 
       std::uint8_t   _buffer[buffer_size];
+      std::uint8_t   _tx[setup_size + Canvas::size];
+      window_type    _sent = {};
       Port&          _out;
    };
 
@@ -167,8 +200,9 @@ namespace cycfi { namespace infinity
       command(normal_display);
       command(deactivate_scroll);
 
-      // Clear the canvas
+      // Clear the canvas (and the whole display)
       Canvas::clear();
+      Canvas::mark_dirty();
       refresh();
 
       // Turn display on
@@ -179,25 +213,123 @@ namespace cycfi { namespace infinity
    }
 
    template <typename Port, typename Canvas, std::size_t timeout>
-   inline void ssd1306<Port, Canvas, timeout>::refresh()
+   inline void ssd1306<Port, Canvas, timeout>::window(
+      std::size_t first_page, std::size_t last_page
+    , std::size_t first_col, std::size_t last_col)
    {
       using namespace ssd1306_constants;
 
-      command(column_addr);
-      command(0);                   // Column start address (0 = reset)
-      command(width-1);             // Column end address (127 = reset)
+      // Set up the window (inclusive addresses), all in one transfer
+      std::uint8_t const setup[] =
+      {
+         0,                            // Command stream
+         column_addr, std::uint8_t(first_col), std::uint8_t(last_col - 1),
+         page_addr, std::uint8_t(first_page), std::uint8_t(last_page - 1)
+      };
+      out(setup, sizeof(setup));
+
+      // Send the data, with the 0x40 (data) prefix placed temporarily in
+      // the byte just before (the prefix slot, for the first byte)
+      auto start = &_buffer[first_page * width + first_col];
+      auto len = (last_page - first_page - 1) * width + (last_col - first_col);
+      auto save = *start;
+      *start = 0x40;
+      out(start, len + 1);
+      *start = save;
+   }
+
+   template <typename Port, typename Canvas, std::size_t timeout>
+   inline void ssd1306<Port, Canvas, timeout>::refresh()
+   {
+      auto full = [this](std::size_t page)
+      {
+         auto r = Canvas::dirty(page);
+         return r.first == 0 && r.last == width;
+      };
+
+      for (std::size_t page = 0; page != Canvas::pages; )
+      {
+         auto r = Canvas::dirty(page);
+         if (full(page))
+         {
+            // Consecutive full width pages, in one window
+            auto last = page + 1;
+            while (last != Canvas::pages && full(last))
+               ++last;
+            window(page, last, 0, width);
+            page = last;
+         }
+         else
+         {
+            if (r.first != r.last)
+               window(page, page + 1, r.first, r.last);
+            ++page;
+         }
+      }
+      Canvas::mark_clean();
+   }
 
-      command(page_addr);
-      command(0);                   // Page start address (0 = reset)
+   template <typename Port, typename Canvas, std::size_t timeout>
+   inline bool ssd1306<Port, Canvas, timeout>::refresh_async()
+   {
+      using namespace ssd1306_constants;
+      if (_out.busy())
+         return false;
 
-      if (height == 64)
-          command(7);               // Page end address
-      else if (height == 32)
-          command(3);               // Page end address
-      else if (height == 16)
-          command(1);               // Page end address
+      // Send the last window again if it failed
+      if (_out.failed() && _sent.first_col != _sent.last_col)
+      {
+         Canvas::mark_dirty(
+            _sent.first_col, _sent.first_page * 8
+          , _sent.last_col - _sent.first_col
+          , (_sent.last_page - _sent.first_page) * 8
+         );
+      }
+      _sent = {};
+
+      // The window enclosing the dirty columns of all pages
+      window_type w = { std::uint8_t(Canvas::pages), 0, std::uint8_t(width), 0 };
+      for (std::size_t page = 0; page != Canvas::pages; ++page)
+      {
+         auto r = Canvas::dirty(page);
+         if (r.first != r.last)
+         {
+            w.first_page = std::min<std::size_t>(w.first_page, page);
+            w.last_page = page + 1;
+            w.first_col = std::min<std::size_t>(w.first_col, r.first);
+            w.last_col = std::max<std::size_t>(w.last_col, r.last);
+         }
+      }
+      if (w.first_page >= w.last_page)
+         return true;
+
+      // The window setup. With the Co bit (0x80) of the control byte set,
+      // a control byte follows each command byte. The data control byte
+      // (0x40) is last.
+      std::uint8_t const setup[] =
+      {
+         column_addr, w.first_col, std::uint8_t(w.last_col - 1),
+         page_addr, w.first_page, std::uint8_t(w.last_page - 1)
+      };
+      auto p = _tx;
+      for (auto cmd : setup)
+      {
+         *p++ = 0x80;
+         *p++ = cmd;
+      }
+      *p++ = 0x40;
 
-      out(_buffer, buffer_size);
+      // Copy the window (the columns of each page)
+      for (std::size_t page = w.first_page; page != w.last_page; ++page)
+      {
+         auto row = &_buffer[1 + page * width];
+         p = std::copy(row + w.first_col, row + w.last_col, p);
+      }
+
+      Canvas::mark_clean();
+      _sent = w;
+      _out.write_async(ssd1306_i2c_addr, _tx, p - _tx);
+      return true;
    }
 
    template <typename Port, typename Canvas, std::size_t timeout>
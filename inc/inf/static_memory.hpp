@@ -0,0 +1,189 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_STATIC_MEMORY_HPP_NOVEMBER_30_2017)
+#define CYCFI_INFINITY_STATIC_MEMORY_HPP_NOVEMBER_30_2017
+
+#include <inf/support.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // static_arena: A fixed block of static memory for objects sized at run
+   // time (e.g. a delay sized from a sample rate). Allocation bumps a
+   // pointer; nothing is ever freed. Allocate at startup, before the
+   // interrupts are started. Running out of arena memory is a fatal error
+   // (error_handler is called).
+   //
+   // Each arena is a distinct type, and its memory is reserved statically,
+   // counted by the linker (and by ram_budget, see below) like any other
+   // static object:
+   //
+   //    struct my_arena_tag;
+   //    using my_arena = inf::static_arena<8192, my_arena_tag>;
+   //
+   //    inf::arena_buffer<float, my_arena> b(1000);  // see buffer.hpp
+   //
+   // - capacity_:     The arena size in bytes
+   // - Tag:           Makes each arena distinct
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t capacity_, typename Tag = void>
+   class static_arena
+   {
+   public:
+
+      static constexpr std::size_t capacity = capacity_;
+
+      static void* allocate(std::size_t bytes, std::size_t align)
+      {
+         auto pos = (_used + align - 1) & ~(align - 1);
+         if (pos + bytes > capacity)
+         {
+            error_handler();
+            return nullptr;
+         }
+         _used = pos + bytes;
+         return &_data[pos];
+      }
+
+      static std::size_t used()
+      {
+         return _used;
+      }
+
+      static std::size_t remaining()
+      {
+         return capacity - _used;
+      }
+
+   private:
+
+      alignas(std::max_align_t) static std::uint8_t _data[capacity_];
+      static std::size_t _used;
+   };
+
+   template <std::size_t capacity_, typename Tag>
+   alignas(std::max_align_t) std::uint8_t static_arena<capacity_, Tag>::_data[capacity_];
+
+   template <std::size_t capacity_, typename Tag>
+   std::size_t static_arena<capacity_, Tag>::_used = 0;
+
+   ////////////////////////////////////////////////////////////////////////////
+   // arena_storage: A Storage for buffer (see buffer.hpp) allocated from
+   // a static_arena. Not copyable (copies would share the memory), but
+   // movable.
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename T, typename Arena>
+   class arena_storage
+   {
+   public:
+
+      using value_type = T;
+
+      arena_storage() = default;
+      arena_storage(arena_storage const&) = delete;
+      arena_storage& operator=(arena_storage const&) = delete;
+
+      arena_storage(arena_storage&& rhs)
+       : _data(rhs._data), _size(rhs._size)
+      {
+         rhs._data = nullptr;
+         rhs._size = 0;
+      }
+
+      arena_storage& operator=(arena_storage&& rhs)
+      {
+         std::swap(_data, rhs._data);
+         std::swap(_size, rhs._size);
+         return *this;
+      }
+
+      // Allocate size elements. Can only be done once.
+      void allocate(std::size_t size)
+      {
+         if (_data)
+         {
+            error_handler();
+            return;
+         }
+         _data = static_cast<T*>(Arena::allocate(size * sizeof(T), alignof(T)));
+         _size = size;
+         for (std::size_t i = 0; i != size; ++i)
+            new (&_data[i]) T{};
+      }
+
+      std::size_t size() const               { return _size; }
+      T const& operator[](std::size_t i) const  { return _data[i]; }
+      T& operator[](std::size_t i)              { return _data[i]; }
+
+   private:
+
+      T*          _data = nullptr;
+      std::size_t _size = 0;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // ram_budget: Checks, at compile time, that the static objects of an
+   // app fit in a RAM budget (e.g. what's left of the SRAM after the stack
+   // and the libraries). static_arenas count for their capacity.
+   //
+   //    static_assert(
+   //       inf::ram_budget<96 * 1024, decltype(proc), my_arena>::ok
+   //     , "RAM budget exceeded");
+   //
+   // When the budget is exceeded, the compiler reports the numbers: the
+   // error names the incomplete type ram_budget_exceeded<used, budget>.
+   // ram_budget<...>::used and ::remaining are available for the reports
+   // that do fit.
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename T>
+   struct ram_usage
+   {
+      static constexpr std::size_t value = sizeof(T);
+   };
+
+   template <std::size_t capacity, typename Tag>
+   struct ram_usage<static_arena<capacity, Tag>>
+   {
+      static constexpr std::size_t value = capacity;
+   };
+
+   template <std::size_t used, std::size_t budget, bool ok = (used <= budget)>
+   struct ram_budget_exceeded
+   {
+      static constexpr bool value = true;
+   };
+
+   template <std::size_t used, std::size_t budget>
+   struct ram_budget_exceeded<used, budget, false>; // Over budget!
+
+   namespace detail
+   {
+      constexpr std::size_t sum_sizes()
+      {
+         return 0;
+      }
+
+      template <typename... Sizes>
+      constexpr std::size_t sum_sizes(std::size_t size, Sizes... sizes)
+      {
+         return size + sum_sizes(sizes...);
+      }
+   }
+
+   template <std::size_t budget, typename... T>
+   struct ram_budget
+   {
+      static constexpr std::size_t used = detail::sum_sizes(ram_usage<T>::value...);
+      static constexpr bool ok = ram_budget_exceeded<used, budget>::value;
+      static constexpr std::size_t remaining = budget - used;
+   };
+}}
+
+#endif
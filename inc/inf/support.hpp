@@ -9,9 +9,14 @@
 #include <type_traits>
 #include <cstdint>
 #include <cstring>
-#include <system_stm32f4xx.h>
-#include <stm32f4xx_ll_utils.h>
-#include <stm32f4xx_hal.h>
+
+#if defined(INFINITY_HOST)
+# include <inf/host/simulator.hpp>
+#else
+# include <system_stm32f4xx.h>
+# include <stm32f4xx_ll_utils.h>
+# include <stm32f4xx_hal.h>
+#endif
 
 namespace cycfi { namespace infinity
 {
@@ -68,14 +73,23 @@ namespace cycfi { namespace infinity
    ////////////////////////////////////////////////////////////////////////////
    // The MCU clock speed
    ////////////////////////////////////////////////////////////////////////////
+#if defined(INFINITY_HOST)
+   uint32_t const clock_speed = host::core_clock;
+#else
    uint32_t const clock_speed = SystemCoreClock;
+#endif
 
    ////////////////////////////////////////////////////////////////////////////
    // delay_ms function
 	////////////////////////////////////////////////////////////////////////////
    inline void delay_ms(uint32_t ms)
    {
+#if defined(INFINITY_HOST)
+      host::simulator::instance().advance(
+         std::uint64_t(ms) * (host::core_clock / 1000));
+#else
 	   LL_mDelay(ms);
+#endif
    }
 
    ////////////////////////////////////////////////////////////////////////////
@@ -83,7 +97,12 @@ namespace cycfi { namespace infinity
    ////////////////////////////////////////////////////////////////////////////
    inline auto millis()
    {
+#if defined(INFINITY_HOST)
+      return std::uint32_t(
+         host::simulator::instance().now() / (host::core_clock / 1000));
+#else
 	   return HAL_GetTick();
+#endif
    }
 
    ////////////////////////////////////////////////////////////////////////////
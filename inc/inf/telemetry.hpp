@@ -0,0 +1,309 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_TELEMETRY_HPP_NOVEMBER_29_2017)
+#define CYCFI_INFINITY_TELEMETRY_HPP_NOVEMBER_29_2017
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // Telemetry protocol. A stream of frames over a byte link (e.g. a UART,
+   // see uart.hpp):
+   //
+   //    sync           0xA5 0x5A
+   //    type           uint8 (telemetry_frame)
+   //    seq            uint8, incremented with each frame (to detect
+   //                   dropped or corrupted frames)
+   //    length         uint8, the payload length
+   //    payload        length bytes
+   //    crc            uint16, CRC-16/CCITT-FALSE of type, seq, length and
+   //                   the payload
+   //
+   // All values are little endian. A receiver resynchronizes by scanning
+   // for the sync bytes and checking the crc (see host/telemetry.hpp).
+   //
+   // The payloads:
+   //
+   //    string         telemetry_string: the state of one string's
+   //                   sustainer
+   //    system         telemetry_system: the CPU load and error counters
+   ////////////////////////////////////////////////////////////////////////////
+   enum class telemetry_frame : std::uint8_t
+   {
+      string = 1,
+      system = 2
+   };
+
+   constexpr std::uint8_t telemetry_sync[2] = { 0xA5, 0x5A };
+   constexpr std::size_t telemetry_header_size = 5;
+   constexpr std::size_t telemetry_crc_size = 2;
+   constexpr std::size_t telemetry_overhead = telemetry_header_size + telemetry_crc_size;
+
+   inline std::uint16_t telemetry_crc(
+      std::uint16_t crc, std::uint8_t const* data, std::size_t len)
+   {
+      while (len--)
+      {
+         crc ^= std::uint16_t(*data++) << 8;
+         for (int i = 0; i != 8; ++i)
+            crc = (crc & 0x8000)? (crc << 1) ^ 0x1021 : (crc << 1);
+      }
+      return crc;
+   }
+
+   namespace detail
+   {
+      template <typename T>
+      inline std::uint8_t* put_le(std::uint8_t* p, T val)
+      {
+         std::uint32_t bits = 0;
+         std::memcpy(&bits, &val, sizeof(T));
+         for (std::size_t i = 0; i != sizeof(T); ++i)
+            *p++ = std::uint8_t(bits >> (8 * i));
+         return p;
+      }
+
+      template <typename T>
+      inline std::uint8_t const* get_le(std::uint8_t const* p, T& val)
+      {
+         std::uint32_t bits = 0;
+         for (std::size_t i = 0; i != sizeof(T); ++i)
+            bits |= std::uint32_t(*p++) << (8 * i);
+         std::memcpy(&val, &bits, sizeof(T));
+         return p;
+      }
+
+      // 0.0 to 1.0 as 16 bit fixed point
+      inline std::uint16_t to_unorm16(float val)
+      {
+         val = std::max(std::min(val, 1.0f), 0.0f);
+         return std::uint16_t(val * 65535.0f + 0.5f);
+      }
+
+      // -0.5 to 0.5 as 16 bit fixed point
+      inline std::int16_t to_snorm16(float val)
+      {
+         val = std::max(std::min(val * 65536.0f, 32767.0f), -32768.0f);
+         return std::int16_t(val);
+      }
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // The state of one string's sustainer
+   ////////////////////////////////////////////////////////////////////////////
+   struct telemetry_string
+   {
+      static constexpr auto type = telemetry_frame::string;
+      static constexpr std::size_t size = 16;
+
+      enum { active = 1 };
+
+      std::uint32_t  sample_clock = 0;
+      std::uint8_t   channel = 0;
+      std::uint8_t   flags = 0;
+      float          period = 0;          // Detected period (samples)
+      float          phase_error = 0;     // Synth phase error (cycles, +-0.5)
+      float          envelope = 0;        // Input envelope (0.0 to 1.0)
+      float          level = 0;           // Drive level (0.0 to 1.0)
+
+      void encode(std::uint8_t* p) const
+      {
+         p = detail::put_le(p, sample_clock);
+         *p++ = channel;
+         *p++ = flags;
+         p = detail::put_le(p, period);
+         p = detail::put_le(p, detail::to_snorm16(phase_error));
+         p = detail::put_le(p, detail::to_unorm16(envelope));
+         detail::put_le(p, detail::to_unorm16(level));
+      }
+
+      void decode(std::uint8_t const* p)
+      {
+         std::int16_t phase;
+         std::uint16_t env, lvl;
+         p = detail::get_le(p, sample_clock);
+         channel = *p++;
+         flags = *p++;
+         p = detail::get_le(p, period);
+         p = detail::get_le(p, phase);
+         p = detail::get_le(p, env);
+         detail::get_le(p, lvl);
+         phase_error = phase / 65536.0f;
+         envelope = env / 65535.0f;
+         level = lvl / 65535.0f;
+      }
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // The CPU load and error counters
+   ////////////////////////////////////////////////////////////////////////////
+   struct telemetry_system
+   {
+      static constexpr auto type = telemetry_frame::system;
+      static constexpr std::size_t size = 18;
+
+      std::uint32_t  sample_clock = 0;
+      float          load = 0;            // Latest block (clamped to 1.0)
+      float          peak_load = 0;       // Highest so far (clamped to 1.0)
+      std::uint8_t   tier = 0;            // Load governor tier
+      std::uint32_t  deadline_misses = 0;
+      std::uint32_t  dropped = 0;         // Dropped telemetry frames
+
+      void encode(std::uint8_t* p) const
+      {
+         p = detail::put_le(p, sample_clock);
+         p = detail::put_le(p, detail::to_unorm16(load));
+         p = detail::put_le(p, detail::to_unorm16(peak_load));
+         *p++ = tier;
+         *p++ = 0;
+         p = detail::put_le(p, deadline_misses);
+         detail::put_le(p, dropped);
+      }
+
+      void decode(std::uint8_t const* p)
+      {
+         std::uint16_t ld, peak;
+         p = detail::get_le(p, sample_clock);
+         p = detail::get_le(p, ld);
+         p = detail::get_le(p, peak);
+         tier = *p++;
+         ++p;
+         p = detail::get_le(p, deadline_misses);
+         detail::get_le(p, dropped);
+         load = ld / 65535.0f;
+         peak_load = peak / 65535.0f;
+      }
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // telemetry_stream: Frames telemetry payloads into a ring buffer, from
+   // the DSP interrupt, and sends them out through a UART with DMA (see
+   // uart.hpp).
+   //
+   // The stream is a single producer (the DSP interrupt), single consumer
+   // (the UART) queue. push only encodes the frame into the ring buffer;
+   // it never waits. When the ring buffer is full (the link is too slow
+   // for the telemetry rate), the whole frame is dropped and counted.
+   //
+   // The consumer sends the data in place: poll starts a DMA transfer of
+   // the pending data, if the UART is idle, and sent releases it when the
+   // transfer is complete. Call poll from the main loop, and sent followed
+   // by poll from the UART's transfer complete interrupt, to keep the
+   // transfers going back to back:
+   //
+   //    auto cfg = uart.setup(
+   //       []()
+   //       {
+   //          telemetry.sent();
+   //          telemetry.poll(uart);
+   //       });
+   //
+   // The ring buffer must be in DMA accessible memory (i.e. not CCM RAM).
+   //
+   // - capacity:      The ring buffer size in bytes (a power of 2)
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t capacity = 1024>
+   class telemetry_stream
+   {
+   public:
+
+      static_assert((capacity & (capacity - 1)) == 0,
+         "capacity must be a power of 2");
+
+      // Frame and queue a payload (e.g. telemetry_string). Returns false
+      // if the frame was dropped. Call from the producer (e.g. the DSP
+      // interrupt).
+      template <typename Payload>
+      bool push(Payload const& payload)
+      {
+         static_assert(Payload::size <= 255, "payload too large");
+         constexpr std::size_t total = telemetry_overhead + Payload::size;
+
+         auto head = _head.load(std::memory_order_relaxed);
+         auto tail = _tail.load(std::memory_order_acquire);
+         if (capacity - (head - tail) < total)
+         {
+            ++_dropped;
+            return false;
+         }
+
+         std::uint8_t frame[total];
+         frame[0] = telemetry_sync[0];
+         frame[1] = telemetry_sync[1];
+         frame[2] = std::uint8_t(Payload::type);
+         frame[3] = _seq++;
+         frame[4] = Payload::size;
+         payload.encode(frame + telemetry_header_size);
+         auto crc = telemetry_crc(0xFFFF, frame + 2, total - 4);
+         frame[total - 2] = std::uint8_t(crc);
+         frame[total - 1] = std::uint8_t(crc >> 8);
+
+         auto i = head & mask;
+         auto n = std::min(total, capacity - i);
+         std::memcpy(&_ring[i], frame, n);
+         std::memcpy(&_ring[0], frame + n, total - n);
+
+         _head.store(head + total, std::memory_order_release);
+         return true;
+      }
+
+      // Start sending the pending data if the uart is idle. Call from the
+      // main loop and from the uart's transfer complete interrupt.
+      template <typename Uart>
+      void poll(Uart& uart)
+      {
+         if (_sending)
+            return;
+
+         auto tail = _tail.load(std::memory_order_relaxed);
+         auto head = _head.load(std::memory_order_acquire);
+         if (tail == head)
+            return;
+
+         // Send up to the end of the ring buffer. The rest goes next.
+         auto pos = tail & mask;
+         auto len = std::min<std::size_t>(head - tail, capacity - pos);
+         _sending = len;
+         uart.send(&_ring[pos], len);
+      }
+
+      // Release the data sent. Call from the uart's transfer complete
+      // interrupt.
+      void sent()
+      {
+         auto tail = _tail.load(std::memory_order_relaxed);
+         _tail.store(tail + _sending, std::memory_order_release);
+         _sending = 0;
+      }
+
+      // Number of frames dropped because the ring buffer was full
+      std::uint32_t dropped() const
+      {
+         return _dropped;
+      }
+
+   private:
+
+      static constexpr std::size_t mask = capacity - 1;
+
+      using ring_type = std::array<std::uint8_t, capacity>;
+
+      ring_type                  _ring;
+      std::atomic<std::uint32_t> _head{ 0 };
+      std::atomic<std::uint32_t> _tail{ 0 };
+      std::size_t volatile       _sending = 0;
+      std::uint32_t              _dropped = 0;
+      std::uint8_t               _seq = 0;
+   };
+}}
+
+#endif
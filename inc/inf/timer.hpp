@@ -6,6 +6,10 @@
 #if !defined(CYCFI_INFINITY_TIMER_HPP_DECEMBER_21_2015)
 #define CYCFI_INFINITY_TIMER_HPP_DECEMBER_21_2015
 
+#if defined(INFINITY_HOST)
+# include <inf/host/timer.hpp>
+#else
+
 #include <inf/pin.hpp>
 #include <inf/support.hpp>
 #include <inf/config.hpp>
@@ -118,4 +122,5 @@ namespace cycfi { namespace infinity
    };
 }}
 
+#endif // INFINITY_HOST
 #endif
@@ -0,0 +1,137 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_TRACE_HPP_NOVEMBER_28_2017)
+#define CYCFI_INFINITY_TRACE_HPP_NOVEMBER_28_2017
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // In-RAM event trace.
+   //
+   // A fixed-size ring of compact (8 byte) event records, each tagged with
+   // the sample clock and the channel. The ring always holds the latest
+   // trace_capacity events, so after something goes wrong (e.g. the pls
+   // loses lock mid-note), the events leading to it can be dumped and
+   // decoded into a timeline (see tools/trace_decode.cpp):
+   //
+   //    trace(trace_event::edge, sample_clock, channel, period);
+   //
+   // Events can be recorded from any interrupt priority and from the main
+   // loop. Each writer claims a slot with a single atomic increment
+   // (LDREX/STREX on Cortex-M, retried only if preempted by another writer
+   // in between), then fills it in with plain stores: a few cycles per
+   // event. Nothing ever blocks.
+   //
+   // The ring (trace_buffer()) is self-describing: a header with the magic
+   // "INFT", the format version, the capacity and the running event count,
+   // followed by the records. To dump it, either read the memory with the
+   // debugger (the decoder scans for the header, so dumping the whole RAM
+   // works, e.g. gdb: dump binary memory trace.bin 0x20000000 0x20020000),
+   // or send the bytes over a serial link using trace_dump. Events written
+   // while dumping may be torn. The record at index i is at slot
+   // i % trace_capacity; the oldest valid record is at
+   // max(count, trace_capacity) - trace_capacity.
+   //
+   // The trace is compiled in only if INFINITY_TRACE is defined. Otherwise,
+   // trace does nothing. The capacity (a power of 2) can be set with
+   // INFINITY_TRACE_SIZE (default: 512 events, 4KB). It must be the same
+   // in all translation units.
+   ////////////////////////////////////////////////////////////////////////////
+   enum class trace_event : std::uint8_t
+   {
+      edge,       // Period trigger edge. data: samples since the last edge
+      sync,       // Phase sync. data: target phase (upper 16 bits)
+      stage,      // pls stage change. data: new stage
+      gate_open,  // Noise gate opened (note onset)
+      gate_close, // Noise gate closed
+      xrun,       // Block deadline miss. data: total misses
+      param,      // Parameter change. channel: parameter id,
+                  // data: value (0.0 to 1.0, 16 bit fixed point)
+      tier,       // Load governor tier change. data: new tier
+
+      _count
+   };
+
+   struct trace_record
+   {
+      std::uint32_t  sample_clock;
+      std::uint16_t  data;
+      std::uint8_t   event;
+      std::uint8_t   channel;
+   };
+
+   static_assert(sizeof(trace_record) == 8, "trace_record must be 8 bytes");
+
+#if defined(INFINITY_TRACE_SIZE)
+   constexpr std::size_t trace_capacity = INFINITY_TRACE_SIZE;
+#else
+   constexpr std::size_t trace_capacity = 512;
+#endif
+
+   static_assert((trace_capacity & (trace_capacity - 1)) == 0,
+      "INFINITY_TRACE_SIZE must be a power of 2");
+
+   constexpr std::uint16_t trace_version = 1;
+
+   struct trace_ring
+   {
+      char                       magic[4] = { 'I', 'N', 'F', 'T' };
+      std::uint16_t              version = trace_version;
+      std::uint16_t              record_size = sizeof(trace_record);
+      std::uint32_t              capacity = trace_capacity;
+      std::atomic<std::uint32_t> count{ 0 };
+      trace_record               records[trace_capacity] = {};
+   };
+
+   inline trace_ring& trace_buffer()
+   {
+      static trace_ring ring;
+      return ring;
+   }
+
+   // Parameter values (0.0 to 1.0) as 16 bit fixed point
+   inline std::uint16_t trace_unorm(float val)
+   {
+      val = (val < 0.0f)? 0.0f : (val > 1.0f)? 1.0f : val;
+      return std::uint16_t(val * 65535.0f + 0.5f);
+   }
+
+   // Send the trace ring through sink(data, size), as is
+   template <typename Sink>
+   inline void trace_dump(Sink&& sink)
+   {
+      auto const& ring = trace_buffer();
+      sink(reinterpret_cast<std::uint8_t const*>(&ring), sizeof(ring));
+   }
+
+#if defined(INFINITY_TRACE)
+
+   inline void trace(
+      trace_event event, std::uint32_t sample_clock
+    , std::uint8_t channel = 0, std::uint16_t data = 0)
+   {
+      auto& ring = trace_buffer();
+      auto i = ring.count.fetch_add(1, std::memory_order_relaxed);
+      auto& r = ring.records[i & (trace_capacity - 1)];
+      r.sample_clock = sample_clock;
+      r.data = data;
+      r.event = std::uint8_t(event);
+      r.channel = channel;
+   }
+
+#else
+
+   inline void trace(trace_event, std::uint32_t, std::uint8_t = 0, std::uint16_t = 0)
+   {}
+
+#endif
+}}
+
+#endif
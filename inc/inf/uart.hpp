@@ -0,0 +1,114 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_INFINITY_UART_HPP_NOVEMBER_29_2017)
+#define CYCFI_INFINITY_UART_HPP_NOVEMBER_29_2017
+
+#include <cstddef>
+
+namespace cycfi { namespace infinity
+{
+   template <std::size_t id>
+   struct uart_tx_complete {};
+}}
+
+#if defined(INFINITY_HOST)
+# include <inf/host/uart.hpp>
+#else
+
+#include <inf/detail/uart_impl.hpp>
+#include <inf/pin.hpp>
+#include <inf/config.hpp>
+#include <inf/support.hpp>
+#include <cstdint>
+
+namespace cycfi { namespace infinity
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // uart_tx: Transmit only UART with DMA.
+   //
+   // send starts a DMA transfer of the data and returns immediately. The
+   // data must stay valid, and no other send may be started, until the
+   // transfer is complete (busy() is false). The task given to setup is
+   // called from the DMA interrupt, at the lowest priority, when the
+   // transfer is complete. The frame format is 8N1, no flow control.
+   //
+   // The data must be in DMA accessible memory (i.e. not CCM RAM).
+   //
+   // Example (see also telemetry.hpp):
+   //
+   //    inf::uart_tx<port::porta + 2, 115200> uart;
+   //
+   //    auto config = inf::config(
+   //       uart.setup([]() { /* transfer complete */ })
+   //    );
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t tx_pin_, std::uint32_t baud_rate_ = 115200>
+   class uart_tx
+   {
+   public:
+
+      static_assert(detail::valid_uart_tx_pin<tx_pin_>(), "Invalid TX pin");
+
+      static constexpr std::size_t tx_pin = tx_pin_;
+      static constexpr std::size_t id = detail::uart_tx_pin<tx_pin>::uart_id;
+      static constexpr std::uint32_t baud_rate = baud_rate_;
+      using tx_peripheral_id = io_pin_id<tx_pin>;
+      using complete_id = uart_tx_complete<id>;
+      using info = detail::uart_info<id>;
+
+      void init()
+      {
+         static constexpr auto tx_port = tx_pin / 16;
+
+         detail::system_clock_config();
+
+         // Enable GPIO peripheral clock
+         detail::enable_port_clock<tx_port>();
+
+         detail::uart_config(
+            info::uart, info::apb2, info::periph_id,
+            baud_rate,
+            detail::get_port<tx_port>(), 1 << (tx_pin % 16), info::alternate,
+            info::dma, info::dma_stream, info::dma_channel,
+            info::dma_irq_id
+         );
+      }
+
+      template <typename F>
+      auto setup(F task)
+      {
+         init();
+         return [this, task](auto base)
+         {
+            auto cfg1 = make_basic_config<tx_peripheral_id>(base);
+            return make_task_config<complete_id>(cfg1,
+               [this, task]()
+               {
+                  _busy = false;
+                  task();
+               });
+         };
+      }
+
+      bool busy() const
+      {
+         return _busy;
+      }
+
+      void send(std::uint8_t const* data, std::size_t len)
+      {
+         _busy = true;
+         detail::uart_send(info::dma, info::dma_stream, data, len);
+      }
+
+   private:
+
+      bool volatile _busy = false;
+   };
+}}
+
+#endif // INFINITY_HOST
+#endif
@@ -0,0 +1,212 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/host/capture.hpp>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cycfi { namespace infinity { namespace host
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // capture_file
+   ////////////////////////////////////////////////////////////////////////////
+   capture_file::capture_file(std::string const& path)
+   {
+      auto fail = [&]()
+      {
+         if (_data)
+            ::munmap(const_cast<std::uint8_t*>(_data), _size);
+         throw std::runtime_error("capture_file: invalid capture " + path);
+      };
+
+      auto fd = ::open(path.c_str(), O_RDONLY);
+      if (fd < 0)
+         throw std::runtime_error("capture_file: cannot open " + path);
+
+      struct stat st;
+      if (::fstat(fd, &st) == 0 && st.st_size > 0)
+      {
+         _size = st.st_size;
+         auto p = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+         if (p != MAP_FAILED)
+            _data = static_cast<std::uint8_t const*>(p);
+      }
+      ::close(fd);
+
+      if (!_data)
+         throw std::runtime_error("capture_file: cannot map " + path);
+
+      // The first chunk must be the header
+      std::size_t offset = 0;
+      chunk c;
+      if (!next(offset, c) || c.type != capture_chunk::header
+         || c.size < sizeof(capture_info))
+      {
+         fail();
+      }
+
+      std::memcpy(&_info, c.data, sizeof(_info));
+      if (std::memcmp(_info.magic, "INFR", 4) != 0
+         || _info.version != capture_version || _info.channels == 0)
+      {
+         fail();
+      }
+
+      for_each(
+         [this](chunk const& ch)
+         {
+            if (ch.type == capture_chunk::frames && ch.size > sizeof(std::uint32_t))
+               _frames += (ch.size - sizeof(std::uint32_t))
+                  / (_info.channels * sizeof(std::uint16_t));
+         });
+   }
+
+   capture_file::~capture_file()
+   {
+      ::munmap(const_cast<std::uint8_t*>(_data), _size);
+   }
+
+   bool capture_file::next(std::size_t& offset, chunk& c) const
+   {
+      if (offset + sizeof(capture_chunk_header) > _size)
+         return false;
+
+      capture_chunk_header h;
+      std::memcpy(&h, _data + offset, sizeof(h));
+      auto start = offset + sizeof(h);
+      if (h.size > _size - start)
+         return false;
+
+      c.type = h.type;
+      c.data = _data + start;
+      c.size = h.size;
+      offset = start + capture_padded(h.size);
+      return true;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // replay_source
+   ////////////////////////////////////////////////////////////////////////////
+   namespace
+   {
+      param_function& the_param_handler()
+      {
+         static param_function f;
+         return f;
+      }
+
+      bool& the_replaying()
+      {
+         static bool replaying = false;
+         return replaying;
+      }
+
+      std::FILE*& the_capture_output()
+      {
+         static std::FILE* file = nullptr;
+         return file;
+      }
+   }
+
+   void param_handler(param_function f)
+   {
+      the_param_handler() = f;
+   }
+
+   bool replaying()
+   {
+      return the_replaying();
+   }
+
+   replay_source::replay_source(std::string const& path)
+    : _file(path)
+   {
+      the_replaying() = true;
+   }
+
+   void replay_source::operator()(
+      std::size_t /*adc_id*/, double /*time*/,
+      std::uint16_t* frame, std::size_t channels)
+   {
+      if (channels != _file.info().channels)
+         throw std::runtime_error("replay_source: channel count mismatch");
+
+      // Get to the next frames chunk, applying the parameter changes
+      capture_file::chunk c;
+      while (_frame == _end && _file.next(_offset, c))
+      {
+         if (c.type == capture_chunk::frames && c.size > sizeof(std::uint32_t))
+         {
+            // A gap (dropped chunks while capturing): the replay is no
+            // longer bit exact from here on
+            std::uint32_t clock;
+            std::memcpy(&clock, c.data, sizeof(clock));
+            if (clock != _clock)
+            {
+               std::fprintf(stderr,
+                  "replay_source: %d frames missing at frame %u\n",
+                  int(clock - _clock), _clock);
+            }
+
+            // The frames are 4 byte aligned, after the sample clock
+            _frame = reinterpret_cast<std::uint16_t const*>(
+               c.data + sizeof(std::uint32_t));
+            _end = _frame
+               + ((c.size - sizeof(std::uint32_t)) / (channels * 2)) * channels;
+            _clock = clock + (_end - _frame) / channels;
+         }
+         else if (c.type == capture_chunk::param && c.size >= sizeof(capture_param))
+         {
+            capture_param p;
+            std::memcpy(&p, c.data, sizeof(p));
+            if (the_param_handler())
+               the_param_handler()(p.id, p.value);
+         }
+      }
+
+      if (_frame == _end)
+      {
+         // End of the capture: silence
+         for (std::size_t i = 0; i != channels; ++i)
+            frame[i] = 2048;
+         return;
+      }
+
+      std::memcpy(frame, _frame, channels * sizeof(std::uint16_t));
+      _frame += channels;
+   }
+
+   double replay_source::seconds() const
+   {
+      return double(_file.frames()) / _file.info().sampling_rate;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Capture output
+   ////////////////////////////////////////////////////////////////////////////
+   void capture_output(std::string const& path)
+   {
+      auto& file = the_capture_output();
+      if (file)
+         std::fclose(file);
+      file = std::fopen(path.c_str(), "wb");
+      if (!file)
+         throw std::runtime_error("capture_output: cannot open " + path);
+   }
+
+   void capture_write(std::uint8_t const* data, std::size_t len)
+   {
+      if (auto file = the_capture_output())
+      {
+         std::fwrite(data, 1, len, file);
+         std::fflush(file);
+      }
+   }
+}}}
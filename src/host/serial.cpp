@@ -0,0 +1,111 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/host/serial.hpp>
+#include <cerrno>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace cycfi { namespace infinity { namespace host
+{
+   namespace
+   {
+      speed_t baud_constant(std::uint32_t baud_rate)
+      {
+         switch (baud_rate)
+         {
+            case 9600:     return B9600;
+            case 19200:    return B19200;
+            case 38400:    return B38400;
+            case 57600:    return B57600;
+            case 115200:   return B115200;
+            case 230400:   return B230400;
+            case 460800:   return B460800;
+            case 921600:   return B921600;
+            default:
+               throw std::runtime_error(
+                  "serial_port: unsupported baud rate " + std::to_string(baud_rate));
+         }
+      }
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // serial_port
+   ////////////////////////////////////////////////////////////////////////////
+   serial_port::serial_port(std::string const& path, std::uint32_t baud_rate)
+    : _fd(::open(path.c_str(), O_RDONLY | O_NOCTTY))
+   {
+      if (_fd < 0)
+         throw std::runtime_error("serial_port: cannot open " + path);
+
+      _tty = ::isatty(_fd);
+      if (_tty)
+      {
+         termios tty;
+         if (::tcgetattr(_fd, &tty) != 0)
+         {
+            ::close(_fd);
+            throw std::runtime_error("serial_port: cannot configure " + path);
+         }
+
+         ::cfmakeraw(&tty);
+         tty.c_cflag |= CLOCAL | CREAD;
+         tty.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+         tty.c_cc[VMIN] = 0;
+         tty.c_cc[VTIME] = 0;
+
+         try
+         {
+            auto speed = baud_constant(baud_rate);
+            ::cfsetispeed(&tty, speed);
+            ::cfsetospeed(&tty, speed);
+         }
+         catch (...)
+         {
+            ::close(_fd);
+            throw;
+         }
+
+         if (::tcsetattr(_fd, TCSANOW, &tty) != 0)
+         {
+            ::close(_fd);
+            throw std::runtime_error("serial_port: cannot configure " + path);
+         }
+         ::tcflush(_fd, TCIFLUSH);
+      }
+   }
+
+   serial_port::~serial_port()
+   {
+      ::close(_fd);
+   }
+
+   int serial_port::read(std::uint8_t* data, std::size_t len, int timeout_ms)
+   {
+      pollfd pfd = { _fd, POLLIN, 0 };
+      while (true)
+      {
+         auto r = ::poll(&pfd, 1, timeout_ms);
+         if (r < 0 && errno == EINTR)
+            continue;
+         if (r < 0)
+            return -1;
+         if (r == 0)
+            return 0;
+
+         auto n = ::read(_fd, data, len);
+         if (n < 0 && (errno == EINTR || errno == EAGAIN))
+            continue;
+
+         // A tty that polls readable but reads nothing is gone (hangup).
+         // A file at the end stays readable: that's the end of the file.
+         return (n <= 0)? -1 : int(n);
+      }
+   }
+}}}
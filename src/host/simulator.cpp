@@ -0,0 +1,584 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/host/simulator.hpp>
+#include <inf/host/capture.hpp>
+#include <inf/trace.hpp>
+#include <inf/support.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <cerrno>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace cycfi { namespace infinity
+{
+   namespace detail
+   {
+      // Nothing to configure on the host
+      void system_clock_config()
+      {
+      }
+   }
+
+   namespace host
+   {
+      /////////////////////////////////////////////////////////////////////////
+      // Sources and sinks
+      /////////////////////////////////////////////////////////////////////////
+      signal_source::signal_source(function f)
+       : _f(f)
+      {}
+
+      void signal_source::operator()(
+         std::size_t /*adc_id*/, double time,
+         std::uint16_t* frame, std::size_t channels)
+      {
+         for (std::size_t i = 0; i != channels; ++i)
+         {
+            auto s = std::max(-1.0f, std::min(_f(time, i), 1.0f));
+            frame[i] = std::uint16_t(std::lround((s + 1.0f) * 2047.5f));
+         }
+      }
+
+      std::unique_ptr<adc_source>
+      sine_source(std::vector<float> frequencies, float level)
+      {
+         if (frequencies.empty())
+            throw std::invalid_argument("sine_source: no frequencies");
+
+         auto f = [frequencies, level](double time, std::size_t channel)
+         {
+            auto i = std::min(channel, frequencies.size()-1);
+            constexpr double _2pi = 2.0 * 3.14159265358979323846;
+            return float(level * std::sin(_2pi * frequencies[i] * time));
+         };
+         return std::unique_ptr<adc_source>{ new signal_source(f) };
+      }
+
+      file_source::file_source(std::string const& path)
+      {
+         auto* file = std::fopen(path.c_str(), "rb");
+         if (!file)
+            throw std::runtime_error("file_source: cannot open " + path);
+
+         std::uint8_t buff[4096];
+         std::size_t n;
+         while ((n = std::fread(buff, 1, sizeof(buff), file)) > 1)
+         {
+            for (std::size_t i = 0; i+1 < n; i += 2)
+               _data.push_back(buff[i] | (buff[i+1] << 8));
+         }
+         std::fclose(file);
+
+         if (_data.empty())
+            throw std::runtime_error("file_source: empty file " + path);
+      }
+
+      void file_source::operator()(
+         std::size_t /*adc_id*/, double /*time*/,
+         std::uint16_t* frame, std::size_t channels)
+      {
+         for (std::size_t i = 0; i != channels; ++i)
+         {
+            frame[i] = _data[_pos] & 0x0fff;
+            if (++_pos == _data.size())
+               _pos = 0;
+         }
+      }
+
+      file_sink::file_sink(std::string const& path)
+       : _file(std::fopen(path.c_str(), "wb"))
+      {
+         if (!_file)
+            throw std::runtime_error("file_sink: cannot open " + path);
+      }
+
+      file_sink::~file_sink()
+      {
+         std::fclose(_file);
+      }
+
+      void file_sink::operator()(
+         double /*time*/, std::uint16_t left, std::uint16_t right)
+      {
+         std::uint8_t frame[4] =
+         {
+            std::uint8_t(left), std::uint8_t(left >> 8),
+            std::uint8_t(right), std::uint8_t(right >> 8)
+         };
+         std::fwrite(frame, 1, sizeof(frame), _file);
+      }
+
+      /////////////////////////////////////////////////////////////////////////
+      // simulator
+      /////////////////////////////////////////////////////////////////////////
+      simulator::simulator()
+       : _end(std::uint64_t(10) * core_clock)
+      {}
+
+      simulator& simulator::instance()
+      {
+         static simulator sim;
+         return sim;
+      }
+
+      void simulator::duration(double seconds)
+      {
+         _end = std::uint64_t(seconds * core_clock);
+      }
+
+      void simulator::advance(std::uint64_t cycles)
+      {
+         auto const target = _now + cycles;
+         while (true)
+         {
+            // Find the next timer update
+            std::size_t id = 0;
+            auto next = std::numeric_limits<std::uint64_t>::max();
+            for (std::size_t i = 1; i != num_timers; ++i)
+            {
+               auto const& t = _timers[i];
+               if (t.running && t.next < next)
+               {
+                  next = t.next;
+                  id = i;
+               }
+            }
+
+            // Or the next UART transfer complete
+            std::size_t uart_id = 0;
+            for (std::size_t i = 1; i != num_uarts; ++i)
+            {
+               auto const& u = _uarts[i];
+               if (u.busy && u.complete < next)
+               {
+                  next = u.complete;
+                  uart_id = i;
+               }
+            }
+
+            if ((id == 0 && uart_id == 0) || next > target)
+               break;
+            if (next >= _end)
+               finish();
+
+            _now = next;
+            if (uart_id != 0)
+            {
+               _uarts[uart_id].busy = false;
+               dispatch(_vectors.uart_tx_complete[uart_id]);
+            }
+            else
+            {
+               _timers[id].next += _timers[id].period;
+               update(id);
+            }
+         }
+
+         if (target >= _end)
+            finish();
+         _now = target;
+      }
+
+      void simulator::update(std::size_t timer_id)
+      {
+         // The timer trigger output starts the conversions of the ADCs
+         // attached to it
+         for (std::size_t i = 1; i != num_adcs; ++i)
+         {
+            if (_adcs[i].running && _adcs[i].timer_id == timer_id)
+               convert(i);
+         }
+
+         if (_timers[timer_id].interrupt)
+            dispatch(_vectors.timer[timer_id]);
+      }
+
+      void simulator::convert(std::size_t adc_id)
+      {
+         auto& adc = _adcs[adc_id];
+         auto* frame = adc.buffer + (adc.pos * adc.channels);
+
+         if (_source)
+            (*_source)(adc_id, time(), frame, adc.channels);
+         else
+            std::fill(frame, frame + adc.channels, 2048);
+
+         if (++adc.pos == adc.frames / 2)
+         {
+            dispatch(_vectors.adc_half_complete[adc_id]);
+         }
+         else if (adc.pos == adc.frames)
+         {
+            adc.pos = 0;
+            dispatch(_vectors.adc_complete[adc_id]);
+         }
+      }
+
+      void simulator::dispatch(isr_type isr)
+      {
+         if (isr)
+         {
+            ++_depth;
+            isr();
+            --_depth;
+         }
+
+         if (_depth == 0)
+         {
+            // The software interrupt has the lowest priority. It runs
+            // when no other interrupt is active.
+            while (_pend_software_irq)
+            {
+               _pend_software_irq = false;
+               if (_vectors.software_irq)
+               {
+                  ++_depth;
+                  _vectors.software_irq();
+                  --_depth;
+               }
+            }
+
+            if (_dac_written && _sink)
+               (*_sink)(time(), _dac[0], _dac[1]);
+            _dac_written = false;
+         }
+      }
+
+      void simulator::finish()
+      {
+         _now = _end;
+         _sink.reset();
+
+         if (!_trace_path.empty())
+         {
+            if (auto file = std::fopen(_trace_path.c_str(), "wb"))
+            {
+               trace_dump(
+                  [file](std::uint8_t const* data, std::size_t size)
+                  {
+                     std::fwrite(data, 1, size, file);
+                  });
+               std::fclose(file);
+            }
+            else
+            {
+               std::fprintf(stderr, "Error: can't write %s\n", _trace_path.c_str());
+            }
+         }
+         std::exit(EXIT_SUCCESS);
+      }
+
+      void simulator::timer_init(std::size_t id, std::uint64_t period)
+      {
+         _timers[id].period = std::max<std::uint64_t>(period, 1);
+      }
+
+      void simulator::timer_enable_interrupt(std::size_t id)
+      {
+         _timers[id].interrupt = true;
+      }
+
+      void simulator::timer_start(std::size_t id)
+      {
+         _timers[id].running = true;
+         _timers[id].next = _now + _timers[id].period;
+      }
+
+      void simulator::timer_stop(std::size_t id)
+      {
+         _timers[id].running = false;
+      }
+
+      void simulator::adc_init(
+         std::size_t id, std::size_t timer_id
+       , std::uint16_t* buffer
+       , std::size_t channels, std::size_t frames)
+      {
+         auto& adc = _adcs[id];
+         adc.timer_id = timer_id;
+         adc.buffer = buffer;
+         adc.channels = channels;
+         adc.frames = frames;
+         adc.pos = 0;
+      }
+
+      void simulator::adc_start(std::size_t id)
+      {
+         _adcs[id].running = true;
+      }
+
+      void simulator::adc_stop(std::size_t id)
+      {
+         _adcs[id].running = false;
+      }
+
+      void simulator::source(std::unique_ptr<adc_source> src)
+      {
+         _source = std::move(src);
+      }
+
+      void simulator::dac_write(std::size_t channel, std::uint16_t val)
+      {
+         _dac[channel] = val;
+         _dac_written = true;
+         if (_depth == 0)
+            dispatch(nullptr);
+      }
+
+      void simulator::sink(std::unique_ptr<dac_sink> snk)
+      {
+         _sink = std::move(snk);
+      }
+
+      void simulator::set_input(std::size_t pin, bool state)
+      {
+         auto port = pin / 16;
+         auto bit = pin % 16;
+         auto mask = std::uint32_t(1) << bit;
+         bool prev = (_idr[port] & mask) != 0;
+
+         if (state)
+            _idr[port] |= mask;
+         else
+            _idr[port] &= ~mask;
+
+         auto const& exti = _exti[bit];
+         if (exti.enabled && exti.port == port && prev != state
+            && state == exti.rising)
+         {
+            dispatch(_vectors.exti[bit]);
+         }
+      }
+
+      void simulator::exti_enable(std::size_t pin, bool rising)
+      {
+         auto& exti = _exti[pin % 16];
+         exti.port = pin / 16;
+         exti.enabled = true;
+         exti.rising = rising;
+      }
+
+      void simulator::exti_disable(std::size_t pin)
+      {
+         _exti[pin % 16].enabled = false;
+      }
+
+      void simulator::attach(std::uint32_t addr, i2c_device* dev)
+      {
+         _i2c_devices.emplace_back(addr, dev);
+      }
+
+      namespace
+      {
+         // Address byte plus data, 9 clocks per byte (including the ACK)
+         std::uint64_t i2c_cycles(std::size_t bytes)
+         {
+            return (std::uint64_t(bytes + 1) * 9 * core_clock)
+               / simulator::i2c_clock_speed;
+         }
+      }
+
+      void simulator::i2c_transfer(std::size_t bytes)
+      {
+         advance(i2c_cycles(bytes));
+      }
+
+      void simulator::i2c_wait()
+      {
+         if (i2c_busy())
+            advance(_i2c_complete - _now);
+      }
+
+      void simulator::i2c_deliver(
+         std::uint32_t addr
+       , std::uint8_t const* data, std::size_t len)
+      {
+         for (auto const& dev : _i2c_devices)
+         {
+            if (dev.first == addr)
+               dev.second->write(data, len);
+         }
+      }
+
+      void simulator::i2c_write(
+         std::uint32_t addr
+       , std::uint8_t const* data, std::size_t len)
+      {
+         i2c_wait();
+         i2c_deliver(addr, data, len);
+         i2c_transfer(len);
+      }
+
+      void simulator::i2c_write_async(
+         std::uint32_t addr
+       , std::uint8_t const* data, std::size_t len)
+      {
+         i2c_wait();
+         i2c_deliver(addr, data, len);
+         _i2c_complete = _now + i2c_cycles(len);
+      }
+
+      void simulator::i2c_read(
+         std::uint32_t addr
+       , std::uint8_t* data, std::size_t len)
+      {
+         i2c_wait();
+         std::memset(data, 0, len);
+         for (auto const& dev : _i2c_devices)
+         {
+            if (dev.first == addr)
+               dev.second->read(data, len);
+         }
+         i2c_transfer(len);
+      }
+
+      void simulator::pend_software_irq()
+      {
+         _pend_software_irq = true;
+         if (_depth == 0)
+            dispatch(nullptr);
+      }
+
+      void simulator::uart_write(
+         std::size_t id
+       , std::uint8_t const* data, std::size_t len
+       , std::uint32_t baud_rate)
+      {
+         // Like the real UART, a slow reader loses data rather than
+         // stalling the sender
+         if (_uart_fd >= 0)
+         {
+            auto p = data;
+            auto left = len;
+            while (left)
+            {
+               auto n = ::write(_uart_fd, p, left);
+               if (n < 0)
+               {
+                  if (errno == EINTR)
+                     continue;
+                  break;
+               }
+               p += n;
+               left -= n;
+            }
+         }
+
+         // 10 bits per byte: start, 8 data bits, stop
+         auto& u = _uarts[id];
+         auto cycles = (std::uint64_t(len) * 10 * core_clock) / baud_rate;
+         u.complete = _now + std::max<std::uint64_t>(cycles, 1);
+         u.busy = true;
+      }
+
+      void simulator::uart_output(std::string const& path)
+      {
+         if (_uart_fd >= 0)
+            ::close(_uart_fd);
+
+         _uart_fd = ::open(path.c_str(),
+            O_WRONLY | O_CREAT | O_TRUNC | O_NOCTTY | O_NONBLOCK, 0644);
+         if (_uart_fd < 0)
+            throw std::runtime_error("uart_output: cannot open " + path);
+
+         termios tty;
+         if (::isatty(_uart_fd) && ::tcgetattr(_uart_fd, &tty) == 0)
+         {
+            ::cfmakeraw(&tty);
+            ::tcsetattr(_uart_fd, TCSANOW, &tty);
+         }
+      }
+
+      /////////////////////////////////////////////////////////////////////////
+      // Command line
+      /////////////////////////////////////////////////////////////////////////
+      namespace
+      {
+         [[noreturn]] void usage(char const* name)
+         {
+            std::fprintf(stderr,
+               "Usage: %s [options]\n"
+               "   --duration <seconds>    Simulated run time (default: 10)\n"
+               "   --sine <f0,f1,...>      Feed the ADC channels with sine waves\n"
+               "   --input <file>          Feed the ADCs from a raw file\n"
+               "   --output <file>         Record the DACs to a raw file\n"
+               "   --replay <file>         Feed the ADCs from a capture file\n"
+               "   --capture <file>        Write the app's ADC capture to a file\n"
+               "   --trace <file>          Write the trace ring to a file at the end\n"
+               "   --uart <file>           Send the UART output to a file, FIFO or tty\n",
+               name
+            );
+            std::exit(EXIT_FAILURE);
+         }
+
+         std::vector<float> parse_list(std::string const& arg)
+         {
+            std::vector<float> result;
+            std::istringstream in(arg);
+            std::string item;
+            while (std::getline(in, item, ','))
+               result.push_back(std::stof(item));
+            return result;
+         }
+      }
+
+      void init(int argc, char const* argv[])
+      {
+         auto& sim = simulator::instance();
+         bool has_duration = false;
+         try
+         {
+            for (int i = 1; i < argc; ++i)
+            {
+               std::string opt = argv[i];
+               if (i+1 == argc)
+                  usage(argv[0]);
+               std::string arg = argv[++i];
+
+               if (opt == "--duration")
+               {
+                  sim.duration(std::stod(arg));
+                  has_duration = true;
+               }
+               else if (opt == "--sine")
+                  sim.source(sine_source(parse_list(arg)));
+               else if (opt == "--input")
+                  sim.source(std::unique_ptr<adc_source>{ new file_source(arg) });
+               else if (opt == "--output")
+                  sim.sink(std::unique_ptr<dac_sink>{ new file_sink(arg) });
+               else if (opt == "--replay")
+               {
+                  // Run until the end of the capture, unless told otherwise
+                  auto src = new replay_source(arg);
+                  if (!has_duration)
+                     sim.duration(src->seconds());
+                  sim.source(std::unique_ptr<adc_source>{ src });
+               }
+               else if (opt == "--capture")
+                  capture_output(arg);
+               else if (opt == "--trace")
+                  sim.trace_output(arg);
+               else if (opt == "--uart")
+                  sim.uart_output(arg);
+               else
+                  usage(argv[0]);
+            }
+         }
+         catch (std::exception const& e)
+         {
+            std::fprintf(stderr, "Error: %s\n", e.what());
+            usage(argv[0]);
+         }
+      }
+   }
+}}
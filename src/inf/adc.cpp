@@ -16,7 +16,8 @@ namespace cycfi { namespace infinity { namespace detail
       uint32_t dma_channel,
       IRQn_Type dma_channel_irq,
       uint16_t values[],
-      uint16_t size
+      uint16_t size,
+      uint32_t data_reg
    )
    {
       // Configuration of NVIC
@@ -56,7 +57,7 @@ namespace cycfi { namespace infinity { namespace detail
       LL_DMA_ConfigAddresses(
          dma,
          dma_stream,
-         LL_ADC_DMA_GetRegAddr(adc_n, LL_ADC_DMA_REG_REGULAR_DATA),
+         LL_ADC_DMA_GetRegAddr(adc_n, data_reg),
          reinterpret_cast<uint32_t>(values),
          LL_DMA_DIRECTION_PERIPH_TO_MEMORY
       );
@@ -167,4 +168,34 @@ namespace cycfi { namespace infinity { namespace detail
       // Enable interruption ADC group regular overrun
       LL_ADC_EnableIT_OVR(adc);
    }
+
+   void multi_adc_config(
+      uint32_t num_adcs,
+      uint32_t timer_trigger_id,
+      uint32_t num_channels
+   )
+   {
+      // Each ADC is configured the same way. Only the master's (ADC1)
+      // trigger source is used. The slaves are triggered by the master.
+      adc_config(ADC1, timer_trigger_id, LL_APB2_GRP1_PERIPH_ADC1, num_channels);
+      adc_config(ADC2, timer_trigger_id, LL_APB2_GRP1_PERIPH_ADC2, num_channels);
+      if (num_adcs == 3)
+         adc_config(ADC3, timer_trigger_id, LL_APB2_GRP1_PERIPH_ADC3, num_channels);
+
+      // In multi ADC mode, the data are transferred through the common
+      // data register, not through the individual ADCs' DMA requests.
+      LL_ADC_REG_SetDMATransfer(ADC1, LL_ADC_REG_DMA_TRANSFER_NONE);
+      LL_ADC_REG_SetDMATransfer(ADC2, LL_ADC_REG_DMA_TRANSFER_NONE);
+      if (num_adcs == 3)
+         LL_ADC_REG_SetDMATransfer(ADC3, LL_ADC_REG_DMA_TRANSFER_NONE);
+
+      // Set the regular simultaneous mode
+      auto common = __LL_ADC_COMMON_INSTANCE(ADC1);
+      LL_ADC_SetMultimode(common, (num_adcs == 3) ?
+         LL_ADC_MULTI_TRIPLE_REG_SIMULT : LL_ADC_MULTI_DUAL_REG_SIMULT);
+
+      // DMA mode 1: One half-word per conversion, in the order ADC1, ADC2
+      // and ADC3, with unlimited (circular) DMA requests.
+      LL_ADC_SetMultiDMATransfer(common, LL_ADC_MULTI_REG_DMA_UNLMT_1);
+   }
 }}}
@@ -31,6 +31,237 @@ namespace cycfi { namespace infinity { namespace detail
 {
    using namespace monochrome;
 
+   ////////////////////////////////////////////////////////////////////////////
+   // Packed fonts. The Dot Factory bitmaps are in the SSD1306 page major
+   // layout: a glyph is a row of bytes (8 rows of pixels, LSB on top) per
+   // page, top page first, mostly blank above and below the glyph. We
+   // pack them at compile time: only the rows from the glyph's top to its
+   // bottom pixel (its vertical box) are kept, as a bit stream, one column
+   // after the other, top row first. Only the packed fonts end up in
+   // flash. The glyphs are decoded straight into the canvas as they are
+   // drawn (see draw_glyph).
+   ////////////////////////////////////////////////////////////////////////////
+   struct packed_glyph
+   {
+      std::uint16_t  offset;     // Into the bit stream, in bits
+      std::uint8_t   width;
+      std::uint8_t   top;        // The first row of pixels
+      std::uint8_t   height;     // The rows of pixels
+   };
+
+   constexpr bool pixel(byte const* bitmap, int width, int col, int row)
+   {
+      return (bitmap[(row / 8) * width + col] >> (row % 8)) & 1;
+   }
+
+   // The vertical box of a glyph: the top and the height of its pixels
+   constexpr packed_glyph vertical_box(byte const* bitmap, int width, int pages)
+   {
+      int top = pages * 8;
+      int bottom = 0;
+      for (int col = 0; col != width; ++col)
+      {
+         for (int row = 0; row != pages * 8; ++row)
+         {
+            if (pixel(bitmap, width, col, row))
+            {
+               top = std::min(top, row);
+               bottom = std::max(bottom, row + 1);
+            }
+         }
+      }
+      packed_glyph box = {};
+      box.width = width;
+      if (bottom > top)
+      {
+         box.top = top;
+         box.height = bottom - top;
+      }
+      return box;
+   }
+
+   template <std::size_t N>
+   constexpr std::size_t packed_size(
+      byte const* bitmaps, unsigned int const (&descriptors)[N][2], int pages)
+   {
+      std::size_t bits = 0;
+      for (std::size_t i = 0; i != N; ++i)
+      {
+         auto box = vertical_box(bitmaps + descriptors[i][1], descriptors[i][0], pages);
+         bits += box.width * box.height;
+      }
+      return (bits + 7) / 8;
+   }
+
+   template <std::size_t N, std::size_t size>
+   struct packed_font
+   {
+      packed_glyph   glyphs[N];
+      byte           bits[size];
+   };
+
+   template <std::size_t size, std::size_t N>
+   constexpr packed_font<N, size> pack(
+      byte const* bitmaps, unsigned int const (&descriptors)[N][2], int pages)
+   {
+      packed_font<N, size> font = {};
+      std::size_t pos = 0;
+      for (std::size_t i = 0; i != N; ++i)
+      {
+         auto bitmap = bitmaps + descriptors[i][1];
+         auto box = vertical_box(bitmap, descriptors[i][0], pages);
+         box.offset = pos;
+         font.glyphs[i] = box;
+         for (int col = 0; col != box.width; ++col)
+         {
+            for (int row = box.top; row != box.top + box.height; ++row, ++pos)
+            {
+               if (pixel(bitmap, box.width, col, row))
+                  font.bits[pos / 8] |= 1 << (pos % 8);
+            }
+         }
+      }
+      return font;
+   }
+
+#define INFINITY_PACK_FONT(name, info, bitmaps, descriptors)                   \
+   static_assert(info.char_height <= 4, "Glyphs must be at most 32 rows");     \
+   constexpr auto name = pack<                                                 \
+         packed_size(bitmaps, descriptors, info.char_height)                   \
+      >(bitmaps, descriptors, info.char_height);                               \
+   static_assert(sizeof(name.bits) <= 0x2000, "Bit offsets must fit 16 bits"); \
+   /***/
+
+   INFINITY_PACK_FONT(small_font, smallFontInfo, smallBitmaps, smallDescriptors)
+   INFINITY_PACK_FONT(medium_font, mediumFontInfo, mediumBitmaps, mediumDescriptors)
+   INFINITY_PACK_FONT(large_font, largeFontInfo, largeBitmaps, largeDescriptors)
+
+   struct font_atlas
+   {
+      int                  pages;      // The glyph height, in pages
+      char                 first;      // The first and last characters
+      char                 last;
+      byte const*          bits;
+      packed_glyph const*  glyphs;
+
+      packed_glyph const* find(char ch) const
+      {
+         return (ch < first || ch > last)? nullptr : &glyphs[ch - first];
+      }
+   };
+
+   // By font
+   constexpr font_atlas atlases[] =
+   {
+      {
+         smallFontInfo.char_height, smallFontInfo.start_char
+       , smallFontInfo.end_char, small_font.bits, small_font.glyphs
+      },
+      {
+         mediumFontInfo.char_height, mediumFontInfo.start_char
+       , mediumFontInfo.end_char, medium_font.bits, medium_font.glyphs
+      },
+      {
+         largeFontInfo.char_height, largeFontInfo.start_char
+       , largeFontInfo.end_char, large_font.bits, large_font.glyphs
+      }
+   };
+
+   inline font_atlas const& get_atlas(font font_)
+   {
+      return atlases[int(font_)];
+   }
+
+   // Reads the packed bit stream, LSB first
+   class bit_reader
+   {
+   public:
+
+      bit_reader(byte const* data, std::size_t pos)
+       : _p(data + pos / 8)
+      {
+         read(pos % 8);
+      }
+
+      // n must be at most 32
+      std::uint32_t read(int n)
+      {
+         while (_n < n)
+         {
+            _acc |= std::uint64_t(*_p++) << _n;
+            _n += 8;
+         }
+         auto val = std::uint32_t(_acc) & std::uint32_t((std::uint64_t(1) << n) - 1);
+         _acc >>= n;
+         _n -= n;
+         return val;
+      }
+
+   private:
+
+      byte const*    _p;
+      std::uint64_t  _acc = 0;
+      int            _n = 0;
+   };
+
+   // The space between glyphs, in pixels
+   constexpr int glyph_spacing = 2;
+
+   // Call f with the draw operation for the color (so that the color is
+   // dispatched once, not per byte)
+   template <typename F>
+   void with_color(color color_, F f)
+   {
+      switch (color_)
+      {
+         case color::white:
+            f([](std::uint8_t& out, std::uint8_t pix) { out |= pix; });
+            break;
+         case color::black:
+            f([](std::uint8_t& out, std::uint8_t pix) { out &= ~pix; });
+            break;
+         case color::inverse:
+            f([](std::uint8_t& out, std::uint8_t pix) { out ^= pix; });
+            break;
+      }
+   }
+
+   // Decode a glyph straight into the canvas, at x, y (the top left of
+   // the glyph's box, a full font height). Each column of the glyph is
+   // read from the bit stream and shifted down to its place in the pages
+   // it covers. With clip == false, the glyph must be entirely in the
+   // canvas: there are no bounds checks.
+   template <bool clip, typename Draw>
+   void draw_glyph(
+      std::uint8_t* buffer, int width, int height, int x, int y
+    , byte const* bits, packed_glyph const& g, Draw draw)
+   {
+      if (g.height == 0)
+         return;
+
+      // The glyph's first page, and the shift down from its top
+      auto const top = y + g.top;
+      auto const page = (top >= 0)? top / 8 : (top - 7) / 8;
+      auto const shift = top - (page * 8);
+      auto const pages = (shift + g.height + 7) / 8;
+      auto const canvas_pages = height / 8;
+
+      bit_reader in{ bits, g.offset };
+      for (int col = 0; col != g.width; ++col)
+      {
+         auto column = std::uint64_t(in.read(g.height)) << shift;
+         auto const cx = x + col;
+         if (clip && (cx < 0 || cx >= width))
+            continue;
+
+         for (int p = 0; p != pages; ++p, column >>= 8)
+         {
+            if (!clip || (page + p >= 0 && page + p < canvas_pages))
+               draw(buffer[(page + p) * width + cx], std::uint8_t(column));
+         }
+      }
+   }
+
    void fast_hline_impl(
       std::uint8_t* buffer, int width, int height,
       int x, int y, int w, color color_)
@@ -257,45 +488,72 @@ namespace cycfi { namespace infinity { namespace detail
       }
    }
 
-   int draw_char(
-      std::uint8_t* buffer, std::uint8_t* end, int width, int height,
-      int x, int y, char ch, font font_, color color_
+   int draw_glyph_run(
+      std::uint8_t* buffer, int width, int height,
+      int x, int y, char const* str, font font_, color color_
    )
    {
-      FONT_INFO const* font_info = nullptr;
-      switch (font_)
+      auto const& atlas = get_atlas(font_);
+
+      // Measure the run. It must have only the font's characters, and fit
+      // entirely in the canvas.
+      int run_width = 0;
+      for (auto p = str; *p; ++p)
       {
-         default:
-         case font::small:
-            font_info = &smallFontInfo;
-            break;
-         case font::medium:
-            font_info = &mediumFontInfo;
-            break;
-         case font::large:
-            font_info = &largeFontInfo;
-            break;
+         auto g = atlas.find(*p);
+         if (!g)
+            return -1;
+         run_width += g->width + glyph_spacing;
       }
 
-      // See if we are not out of bounds:
-      if (ch < font_info->start_char || ch > font_info->end_char)
-         return 0;
+      if (x < 0 || y < 0 || (x + run_width - glyph_spacing) > width
+         || (y + atlas.pages * 8) > height)
+         return -1;
+
+      // Draw the glyphs, with no more bounds checks
+      with_color(color_,
+         [&](auto draw)
+         {
+            auto gx = x;
+            for (auto p = str; *p; ++p)
+            {
+               auto const& g = atlas.glyphs[*p - atlas.first];
+               draw_glyph<false>(buffer, width, height, gx, y, atlas.bits, g, draw);
+               gx += g.width + glyph_spacing;
+            }
+         });
 
-      // start_char is the first glyph in the table
-      ch -= font_info->start_char;
+      return x + run_width;
+   }
 
-      // The descriptors have 2 data: glyph width and offset to actual pixels
-      std::size_t glyph_index = ch * 2;
+   int draw_char(
+      std::uint8_t* buffer, std::uint8_t* /*end*/, int width, int height,
+      int x, int y, char ch, font font_, color color_
+   )
+   {
+      auto const& atlas = get_atlas(font_);
 
-      // Extract the necessary glyph bitmap info
-      unsigned int const* descr = font_info->descriptors;
-      int const glyph_height = font_info->char_height * 8;
-      int const glyph_width = descr[glyph_index];
-      std::uint8_t const* address = font_info->bitmaps + descr[glyph_index + 1];
+      // See if we are not out of bounds:
+      auto g = atlas.find(ch);
+      if (!g)
+         return 0;
 
-      // Draw the font bitmap
-      bitmap const bm = { address, glyph_width, glyph_height };
-      draw_bitmap(buffer, end, width, height, x, y, bm, color_);
-      return x + glyph_width + 2;
+      // Draw the glyph, with bounds checks if it is not entirely in the
+      // canvas
+      char const str[] = { ch, 0 };
+      if (draw_glyph_run(buffer, width, height, x, y, str, font_, color_) < 0)
+      {
+         with_color(color_,
+            [&](auto draw)
+            {
+               draw_glyph<true>(buffer, width, height, x, y, atlas.bits, *g, draw);
+            });
+      }
+      return x + g->width + glyph_spacing;
+   }
+
+   int font_height(font font_)
+   {
+      return get_atlas(font_).pages * 8;
    }
 }}}
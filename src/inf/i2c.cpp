@@ -10,6 +10,33 @@
 namespace cycfi { namespace infinity { namespace detail
 {
    I2C_HandleTypeDef i2c_handles[3];
+   DMA_HandleTypeDef i2c_dma_handles[3];
+
+   // The DMA1 stream and channel of each I2C's TX request (for
+   // i2c_write_async). I2C1 and I2C2 share stream 7: only one of them
+   // can be used.
+   struct i2c_dma_info
+   {
+      DMA_Stream_TypeDef*  stream;
+      uint32_t             channel;
+      IRQn_Type            irq_id;
+   };
+
+   static i2c_dma_info const i2c_dma[3] =
+   {
+      { DMA1_Stream7, DMA_CHANNEL_1, DMA1_Stream7_IRQn },
+      { DMA1_Stream7, DMA_CHANNEL_7, DMA1_Stream7_IRQn },
+      { DMA1_Stream4, DMA_CHANNEL_3, DMA1_Stream4_IRQn }
+   };
+
+   static DMA_HandleTypeDef* dma1_stream7 = nullptr;
+
+   static IRQn_Type const i2c_irq_ids[3][2] =
+   {
+      { I2C1_EV_IRQn, I2C1_ER_IRQn },
+      { I2C2_EV_IRQn, I2C2_ER_IRQn },
+      { I2C3_EV_IRQn, I2C3_ER_IRQn }
+   };
 
    // I2C SPEEDCLOCK define to max value: 400 KHz
    static auto constexpr i2c_clock_speed = 400000;
@@ -64,5 +91,63 @@ namespace cycfi { namespace infinity { namespace detail
       }
 
       HAL_I2C_Init(&handle);
+
+      // Configure the DMA for the asynchronous writes: memory to
+      // peripheral, by byte, one transfer per write.
+      __HAL_RCC_DMA1_CLK_ENABLE();
+      auto const& info = i2c_dma[id-1];
+      auto& dma = i2c_dma_handles[id-1];
+      dma.Instance = info.stream;
+      dma.Init.Channel = info.channel;
+      dma.Init.Direction = DMA_MEMORY_TO_PERIPH;
+      dma.Init.PeriphInc = DMA_PINC_DISABLE;
+      dma.Init.MemInc = DMA_MINC_ENABLE;
+      dma.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+      dma.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+      dma.Init.Mode = DMA_NORMAL;
+      dma.Init.Priority = DMA_PRIORITY_LOW;
+      dma.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+      HAL_DMA_Init(&dma);
+      __HAL_LINKDMA(&handle, hdmatx, dma);
+      if (info.stream == DMA1_Stream7)
+         dma1_stream7 = &dma;
+
+      // Configure NVIC to enable the DMA and I2C interruptions. Like
+      // telemetry, the display has the lowest priority: it must never
+      // delay the DSP interrupts.
+      NVIC_SetPriority(info.irq_id, 0x0F);
+      NVIC_EnableIRQ(info.irq_id);
+      for (auto irq_id : i2c_irq_ids[id-1])
+      {
+         NVIC_SetPriority(irq_id, 0x0F);
+         NVIC_EnableIRQ(irq_id);
+      }
    }
 }}}
+
+///////////////////////////////////////////////////////////////////////////////
+// I2C interrupt handlers (for i2c_write_async)
+///////////////////////////////////////////////////////////////////////////////
+extern "C"
+{
+   using cycfi::infinity::detail::i2c_handles;
+   using cycfi::infinity::detail::i2c_dma_handles;
+
+   void I2C1_EV_IRQHandler(void) { HAL_I2C_EV_IRQHandler(&i2c_handles[0]); }
+   void I2C1_ER_IRQHandler(void) { HAL_I2C_ER_IRQHandler(&i2c_handles[0]); }
+   void I2C2_EV_IRQHandler(void) { HAL_I2C_EV_IRQHandler(&i2c_handles[1]); }
+   void I2C2_ER_IRQHandler(void) { HAL_I2C_ER_IRQHandler(&i2c_handles[1]); }
+   void I2C3_EV_IRQHandler(void) { HAL_I2C_EV_IRQHandler(&i2c_handles[2]); }
+   void I2C3_ER_IRQHandler(void) { HAL_I2C_ER_IRQHandler(&i2c_handles[2]); }
+
+   void DMA1_Stream7_IRQHandler(void)
+   {
+      if (cycfi::infinity::detail::dma1_stream7)
+         HAL_DMA_IRQHandler(cycfi::infinity::detail::dma1_stream7);
+   }
+
+   void DMA1_Stream4_IRQHandler(void)
+   {
+      HAL_DMA_IRQHandler(&i2c_dma_handles[2]);
+   }
+}
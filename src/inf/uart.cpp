@@ -0,0 +1,111 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/detail/uart_impl.hpp>
+#include "stm32f4xx_ll_gpio.h"
+#include "stm32f4xx_ll_rcc.h"
+
+namespace cycfi { namespace infinity { namespace detail
+{
+   void setup_uart_pin(GPIO_TypeDef& gpio, std::uint32_t pin_mask, std::uint32_t alternate)
+   {
+      LL_GPIO_SetPinMode(&gpio, pin_mask, LL_GPIO_MODE_ALTERNATE);
+
+      if (pin_mask > LL_GPIO_PIN_7)
+         LL_GPIO_SetAFPin_8_15(&gpio, pin_mask, alternate);
+      else
+         LL_GPIO_SetAFPin_0_7(&gpio, pin_mask, alternate);
+
+      LL_GPIO_SetPinSpeed(&gpio, pin_mask, LL_GPIO_SPEED_FREQ_HIGH);
+      LL_GPIO_SetPinOutputType(&gpio, pin_mask, LL_GPIO_OUTPUT_PUSHPULL);
+      LL_GPIO_SetPinPull(&gpio, pin_mask, LL_GPIO_PULL_UP);
+   }
+
+   void uart_config(
+      USART_TypeDef* uart, bool apb2, uint32_t periph_id,
+      uint32_t baud_rate,
+      GPIO_TypeDef& tx_gpio, uint32_t tx_pin_mask, uint32_t alternate,
+      DMA_TypeDef* dma, uint32_t dma_stream, uint32_t dma_channel,
+      IRQn_Type dma_irq_id
+   )
+   {
+      // Configure the TX Pin
+      setup_uart_pin(tx_gpio, tx_pin_mask, alternate);
+
+      // Configuration of NVIC
+      // Configure NVIC to enable DMA interruptions. Telemetry has the
+      // lowest priority: it must never delay the DSP interrupts.
+      NVIC_SetPriority(dma_irq_id, 0x0F);
+      NVIC_EnableIRQ(dma_irq_id);
+
+      // Configuration of DMA
+      // Enable the peripheral clock of DMA
+      LL_AHB1_GRP1_EnableClock(
+         (dma == DMA1)? LL_AHB1_GRP1_PERIPH_DMA1 : LL_AHB1_GRP1_PERIPH_DMA2);
+
+      LL_DMA_SetChannelSelection(dma, dma_stream, dma_channel);
+
+      // Configure the DMA transfer
+      //    - DMA transfer in normal mode: one transfer per send.
+      //    - DMA transfer from memory with address increment.
+      //    - DMA transfer to the UART data register without address
+      //      increment, by byte.
+      LL_DMA_ConfigTransfer(
+         dma,
+         dma_stream,
+         LL_DMA_DIRECTION_MEMORY_TO_PERIPH |
+         LL_DMA_MODE_NORMAL                |
+         LL_DMA_PERIPH_NOINCREMENT         |
+         LL_DMA_MEMORY_INCREMENT           |
+         LL_DMA_PDATAALIGN_BYTE            |
+         LL_DMA_MDATAALIGN_BYTE            |
+         LL_DMA_PRIORITY_LOW
+      );
+
+      LL_DMA_SetPeriphAddress(dma, dma_stream, LL_USART_DMA_GetRegAddr(uart));
+
+      // Enable DMA transfer interruption: transfer complete
+      LL_DMA_EnableIT_TC(dma, dma_stream);
+
+      // Enable DMA transfer interruption: transfer error
+      LL_DMA_EnableIT_TE(dma, dma_stream);
+
+      // Configuration of the UART
+      if (apb2)
+         LL_APB2_GRP1_EnableClock(periph_id);
+      else
+         LL_APB1_GRP1_EnableClock(periph_id);
+
+      LL_USART_SetTransferDirection(uart, LL_USART_DIRECTION_TX);
+      LL_USART_ConfigCharacter(
+         uart, LL_USART_DATAWIDTH_8B, LL_USART_PARITY_NONE, LL_USART_STOPBITS_1);
+      LL_USART_SetHWFlowCtrl(uart, LL_USART_HWCONTROL_NONE);
+
+      LL_RCC_ClocksTypeDef clocks;
+      LL_RCC_GetSystemClocksFreq(&clocks);
+      LL_USART_SetBaudRate(
+         uart,
+         apb2? clocks.PCLK2_Frequency : clocks.PCLK1_Frequency,
+         LL_USART_OVERSAMPLING_16,
+         baud_rate
+      );
+
+      LL_USART_EnableDMAReq_TX(uart);
+      LL_USART_Enable(uart);
+   }
+
+   void uart_send(
+      DMA_TypeDef* dma, uint32_t dma_stream,
+      std::uint8_t const* data, std::size_t len
+   )
+   {
+      // The stream disables itself at the end of the previous transfer,
+      // and the DMA interrupt clears all its event flags before the
+      // completion task runs (see irq_impl.hpp)
+      LL_DMA_SetMemoryAddress(dma, dma_stream, reinterpret_cast<uint32_t>(data));
+      LL_DMA_SetDataLength(dma, dma_stream, len);
+      LL_DMA_EnableStream(dma, dma_stream);
+   }
+}}}
@@ -6,11 +6,40 @@
 #include <inf/support.hpp>
 #include <inf/app.hpp>
 
+#if defined(INFINITY_HOST)
+# include <cstdio>
+# include <cstdlib>
+#endif
+
 // The main start function entry point
 void start();
 
 namespace inf = cycfi::infinity;
 
+#if defined(INFINITY_HOST)
+
+int main(int argc, char const* argv[])
+{
+   // Configure the simulator from the command line
+   inf::host::init(argc, argv);
+
+   start();
+   return 0;
+}
+
+namespace cycfi { namespace infinity
+{
+   // Our error handler
+   void error_handler()
+   {
+      std::fprintf(stderr, "error_handler called at %f seconds\n",
+         host::simulator::instance().time());
+      std::abort();
+   }
+}}
+
+#else
+
 int main()
 {
    // Configure the system clock
@@ -41,3 +70,5 @@ namespace cycfi { namespace infinity
       }
    }
 }}
+
+#endif
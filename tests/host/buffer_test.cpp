@@ -0,0 +1,160 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/delay.hpp>
+#include <inf/mirrored_buffer.hpp>
+#include <cassert>
+#include <cstdio>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Block operations test (see buffer.hpp, mirrored_buffer.hpp, lut.hpp and
+// delay.hpp). Build with:
+//
+//    g++ -std=c++14 -DINFINITY_HOST -I inc tests/host/buffer_test.cpp
+//
+// The block pushes and reads must give the same results as the one sample
+// at a time operations, with blocks of various sizes, wrapping around the
+// ring buffers.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+
+namespace cycfi { namespace infinity
+{
+   void error_handler()
+   {
+      assert(false);
+   }
+}}
+
+std::vector<float> ramp(std::size_t n, float start = 1.0f)
+{
+   std::vector<float> v(n);
+   for (std::size_t i = 0; i != n; ++i)
+      v[i] = start + i;
+   return v;
+}
+
+template <typename Buffer>
+void test_buffer(Buffer b1, Buffer b2)
+{
+   auto input = ramp(500);
+   std::size_t const blocks[] = { 1, 7, 64, 3, 100, 0, 5 };
+
+   std::size_t pos = 0;
+   for (auto n : blocks)
+   {
+      b1.push(&input[pos], n);
+      for (std::size_t i = 0; i != n; ++i)
+         b2.push(input[pos + i]);
+      pos += n;
+
+      for (std::size_t i = 0; i != b1.size(); ++i)
+         assert(b1[i] == b2[i]);
+
+      // Read the latest n samples, and 10 samples, 20 samples back
+      std::vector<float> out(n);
+      b1.read(out.data(), 0, n);
+      for (std::size_t i = 0; i != n; ++i)
+         assert(out[i] == input[pos - n + i]);
+
+      float out10[10];
+      b1.read(out10, 20, 10);
+      for (std::size_t i = 0; i != 10; ++i)
+         assert(out10[i] == b2[20 + 9 - i]);
+   }
+
+   // Longer than the buffer: only the latest are kept
+   b1.push(input.data(), input.size());
+   assert(b1[0] == input.back());
+   assert(b1[b1.size() - 1] == input[input.size() - b1.size()]);
+}
+
+int main()
+{
+   test_buffer(inf::buffer<float>(100), inf::buffer<float>(100));
+   test_buffer(inf::fixed_buffer<float, 128>(), inf::fixed_buffer<float, 128>());
+   test_buffer(inf::mirrored_buffer<float, 128>(), inf::mirrored_buffer<float, 128>());
+
+   // lut: fractional block reads
+   {
+      inf::lut<float> l(64);
+      auto input = ramp(40);
+      l.push(input.data(), input.size());
+
+      float out[8];
+      l.read(out, 2.5f, 8);
+      for (std::size_t i = 0; i != 8; ++i)
+         assert(out[i] == l[2.5f + (7 - i)]);
+   }
+
+   // delay: taps and mixes for a block
+   {
+      inf::fixed_delay<float, 200, 2> d1, d2;
+      d1.taps[0].tsamples = d2.taps[0].tsamples = 10;
+      d1.taps[1].tsamples = d2.taps[1].tsamples = 50;
+
+      auto input = ramp(300);
+      auto add = [](float s, float mix) { return s + mix; };
+      constexpr std::size_t n = 32;
+      for (std::size_t pos = 0; pos + n <= input.size(); pos += n)
+      {
+         d1.push(&input[pos], n);
+
+         float mixed[n], tap0[n], tap1[n];
+         float* taps[] = { tap0, tap1 };
+         d1(add, mixed, n);
+         d1.read(taps, n);
+
+         for (std::size_t i = 0; i != n; ++i)
+         {
+            input[pos + i] >> d2;
+            assert(mixed[i] == d2(add));
+            assert(tap0[i] + tap1[i] == mixed[i]);
+         }
+      }
+   }
+
+   // single_delay: block processing, in place, in chunks
+   {
+      auto check = [](float delay)
+      {
+         inf::fixed_single_delay<float, 100, inf::sample_interpolation::linear> d1, d2;
+         d1.samples_delay(delay);
+         d2.samples_delay(delay);
+
+         auto input = ramp(1000);
+         auto block = input;
+         std::size_t const blocks[] = { 1, 13, 500, 200, 286 };
+         std::size_t pos = 0;
+         for (auto n : blocks)
+         {
+            d1(&block[pos], &block[pos], n);
+            for (std::size_t i = 0; i != n; ++i)
+               assert(block[pos + i] == d2(input[pos + i]));
+            pos += n;
+         }
+      };
+
+      check(0);
+      check(10.5f);
+      check(99.25f);
+      check(100);
+
+      // The delay fills the whole delay line
+      inf::fixed_single_delay<float, 127> d1, d2;
+      d1.samples_delay(127);
+      d2.samples_delay(127);
+      auto input = ramp(300);
+      std::vector<float> out(300);
+      d1(input.data(), out.data(), 300);
+      for (std::size_t i = 0; i != 300; ++i)
+         assert(out[i] == d2(input[i]));
+   }
+
+   std::puts("buffer_test: all tests passed");
+   return 0;
+}
@@ -0,0 +1,127 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/canvas.hpp>
+#include <cassert>
+#include <cstdio>
+#include <random>
+
+// The Dot Factory fonts (see canvas.cpp)
+typedef unsigned char byte;
+
+struct FONT_INFO
+{
+   byte                 char_height;
+   char                 start_char;
+   char                 end_char;
+   const unsigned int*  descriptors;
+   const byte*          bitmaps;
+};
+
+#include <inf/detail/large_font.hpp>
+#include <inf/detail/medium_font.hpp>
+#include <inf/detail/small_font.hpp>
+
+///////////////////////////////////////////////////////////////////////////////
+// Glyph run test (see detail::draw_glyph_run). Build with:
+//
+//    g++ -std=c++14 -I inc tests/host/canvas_test.cpp src/inf/canvas.cpp
+//
+// The glyphs are packed, and decoded as they are drawn. Each glyph must
+// give the same pixels as its Dot Factory bitmap.
+//
+// A string entirely in the canvas is drawn as a single run of glyphs,
+// without bounds checks. It must give the same pixels as the same string
+// drawn partly above the canvas (glyph by glyph, with bounds checks), one
+// page up, in a canvas one page shorter.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+using color = inf::monochrome::color;
+using font = inf::monochrome::font;
+
+constexpr int width = 128;
+using tall_canvas = inf::mono_canvas<width, 40>;
+using short_canvas = inf::mono_canvas<width, 32>;
+
+void check_glyphs(FONT_INFO const& info, font font_)
+{
+   for (int ch = info.start_char; ch <= info.end_char; ++ch)
+   {
+      std::uint8_t buffer[short_canvas::size];
+      short_canvas cnv{ buffer };
+      auto next = cnv.draw_char(ch, 0, 0, font_);
+
+      auto descr = info.descriptors + (ch - info.start_char) * 2;
+      int const w = descr[0];
+      auto bitmap = info.bitmaps + descr[1];
+      assert(next == w + 2);
+
+      for (int page = 0; page != short_canvas::pages; ++page)
+      {
+         for (int x = 0; x != width; ++x)
+         {
+            auto expected = (page < info.char_height && x < w)?
+               bitmap[page * w + x] : 0;
+            assert(buffer[page * width + x] == expected);
+         }
+      }
+   }
+}
+
+int main()
+{
+   check_glyphs(smallFontInfo, font::small);
+   check_glyphs(mediumFontInfo, font::medium);
+   check_glyphs(largeFontInfo, font::large);
+
+   std::mt19937 gen;
+   char const* str = "Aj!g~ 0.5";
+   font const fonts[] = { font::small, font::medium, font::large };
+   color const colors[] = { color::white, color::black, color::inverse };
+
+   for (auto font_ : fonts)
+   {
+      for (auto color_ : colors)
+      {
+         for (int y = 0; y != 8; ++y)
+         {
+            std::uint8_t tall_buffer[tall_canvas::size];
+            std::uint8_t short_buffer[short_canvas::size];
+            tall_canvas tall{ tall_buffer };
+            short_canvas short_{ short_buffer };
+
+            // The same background, one page up
+            for (auto& b : tall_buffer)
+               b = gen();
+            std::copy(tall_buffer + width, tall_buffer + tall_canvas::size, short_buffer);
+            tall.mark_clean();
+
+            auto next1 = tall.draw_string(str, 3, y, font_, color_);
+            auto next2 = short_.draw_string(str, 3, y - 8, font_, color_);
+            assert(next1 == next2 && next1 > 3);
+            assert(std::equal(
+               tall_buffer + width, tall_buffer + tall_canvas::size, short_buffer));
+
+            // The dirty columns are the string's
+            auto r = tall.dirty(y / 8);
+            assert(r.first == 3 && r.last == next1);
+         }
+      }
+   }
+
+   // A string that does not fit is clipped, and one with characters not
+   // in the fonts is drawn glyph by glyph
+   {
+      std::uint8_t buffer[short_canvas::size] = {};
+      short_canvas cnv{ buffer };
+      auto next = cnv.draw_string("0123456789012345678901234567890", 0, 0, font::medium);
+      assert(next > width);
+      cnv.draw_string("\x01" "1", 10, 8, font::small);
+   }
+
+   std::puts("canvas_test: all tests passed");
+   return 0;
+}
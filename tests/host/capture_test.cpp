@@ -0,0 +1,178 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/host/capture.hpp>
+#include <array>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// ADC capture and replay test (see capture.hpp and host/capture.hpp).
+// Build with:
+//
+//    g++ -std=c++14 -DINFINITY_HOST -I inc tests/host/capture_test.cpp
+//       src/host/capture.cpp
+//
+// We record blocks of 3-channel frames and a parameter change through a
+// small ring buffer, then read them back, memory mapped, and replay them
+// through a replay_source. We also check that an overwriting recorder
+// keeps the most recent blocks.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+namespace host = cycfi::infinity::host;
+
+constexpr std::size_t channels = 3;
+constexpr std::size_t block_frames = 5;  // odd, to exercise the padding
+
+using frame = std::array<std::uint16_t, channels>;
+using block = std::array<frame, block_frames>;
+
+block make_block(int n)
+{
+   block b;
+   for (std::size_t i = 0; i != block_frames; ++i)
+      for (std::size_t c = 0; c != channels; ++c)
+         b[i][c] = std::uint16_t(n * 100 + i * 10 + c);
+   return b;
+}
+
+int main()
+{
+   char const* path = "capture_test.infr";
+
+   // Record, flushing after each block. The ring buffer holds only two
+   // blocks, so it wraps around.
+   {
+      inf::capture_recorder<channels, block_frames, 128> rec;
+      host::capture_output(path);
+      rec.start(80000, 4);
+      for (int n = 0; n != 4; ++n)
+      {
+         if (n == 2)
+            rec.param(7, 0.25f);
+         auto b = make_block(n);
+         rec.frames(b.begin());
+         rec.flush(host::capture_write);
+      }
+      assert(rec.dropped() == 0);
+
+      // Overflow: the third block does not fit
+      for (int n = 4; n != 7; ++n)
+      {
+         auto b = make_block(n);
+         rec.frames(b.begin());
+      }
+      assert(rec.dropped() == 1);
+      rec.flush(host::capture_write);
+   }
+
+   // Read back
+   {
+      host::capture_file file{ path };
+      assert(file.info().channels == channels);
+      assert(file.info().sampling_rate == 80000);
+      assert(file.info().oversampling == 4);
+      assert(file.info().block_frames == block_frames);
+      assert(file.frames() == 6 * block_frames);
+
+      int params = 0;
+      int blocks = 0;
+      file.for_each(
+         [&](host::capture_file::chunk const& c)
+         {
+            if (c.type == inf::capture_chunk::param)
+               ++params;
+            else
+               ++blocks;
+         });
+      assert(params == 1);
+      assert(blocks == 6);
+   }
+
+   // Replay
+   {
+      std::vector<std::pair<std::uint32_t, float>> changes;
+      host::param_handler(
+         [&](std::uint32_t id, float value)
+         {
+            changes.emplace_back(id, value);
+         });
+
+      host::replay_source src{ path };
+      assert(host::replaying());
+
+      for (int n = 0; n != 6; ++n)
+      {
+         auto expected = make_block(n);
+         for (std::size_t i = 0; i != block_frames; ++i)
+         {
+            frame f;
+            src(1, 0.0, f.data(), channels);
+            assert(f == expected[i]);
+
+            // The parameter change comes just before block 2
+            assert(changes.size() == (n >= 2? 1 : 0));
+         }
+      }
+      assert(changes[0].first == 7 && changes[0].second == 0.25f);
+
+      // Past the end: silence
+      frame f;
+      src(1, 0.0, f.data(), channels);
+      assert(f[0] == 2048 && f[2] == 2048);
+   }
+
+   std::remove(path);
+
+   // Overwrite: without a consumer, the ring buffer keeps the last two
+   // blocks (the header and the older blocks are evicted).
+   {
+      inf::capture_recorder<
+         channels, block_frames, 128, inf::capture_overflow::overwrite
+      > rec;
+      rec.start(80000, 4);
+      for (int n = 0; n != 5; ++n)
+      {
+         auto b = make_block(n);
+         rec.frames(b.begin());
+      }
+      assert(rec.dropped() == 0);
+      assert(rec.info().block_frames == block_frames);
+
+      std::vector<std::uint8_t> window;
+      rec.flush(
+         [&](std::uint8_t const* data, std::size_t len)
+         {
+            window.insert(window.end(), data, data + len);
+         });
+
+      auto const chunk_size = sizeof(inf::capture_chunk_header)
+         + inf::capture_padded(rec.frames_size);
+      assert(window.size() == 2 * chunk_size);
+
+      for (int n = 3; n != 5; ++n)
+      {
+         auto p = window.data() + (n - 3) * chunk_size;
+         inf::capture_chunk_header h;
+         std::memcpy(&h, p, sizeof(h));
+         assert(h.type == inf::capture_chunk::frames);
+
+         std::uint32_t clock;
+         std::memcpy(&clock, p + sizeof(h), sizeof(clock));
+         assert(clock == n * block_frames);
+
+         auto expected = make_block(n);
+         assert(std::memcmp(
+            p + sizeof(h) + sizeof(clock), expected.data(),
+            sizeof(expected)) == 0);
+      }
+   }
+
+   std::puts("capture_test: all tests passed");
+   return 0;
+}
@@ -0,0 +1,116 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/deadline.hpp>
+#include <cassert>
+#include <cstdio>
+#include <functional>
+
+///////////////////////////////////////////////////////////////////////////////
+// Host model of deferred execution (see multi_processor.hpp). Runs on the
+// host, no setup required.
+//
+// We simulate time in ticks. Every period ticks, the DMA interrupt posts a
+// new block. The software interrupt processes the latest posted block, taking
+// a given number of ticks. The DMA interrupt preempts the software interrupt.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+
+struct scheduler_model
+{
+   using cost_function = std::function<int(int block)>;
+
+   scheduler_model(int period, cost_function cost)
+    : _period(period)
+    , _cost(cost)
+   {}
+
+   void run(int ticks)
+   {
+      for (int t = 0; t != ticks; ++t)
+      {
+         // DMA interrupt: flip the buffers and pend the software interrupt
+         if ((t % _period) == 0)
+         {
+            monitor.post();
+            _pending = true;
+         }
+
+         // Software interrupt
+         if (!_running && _pending)
+         {
+            _pending = false;
+            _running = true;
+            monitor.start();
+            _remaining = _cost(_blocks++);
+         }
+
+         if (_running && --_remaining == 0)
+         {
+            _running = false;
+            if (!monitor.finish())
+               ++late;
+         }
+      }
+   }
+
+   inf::deadline_monitor monitor;
+   int late = 0;
+
+private:
+
+   int            _period;
+   cost_function  _cost;
+   bool           _pending = false;
+   bool           _running = false;
+   int            _remaining = 0;
+   int            _blocks = 0;
+};
+
+void test_within_budget()
+{
+   scheduler_model model{ 100, [](int) { return 90; } };
+   model.run(100 * 1000);
+   assert(model.monitor.posted() == 1000);
+   assert(model.monitor.misses() == 0);
+   assert(model.late == 0);
+}
+
+void test_single_overrun()
+{
+   // Block 3 takes one and a half periods
+   scheduler_model model{ 100, [](int block) { return block == 3 ? 150 : 25; } };
+   model.run(100 * 1000);
+   assert(model.monitor.misses() == 1);
+   assert(model.late == 1);
+}
+
+void test_starved()
+{
+   // Block 0 takes two and a half periods, dropping a block in between
+   scheduler_model model{ 100, [](int block) { return block == 0 ? 250 : 25; } };
+   model.run(100 * 10);
+   assert(model.monitor.misses() == 2);
+   assert(model.late == 1);
+}
+
+void test_overloaded()
+{
+   // Every block takes longer than the block period
+   scheduler_model model{ 100, [](int) { return 120; } };
+   model.run(100 * 1000);
+   assert(model.monitor.misses() == model.monitor.posted() - 1);
+}
+
+int main()
+{
+   test_within_budget();
+   test_single_overrun();
+   test_starved();
+   test_overloaded();
+   std::puts("deadline_test: all tests passed");
+   return 0;
+}
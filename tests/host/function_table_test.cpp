@@ -0,0 +1,80 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/function_table.hpp>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+
+///////////////////////////////////////////////////////////////////////////////
+// Function tables test (see function_table.hpp). Build with:
+//
+//    g++ -std=c++14 -DINFINITY_HOST -I inc tests/host/function_table_test.cpp
+//
+// The compile-time math must match the standard library, and the tables
+// must stay within their error bounds over their domains.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+namespace cm = inf::constexpr_math;
+namespace tf = inf::table_functions;
+namespace si = inf::sample_interpolation;
+
+// The tables are computed at compile time
+using sin_table = inf::function_table<tf::sin, 1024>;
+static_assert(sin_table::table.data[1] == 0.0f, "");
+static_assert(sin_table::table.data[1 + 256] == 1.0f, "");
+static_assert(inf::function_table<tf::inverse, 64>::table.data[65] == 1.0f, "");
+
+// The error relative to max(1, |expected|), over n points of the domain
+template <typename Table, typename F>
+double max_error(Table const& table, F f, int n = 100000)
+{
+   using fn = typename Table::function_type;
+   double error = 0;
+   for (int i = 0; i <= n; ++i)
+   {
+      auto x = fn::min + (fn::max - fn::min) * i / n;
+      auto expected = f(x);
+      auto e = std::abs(table(float(x)) - expected) / std::max(1.0, std::abs(expected));
+      error = std::max(error, e);
+   }
+   return error;
+}
+
+int main()
+{
+   // constexpr_math
+   for (double x = -20; x < 20; x += 0.01)
+   {
+      assert(std::abs(cm::sin(x) - std::sin(x)) < 1e-12);
+      assert(std::abs(cm::cos(x) - std::cos(x)) < 1e-12);
+      assert(std::abs(cm::exp(x) - std::exp(x)) < 1e-12 * std::exp(x));
+   }
+   for (double x = 1e-6; x < 1e6; x *= 1.1)
+      assert(std::abs(cm::log(x) - std::log(x)) < 1e-12 * std::max(1.0, std::abs(std::log(x))));
+
+   auto db_to_gain = [](double x) { return std::pow(10.0, x / 20); };
+   auto inverse = [](double x) { return 1 / x; };
+
+   // Linear interpolation: the error is about h^2 / 8 * max |f''|
+   assert(max_error(sin_table{}, [](double x) { return std::sin(x); }) < 5e-6);
+   assert(max_error(inf::function_table<tf::exp, 1024>{}, [](double x) { return std::exp(x); }) < 5e-5);
+   assert(max_error(inf::function_table<tf::log, 1024>{}, [](double x) { return std::log(x); }) < 5e-4);
+   assert(max_error(inf::function_table<tf::db_to_gain, 1024>{}, db_to_gain) < 1e-4);
+   assert(max_error(inf::function_table<tf::inverse, 1024>{}, inverse) < 5e-2);
+
+   // 4 point interpolation: much smaller tables for the same accuracy
+   assert(max_error(inf::function_table<tf::sin, 256, si::lagrange4>{}, [](double x) { return std::sin(x); }) < 1e-6);
+   assert(max_error(inf::function_table<tf::inverse, 1024, si::cubic_hermite>{}, inverse) < 5e-3);
+
+   // Clamped to the domain
+   sin_table sin_;
+   assert(sin_(-1.0f) == 0.0f);
+   assert(std::abs(sin_(7.0f)) < 1e-6f);
+
+   std::puts("function_table_test: all tests passed");
+   return 0;
+}
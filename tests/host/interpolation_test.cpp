@@ -0,0 +1,142 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/delay.hpp>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+
+///////////////////////////////////////////////////////////////////////////////
+// Fractional-delay interpolators test (see interpolation.hpp). Build with:
+//
+//    g++ -std=c++14 -DINFINITY_HOST -I inc tests/host/interpolation_test.cpp
+//
+// The 4 point interpolators must reproduce the polynomials they are exact
+// for, the tables must match the computed coefficients, and the thiran
+// allpass must delay a sine with no loss.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+namespace si = inf::sample_interpolation;
+
+namespace cycfi { namespace infinity
+{
+   void error_handler()
+   {
+      assert(false);
+   }
+}}
+
+bool near(float a, float b, float tolerance = 1e-3f)
+{
+   return std::abs(a - b) <= tolerance;
+}
+
+// Fill b such that b[k] == p(k)
+template <typename Buffer, typename F>
+void fill(Buffer& b, F p)
+{
+   for (int k = int(b.size()) - 1; k >= 0; --k)
+      b.push(p(float(k)));
+}
+
+template <typename Interpolation, typename F>
+void check_exact(F p)
+{
+   inf::fixed_buffer<float, 32> b;
+   fill(b, p);
+   Interpolation interpolate;
+   for (float index = 1.0f; index < 28.0f; index += 0.125f)
+      assert(near(interpolate(b, index), p(index)));
+
+   // Integral indices, including 0, read the samples
+   for (std::size_t i = 0; i != 28; ++i)
+      assert(interpolate(b, float(i)) == b[i]);
+}
+
+// The coefficients at the table's end points are computed exactly
+static_assert(si::tabulated<si::cubic_hermite>::table.c[0][1] == 1.0f, "");
+static_assert(si::tabulated<si::lagrange4>::table.c[256][2] == 1.0f, "");
+
+int main()
+{
+   auto quadratic = [](float x) { return 0.5f * x * x - 3 * x + 2; };
+   auto cubic = [](float x) { return 0.01f * x * x * x - 0.2f * x * x + x; };
+
+   check_exact<si::linear>([](float x) { return 2 * x + 1; });
+   check_exact<si::cubic_hermite>(quadratic);
+   check_exact<si::lagrange4>(quadratic);
+   check_exact<si::lagrange4>(cubic);
+
+   // The tables: exact at the quantized fractions
+   {
+      inf::fixed_buffer<float, 32> b;
+      fill(b, cubic);
+      si::tabulated<si::lagrange4> tl;
+      si::tabulated<si::cubic_hermite, 64> th;
+      si::cubic_hermite h;
+      for (float index = 1.0f; index < 28.0f; index += 1.0f / 64)
+      {
+         assert(near(tl(b, index), cubic(index)));
+         assert(near(th(b, index), h(b, index)));
+      }
+   }
+
+   // 4 point interpolation through single_delay
+   {
+      inf::fixed_single_delay<float, 64, si::cubic_hermite> d;
+      d.samples_delay(10.5f);
+      for (int i = 0; i != 200; ++i)
+      {
+         auto out = d(quadratic(float(i)));
+         if (i > 20)
+            assert(near(out, quadratic(float(i) - 11.5f), 1e-2f));
+      }
+   }
+
+   // thiran: a fractional delay with unity gain at all frequencies
+   {
+      float const pi = 3.14159265f;
+      float const delay = 10.3f;
+      for (float freq : { 0.01f, 0.2f, 0.45f })
+      {
+         inf::fixed_single_delay<float, 64, si::thiran> d;
+         d.samples_delay(delay);
+         float peak = 0;
+         for (int i = 0; i != 4000; ++i)
+         {
+            auto out = d(std::sin(2 * pi * freq * i));
+            if (i > 2000)
+               peak = std::max(peak, std::abs(out));
+         }
+         assert(near(peak, 1.0f, 1e-2f));
+      }
+
+      // At low frequencies, the delay is close to the requested delay
+      inf::fixed_single_delay<float, 64, si::thiran> d;
+      d.samples_delay(delay);
+      float const freq = 0.002f;
+      for (int i = 0; i != 4000; ++i)
+      {
+         auto out = d(std::sin(2 * pi * freq * i));
+         if (i > 2000)
+            assert(near(out, std::sin(2 * pi * freq * (i - delay - 1)), 1e-3f));
+      }
+
+      // Blocks are processed one sample at a time
+      inf::fixed_single_delay<float, 64, si::thiran> d1, d2;
+      d1.samples_delay(delay);
+      d2.samples_delay(delay);
+      float block[100];
+      for (int i = 0; i != 100; ++i)
+         block[i] = std::sin(0.1f * i);
+      d1(block, block, 100);
+      for (int i = 0; i != 100; ++i)
+         assert(block[i] == d2(std::sin(0.1f * i)));
+   }
+
+   std::puts("interpolation_test: all tests passed");
+   return 0;
+}
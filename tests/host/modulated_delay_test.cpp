@@ -0,0 +1,131 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/modulated_delay.hpp>
+#include <inf/delay.hpp>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Modulated multi-tap delay test (see modulated_delay.hpp). Build with:
+//
+//    g++ -std=c++14 -DINFINITY_HOST -I inc tests/host/modulated_delay_test.cpp
+//
+// With fixed taps, modulated_delay must give the same results as the
+// multi-tapped delay, one sample at a time or in blocks of any size. Tap
+// delay changes must ramp to the new delay.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+namespace si = inf::sample_interpolation;
+
+namespace cycfi { namespace infinity
+{
+   void error_handler()
+   {
+      assert(false);
+   }
+}}
+
+bool near(float a, float b)
+{
+   return std::abs(a - b) <= 1e-3f * std::max(1.0f, std::abs(b));
+}
+
+std::vector<float> ramp(std::size_t n)
+{
+   std::vector<float> v(n);
+   for (std::size_t i = 0; i != n; ++i)
+      v[i] = 1.0f + i;
+   return v;
+}
+
+int main()
+{
+   using delay_type = inf::modulated_delay<float, 200, 3, 32>;
+
+   // Fixed taps: the same as delay
+   {
+      delay_type md1, md2;
+      inf::fixed_delay<float, 200, 3, si::linear> d;
+      float const delays[] = { 0.75f, 10.25f, 200 };
+      float const gains[] = { 1.0f, 0.5f, -0.25f };
+      for (std::size_t i = 0; i != 3; ++i)
+      {
+         md1.delay(i, delays[i]);
+         md1.gain(i, gains[i]);
+         md2.delay(i, delays[i]);
+         md2.gain(i, gains[i]);
+         d.taps[i].tsamples = delays[i];
+      }
+
+      auto input = ramp(1000);
+      auto block = input;
+      std::size_t const blocks[] = { 1, 13, 100, 32, 500, 354 };
+      std::size_t pos = 0;
+      for (auto n : blocks)
+      {
+         md1(&block[pos], &block[pos], n);   // in place, in chunks
+         for (std::size_t i = 0; i != n; ++i)
+         {
+            input[pos + i] >> d;
+            std::size_t t = 0;
+            auto expected = d([&](float s, float mix) { return s * gains[t++] + mix; });
+            assert(near(block[pos + i], expected));
+            assert(near(md2(input[pos + i]), expected));
+         }
+         pos += n;
+      }
+   }
+
+   // Separate taps
+   {
+      delay_type md1, md2;
+      md1.delay(1, 20);
+      md1.delay(2, 50.5f);
+      md2.delay(1, 20);
+      md2.delay(2, 50.5f);
+
+      auto input = ramp(300);
+      std::vector<float> t0(300), t1(300), t2(300);
+      float* out[] = { t0.data(), t1.data(), t2.data() };
+      md1(input.data(), out, 300);
+      for (std::size_t i = 0; i != 300; ++i)
+      {
+         assert(t0[i] == input[i]);
+         assert(near(t0[i] + t1[i] + t2[i], md2(input[i])));
+      }
+   }
+
+   // Ramps: the delay moves linearly to the new delay
+   {
+      inf::modulated_delay<float, 200, 1, 32> md;
+      md.delay(0, 10);
+      auto input = ramp(1000);
+      std::vector<float> out(1000);
+      md(input.data(), out.data(), 100);
+
+      md.delay(0, 30, 80);
+      md(&input[100], &out[100], 200);
+      assert(md.delay(0) == 30);
+      for (std::size_t i = 0; i != 200; ++i)
+      {
+         // The input is a ramp: out is the input less the delay
+         auto delay = (i < 80)? 10 + (i + 1) * 0.25f : 30.0f;
+         assert(near(out[100 + i], input[100 + i] - delay));
+      }
+
+      // Out of range delays are clipped
+      md.delay(0, 1000);
+      assert(md.delay(0) == 200);
+      md.delay(0, -1);
+      assert(md.delay(0) == 0);
+   }
+
+   std::puts("modulated_delay_test: all tests passed");
+   return 0;
+}
@@ -0,0 +1,80 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/detail/multi_adc_layout.hpp>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Host test for the dual/triple simultaneous ADC frame layout (see
+// multi_adc.hpp). Runs on the host, no setup required.
+//
+// We simulate the DMA (mode 1) stream: for each conversion trigger, the ADCs
+// convert their rank 1 channels together, then their rank 2 channels, and
+// so on, with the DMA transferring the results in ADC1, ADC2, ADC3 order.
+// The resulting buffer must hold complete frames in logical channel order.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+
+// A distinct sample value for a given channel and time
+std::uint16_t sample(std::size_t channel, std::size_t time)
+{
+   return std::uint16_t((time * 100) + channel);
+}
+
+template <std::size_t num_adcs, std::size_t channels>
+void test_layout()
+{
+   using layout = inf::detail::multi_adc_layout<num_adcs, channels>;
+   using frame = std::array<std::uint16_t, channels>;
+   constexpr std::size_t frames = 16;
+
+   // Each channel is assigned a unique ADC and rank
+   for (std::size_t i = 0; i != channels; ++i)
+   {
+      assert(layout::adc(i) >= 1 && layout::adc(i) <= num_adcs);
+      assert(layout::rank(i) >= 1 && layout::rank(i) <= layout::ranks);
+      assert(layout::index(layout::adc(i), layout::rank(i)) == i);
+   }
+
+   // The ADC sequencer setup: what channel does each ADC convert per rank?
+   std::array<std::array<std::size_t, layout::ranks>, num_adcs> sequence;
+   for (std::size_t i = 0; i != channels; ++i)
+      sequence[layout::adc(i)-1][layout::rank(i)-1] = i;
+
+   // Simulate the DMA stream
+   std::vector<std::uint16_t> dma;
+   for (std::size_t t = 0; t != frames; ++t)
+      for (std::size_t r = 0; r != layout::ranks; ++r)
+         for (std::size_t a = 0; a != num_adcs; ++a)
+            dma.push_back(sample(sequence[a][r], t));
+
+   // Unpack the frames
+   assert(dma.size() == frames * channels);
+   auto const* f = reinterpret_cast<frame const*>(dma.data());
+   for (std::size_t t = 0; t != frames; ++t)
+      for (std::size_t c = 0; c != channels; ++c)
+         assert(f[t][c] == sample(c, t));
+
+   // Channels in the same rank are sampled simultaneously
+   for (std::size_t c = 0; c != channels; ++c)
+      assert(layout::rank(c) == (c / num_adcs) + 1);
+}
+
+int main()
+{
+   test_layout<2, 2>();
+   test_layout<2, 6>();
+   test_layout<3, 3>();
+   test_layout<3, 6>();
+   test_layout<2, 12>();
+   test_layout<3, 12>();
+   std::puts("multi_adc_layout_test: all tests passed");
+   return 0;
+}
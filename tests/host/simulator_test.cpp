@@ -0,0 +1,111 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/timer.hpp>
+#include <inf/adc.hpp>
+#include <inf/dac.hpp>
+#include <inf/pin.hpp>
+#include <inf/uart.hpp>
+#include <inf/support.hpp>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+///////////////////////////////////////////////////////////////////////////////
+// Host simulator test (see host/simulator.hpp). Build with:
+//
+//    g++ -std=c++14 -DINFINITY_HOST -I inc tests/host/simulator_test.cpp
+//       src/main.cpp src/host/simulator.cpp src/host/capture.cpp
+//
+// A 10kHz timer triggers 2-channel ADC conversions into an 8 frame buffer.
+// We check the interrupt rates against the simulated clock, the ADC
+// source data, the DAC and EXTI plumbing and the UART transfer time.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+namespace host = cycfi::infinity::host;
+
+inf::timer<3> tmr;
+inf::adc<1, 2, 8> adc;
+inf::dac<0> dac;
+inf::input_pin<inf::port::portc + 13, inf::port::pull_up> btn;
+inf::uart_tx<inf::port::porta + 2, 230400> uart;
+
+int ticks = 0;
+int halves = 0;
+int completes = 0;
+int presses = 0;
+int sent = 0;
+
+auto config = inf::config(
+   tmr.setup(1000000, 10000, []{ ++ticks; }),
+   adc.setup(tmr, []{ ++halves; }, []{ ++completes; dac(adc[7][1]); }),
+   adc.enable_channels<0, 1>(),
+   dac.setup(),
+   btn.setup([]{ ++presses; }),
+   uart.setup([]{ ++sent; })
+);
+
+struct counter_source : host::adc_source
+{
+   void operator()(
+      std::size_t adc_id, double /*time*/,
+      std::uint16_t* frame, std::size_t channels) override
+   {
+      assert(adc_id == 1 && channels == 2);
+      frame[0] = n;
+      frame[1] = n++;
+   }
+
+   std::uint16_t n = 0;
+};
+
+void start()
+{
+   auto& sim = host::simulator::instance();
+   sim.source(std::unique_ptr<host::adc_source>{ new counter_source });
+
+   // The pull-up pin idles high
+   assert(btn);
+
+   adc.start();
+   tmr.start();
+   btn.start();
+
+   // 10ms at 10kHz: 100 timer updates, 100 / 8 ADC buffers
+   inf::delay_ms(10);
+   assert(inf::millis() == 10);
+   assert(ticks == 100);
+   assert(completes == 100 / 8);
+   assert(halves == completes + 1);
+
+   // The DMA wraps around: the first half holds conversions 96 to 99,
+   // the second half conversions 92 to 95
+   assert(adc[0][0] == 96);
+   assert(adc[4][0] == 92);
+   assert(adc[7][1] == 95);
+   assert(sim.dac(0) == 95);
+
+   // Falling edge only
+   sim.set_input(inf::port::portc + 13, false);
+   sim.set_input(inf::port::portc + 13, true);
+   sim.set_input(inf::port::portc + 13, false);
+   assert(presses == 2);
+   assert(!btn);
+
+   // 230 bytes at 230400 baud, 8N1: 9.98ms
+   sim.uart_output("/dev/null");
+   std::uint8_t data[230] = {};
+   uart.send(data, sizeof(data));
+   inf::delay_ms(5);
+   assert(uart.busy() && sent == 0);
+   inf::delay_ms(5);
+   assert(!uart.busy() && sent == 1);
+
+   std::puts("simulator_test: all tests passed");
+   std::exit(0);
+}
+
+#include <inf/irq.hpp>
@@ -0,0 +1,266 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/ssd1306.hpp>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+///////////////////////////////////////////////////////////////////////////////
+// ssd1306 partial refresh test (see canvas.hpp and ssd1306.hpp). Build
+// with:
+//
+//    g++ -std=c++14 -DINFINITY_HOST -I inc tests/host/ssd1306_test.cpp
+//       src/inf/canvas.cpp src/main.cpp src/host/simulator.cpp src/host/capture.cpp
+//
+// The port models the SSD1306 display memory (horizontal addressing mode,
+// with the column_addr and page_addr windows). After each refresh, the
+// display memory must match the canvas, with only the dirty pages and
+// columns sent. Asynchronous writes are held until complete() is called,
+// to check that drawing does not affect the frame in flight.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+namespace sc = inf::ssd1306_constants;
+using color = inf::monochrome::color;
+using font = inf::monochrome::font;
+
+constexpr int width = 128;
+constexpr int height = 32;
+constexpr int pages = height / 8;
+
+struct display_model
+{
+   void write(std::uint32_t addr, std::uint8_t const* data, std::size_t len, uint32_t /*timeout*/)
+   {
+      assert(addr == sc::ssd1306_i2c_addr && len >= 1);
+      assert(!busy());
+      bytes += len;
+
+      // Control bytes: with the Co bit (0x80) set, one byte follows, then
+      // another control byte. Otherwise, the rest are all data (D/C bit,
+      // 0x40, set) or all commands.
+      for (std::size_t i = 0; i != len; )
+      {
+         auto control = data[i++];
+         assert((control & 0x3f) == 0);
+         auto end = (control & 0x80)? std::min(i + 1, len) : len;
+         for (; i != end; ++i)
+         {
+            if (control & 0x40)
+               store(data[i]);
+            else
+               command(data[i]);
+         }
+      }
+   }
+
+   void write_async(std::uint32_t addr, std::uint8_t const* data, std::size_t len)
+   {
+      assert(!busy());
+      async_addr = addr;
+      async_data = data;
+      async_len = len;
+   }
+
+   bool busy() const { return async_data != nullptr; }
+   bool failed() const { return false; }
+
+   void complete()
+   {
+      if (auto data = async_data)
+      {
+         async_data = nullptr;
+         write(async_addr, data, async_len, 0);
+      }
+   }
+
+   void store(std::uint8_t data)
+   {
+      memory[page][col] = data;
+      if (++col > col_end)
+      {
+         col = col_start;
+         if (++page > page_end)
+            page = page_start;
+      }
+      ++data_bytes;
+   }
+
+   void command(std::uint8_t cmd)
+   {
+      // Commands are followed by their arguments
+      if (args)
+      {
+         arg[num_args - args--] = cmd;
+         if (args == 0 && pending == sc::column_addr)
+            col = col_start = arg[0], col_end = arg[1];
+         else if (args == 0 && pending == sc::page_addr)
+            page = page_start = arg[0], page_end = arg[1];
+         return;
+      }
+
+      pending = cmd;
+      switch (cmd)
+      {
+         case sc::column_addr:
+         case sc::page_addr:
+            num_args = args = 2;
+            break;
+
+         case sc::set_mux_ratio: case sc::charge_pump: case sc::set_pre_charge:
+         case sc::memory_mode: case sc::set_contrast: case sc::set_display_clock_div:
+         case sc::set_display_offset: case sc::set_com_pins: case sc::set_vcom_detect:
+            num_args = args = 1;
+            break;
+      }
+   }
+
+   std::uint8_t   memory[pages][width] = {};
+   int            col = 0, col_start = 0, col_end = width - 1;
+   int            page = 0, page_start = 0, page_end = pages - 1;
+   int            pending = 0, args = 0, num_args = 0;
+   std::uint8_t   arg[2] = {};
+   std::size_t    bytes = 0;
+   std::size_t    data_bytes = 0;
+   std::uint32_t  async_addr = 0;
+   std::uint8_t const* async_data = nullptr;
+   std::size_t    async_len = 0;
+};
+
+using oled_type = inf::ssd1306<display_model, inf::mono_canvas<width, height>>;
+
+bool same(oled_type& oled, display_model& port)
+{
+   for (int p = 0; p != pages; ++p)
+      for (int x = 0; x != width; ++x)
+         if (port.memory[p][x] != oled[p * width + x])
+            return false;
+   return true;
+}
+
+void check(oled_type& oled, display_model& port)
+{
+   assert(!oled.is_dirty());
+   assert(same(oled, port));
+}
+
+void start()
+{
+   display_model port;
+   std::memset(port.memory, 0xaa, sizeof(port.memory));
+   oled_type oled{ port };
+
+   // The whole display is sent at first
+   check(oled, port);
+   assert(port.data_bytes == width * pages);
+
+   // Nothing to send
+   port.bytes = port.data_bytes = 0;
+   oled.refresh();
+   assert(port.bytes == 0);
+
+   // Only the columns drawn into
+   oled.draw_string("123", 70, 8, font::medium);
+   oled.refresh();
+   check(oled, port);
+   assert(port.data_bytes < 2 * 40);
+
+   // Erasing and redrawing the value only
+   port.bytes = port.data_bytes = 0;
+   oled.fill_rect(70, 8, width - 70, 16, color::black);
+   oled.draw_string("456", 70, 8, font::medium);
+   oled.refresh();
+   check(oled, port);
+   assert(port.data_bytes == 2 * (width - 70));
+   assert(port.bytes < 150);
+
+   // clear sends only the columns that were not blank
+   port.bytes = port.data_bytes = 0;
+   oled.clear();
+   oled.refresh();
+   check(oled, port);
+   assert(port.data_bytes > 0 && port.data_bytes < 2 * 40);
+
+   // Random drawing
+   std::mt19937 gen;
+   std::uniform_int_distribution<int> xd(-10, width + 10), yd(-10, height + 10), cd(0, 2);
+   for (int i = 0; i != 500; ++i)
+   {
+      auto c = color(cd(gen));
+      switch (i % 8)
+      {
+         case 0: oled.draw_pixel(xd(gen), yd(gen), c); break;
+         case 1: oled.draw_line(xd(gen), yd(gen), xd(gen), yd(gen), c); break;
+         case 2: oled.fill_rect(xd(gen), yd(gen), xd(gen) / 4, yd(gen) / 2, c); break;
+         case 3: oled.draw_rect(xd(gen), yd(gen), xd(gen) / 2, yd(gen), c); break;
+         case 4: oled.draw_string("Hello", xd(gen), yd(gen), font::small, c); break;
+         case 5: oled.draw_char('8', xd(gen), yd(gen), font::large, c); break;
+         case 6: oled.fast_hline(xd(gen), yd(gen), xd(gen), c); break;
+         case 7: if (i % 64 == 7) oled.clear(); break;
+      }
+      if (i % 3 == 0)
+      {
+         oled.refresh();
+         check(oled, port);
+      }
+   }
+
+   // Asynchronous refresh
+   port.bytes = port.data_bytes = 0;
+   oled.clear();
+   oled.draw_string("123", 70, 8, font::medium);
+   assert(oled.refresh_async());
+   assert(oled.busy() && !oled.is_dirty());
+
+   // Busy: nothing is sent, and the canvas stays dirty
+   std::uint8_t frame[pages][width];
+   for (int p = 0; p != pages; ++p)
+      for (int x = 0; x != width; ++x)
+         frame[p][x] = oled[p * width + x];
+   oled.fill_rect(70, 8, width - 70, 16, color::black);
+   oled.draw_string("456", 70, 8, font::medium);
+   assert(!oled.refresh_async());
+   assert(oled.is_dirty());
+
+   // The frame in flight is not affected by the drawing
+   port.complete();
+   assert(std::memcmp(port.memory, frame, sizeof(frame)) == 0);
+   assert(port.bytes == port.data_bytes + 13);
+
+   // The changes go with the next refresh
+   assert(oled.refresh_async());
+   port.complete();
+   check(oled, port);
+   assert(oled.refresh_async() && !oled.busy());
+
+   // Random drawing, with and without waiting for the transfers
+   for (int i = 0; i != 500; ++i)
+   {
+      auto c = color(cd(gen));
+      switch (i % 4)
+      {
+         case 0: oled.draw_line(xd(gen), yd(gen), xd(gen), yd(gen), c); break;
+         case 1: oled.fill_rect(xd(gen), yd(gen), xd(gen) / 4, yd(gen) / 2, c); break;
+         case 2: oled.draw_string("Hello", xd(gen), yd(gen), font::small, c); break;
+         case 3: oled.draw_pixel(xd(gen), yd(gen), c); break;
+      }
+      oled.refresh_async();
+      if (i % 3 == 0)
+         port.complete();
+   }
+   port.complete();
+   oled.refresh_async();
+   port.complete();
+   check(oled, port);
+
+   // The blocking refresh also works (while nothing is in flight)
+   oled.draw_string("789", 0, 0, font::small);
+   oled.refresh();
+   check(oled, port);
+
+   std::puts("ssd1306_test: all tests passed");
+}
@@ -0,0 +1,135 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/delay.hpp>
+#include <inf/static_memory.hpp>
+#include <cassert>
+#include <cstdio>
+
+///////////////////////////////////////////////////////////////////////////////
+// Heap-free storage test (see static_memory.hpp, buffer.hpp, lut.hpp and
+// delay.hpp). Build with:
+//
+//    g++ -std=c++14 -DINFINITY_HOST -I inc tests/host/static_memory_test.cpp
+//
+// We check the compile-time capacity buffers and delays, arena storage,
+// and the RAM budget numbers.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+
+namespace cycfi { namespace infinity
+{
+   int errors = 0;
+
+   // Count the fatal errors instead
+   void error_handler()
+   {
+      ++errors;
+   }
+}}
+
+struct test_arena_tag;
+using test_arena = inf::static_arena<1024, test_arena_tag>;
+
+int main()
+{
+   // fixed_buffer: capacity rounded up to a power of 2, stored in place
+   {
+      using buffer_type = inf::fixed_buffer<int, 100>;
+      static_assert(buffer_type::capacity == 128, "");
+      static_assert(sizeof(buffer_type) >= 128 * sizeof(int), "");
+      static_assert(inf::buffer<int>::capacity == 0, "");
+
+      buffer_type b;
+      assert(b.size() == 128);
+      assert(b[0] == 0 && b[127] == 0);
+      for (int i = 0; i != 200; ++i)
+         b.push(i);
+      assert(b[0] == 199);
+      assert(b[127] == 72);
+
+      // Sizes up to the capacity are fine. Beyond is an error.
+      buffer_type b2(128);
+      assert(inf::errors == 0);
+      buffer_type b3(129);
+      assert(inf::errors == 1);
+      inf::errors = 0;
+   }
+
+   // fixed_single_delay: delays up to max_samples, including powers of 2.
+   // (d(s) returns the delayed signal before pushing s: one sample more.)
+   {
+      inf::fixed_single_delay<float, 64> d;
+      d.samples_delay(64);
+      for (int i = 0; i != 200; ++i)
+      {
+         auto out = d(float(i));
+         assert(out == ((i >= 65)? float(i - 65) : 0.0f));
+      }
+
+      // Linear interpolation reads one sample more
+      inf::fixed_single_delay<float, 64, inf::sample_interpolation::linear> ld;
+      ld.samples_delay(63.5f);
+      for (int i = 0; i != 200; ++i)
+      {
+         auto out = ld(float(i));
+         if (i >= 66)
+            assert(out == float(i) - 64.5f);
+      }
+
+      static_assert(inf::delay_samples(0.02, 20000) == 400, "");
+      static_assert(inf::delay_samples(0.0201, 20000) == 402, "");
+   }
+
+   // fixed_delay: fixed number of taps
+   {
+      inf::fixed_delay<float, 100, 2> d;
+      d.taps[0].tsamples = 10;
+      d.taps[1].tsamples = 100;
+      for (int i = 0; i != 150; ++i)
+         float(i) >> d;
+      auto sum = d([](float s, float mix) { return s + mix; });
+      assert(sum == float(149 - 10) + float(149 - 100));
+   }
+
+   // arena_storage: runtime sizes, static memory
+   {
+      using buffer_type = inf::arena_buffer<float, test_arena>;
+      buffer_type b1(100);   // 128 floats
+      assert(b1.size() == 128);
+      assert(test_arena::used() == 128 * sizeof(float));
+
+      inf::single_delay<float, buffer_type> d(std::size_t(50));   // 64 floats
+      assert(test_arena::used() == 192 * sizeof(float));
+      assert(test_arena::remaining() == 1024 - 192 * sizeof(float));
+
+      for (int i = 0; i != 100; ++i)
+      {
+         b1.push(i);
+         auto out = d(float(i));
+         assert(out == ((i >= 51)? float(i - 51) : 0.0f));
+      }
+      assert(b1[0] == 99 && b1[99] == 0);
+
+      // Out of arena memory
+      assert(inf::errors == 0);
+      test_arena::allocate(1024, 4);
+      assert(inf::errors == 1);
+      inf::errors = 0;
+   }
+
+   // ram_budget
+   {
+      using report = inf::ram_budget<
+         8192, inf::fixed_buffer<float, 1024>, test_arena>;
+      static_assert(report::ok, "");
+      static_assert(report::used == sizeof(inf::fixed_buffer<float, 1024>) + 1024, "");
+      static_assert(report::remaining == 8192 - report::used, "");
+   }
+
+   std::puts("static_memory_test: all tests passed");
+   return 0;
+}
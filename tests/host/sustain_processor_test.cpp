@@ -0,0 +1,138 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/multi_processor.hpp>
+#include <inf/governor.hpp>
+#include "../../app/sustain_processor.hpp"
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+
+///////////////////////////////////////////////////////////////////////////////
+// sustain_processor load tiers (see app/sustain_processor.hpp), driven by a
+// load_governor (see governor.hpp) the way multi_channel_processor does.
+// Build with:
+//
+//    g++ -std=c++14 -DINFINITY_HOST -I inc -I q/q_lib/include
+//       tests/host/sustain_processor_test.cpp
+//
+// Channel 0 gets a quiet signal, below the AGC's gate thresholds (idle),
+// channel 1 silence, then a note, and channel 2 a note throughout. We step
+// the governor up to tier 1 and check that only the idle channel is
+// skipped, that a new note wakes its channel up, and that the governor
+// steps back down only after hold quiet blocks.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+
+using base_type = inf::sustain_processor<3, 1>;
+using processor_type = inf::processor<base_type>;
+
+static_assert(inf::detail::load_tiers<processor_type>(0) == 1,
+   "multi_channel_processor must see the load tiers");
+
+constexpr std::size_t block_size = 128;
+constexpr std::uint32_t hold = 64;
+constexpr float pi = 3.14159265f;
+
+struct test_rig
+{
+   // Process a block that took the given load
+   void block(float load, bool note)
+   {
+      auto tier = governor.tier();
+      if (governor(std::uint32_t(load * 1000), 1000) != tier)
+         proc.degrade(governor.tier());
+
+      for (auto& frame : in)
+      {
+         frame[0] = (n & 1)? idle(n) : -idle(n);
+         frame[1] = note? sine(note_n++) : 0.0f;
+         frame[2] = sine(n++);
+      }
+      proc.process(out.begin(), out.end(), in.begin(), [](float s) { return s; });
+   }
+
+   // A slowly varying quiet level, so that the envelope keeps changing
+   static float idle(std::uint32_t i)
+   {
+      return 0.005f + 0.0025f * std::sin(float(i) / 200);
+   }
+
+   // A 220Hz note, starting at a zero crossing, rising (as plucked)
+   static float sine(std::uint32_t i)
+   {
+      auto t = float(i) / inf::sustain_constants::sps;
+      return 0.5f * std::sin(2 * pi * 220 * t);
+   }
+
+   float envelope(std::size_t channel) const
+   {
+      return proc._sustainers[channel].envelope();
+   }
+
+   processor_type proc;
+   inf::load_governor governor{ processor_type::load_tiers, 0.85f, 0.6f, hold };
+   std::array<std::array<float, 3>, block_size> in;
+   std::array<std::array<float, 2>, block_size> out;
+   std::uint32_t n = 0;
+   std::uint32_t note_n = 0;
+};
+
+int main()
+{
+   test_rig rig;
+
+   // Tier 0: every channel runs
+   for (int i = 0; i != 40; ++i)
+      rig.block(0.5f, false);
+   assert(rig.governor.tier() == 0);
+   assert(!rig.proc._sustainers[0].active());
+   assert(rig.proc._sustainers[2].active());
+
+   // Step up at once. There is only one tier to step up to.
+   rig.block(0.9f, false);
+   assert(rig.governor.tier() == 1);
+   rig.block(0.95f, false);
+   assert(rig.governor.tier() == 1);
+
+   // After wake_hold samples, the idle channel is skipped: its envelope
+   // no longer changes. The active channel still runs.
+   for (std::size_t i = 0; i < base_type::wake_hold / block_size + 1; ++i)
+      rig.block(0.7f, false);
+   auto env = rig.envelope(0);
+   auto env1 = rig.envelope(1);
+   for (int i = 0; i != 8; ++i)
+      rig.block(0.7f, false);
+   assert(rig.envelope(0) == env);
+   assert(rig.envelope(1) == env1);
+   assert(rig.proc._sustainers[2].active());
+
+   // A note wakes its channel up
+   for (int i = 0; i != 20; ++i)
+      rig.block(0.7f, true);
+   assert(rig.envelope(1) > 0.1f);
+   assert(rig.proc._sustainers[1].active());
+   assert(rig.envelope(0) == env);
+
+   // Hysteresis: a block above the low threshold restarts the hold
+   for (std::uint32_t i = 0; i != hold - 1; ++i)
+      rig.block(0.5f, true);
+   assert(rig.governor.tier() == 1);
+   rig.block(0.7f, true);
+   for (std::uint32_t i = 0; i != hold - 1; ++i)
+      rig.block(0.5f, true);
+   assert(rig.governor.tier() == 1);
+   assert(rig.envelope(0) == env);
+
+   // Step down after hold quiet blocks: the idle channel runs again
+   rig.block(0.5f, true);
+   assert(rig.governor.tier() == 0);
+   rig.block(0.5f, true);
+   assert(rig.envelope(0) != env);
+
+   std::puts("sustain_processor_test: all tests passed");
+   return 0;
+}
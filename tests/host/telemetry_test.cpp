@@ -0,0 +1,210 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/host/telemetry.hpp>
+#include <inf/host/serial.hpp>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry test (see telemetry.hpp and host/telemetry.hpp). Build with:
+//
+//    g++ -std=c++14 -I inc tests/host/telemetry_test.cpp src/host/serial.cpp
+//
+// We stream frames through a pseudo terminal, standing in for the UART and
+// the serial link, with some line noise and a corrupted frame, and decode
+// them on the other end with serial_port and telemetry_decoder.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+namespace host = cycfi::infinity::host;
+
+// Sends to the pty master. Corrupts the byte at corrupt_at (counting all
+// the bytes sent).
+struct fake_uart
+{
+   void send(std::uint8_t const* data, std::size_t len)
+   {
+      std::vector<std::uint8_t> buff(data, data + len);
+      if (corrupt_at >= pos && corrupt_at < pos + len)
+         buff[corrupt_at - pos] ^= 0x10;
+      pos += len;
+      auto n = ::write(fd, buff.data(), len);
+      assert(n == int(len));
+      (void) n;
+      busy = true;
+   }
+
+   int fd;
+   bool busy = false;
+   std::size_t pos = 0;
+   std::size_t corrupt_at = std::size_t(-1);
+};
+
+template <typename Stream>
+void flush(Stream& stream, fake_uart& uart)
+{
+   // poll, then sent on transfer complete, as the UART interrupt would
+   while (true)
+   {
+      stream.poll(uart);
+      if (!uart.busy)
+         break;
+      uart.busy = false;
+      stream.sent();
+   }
+}
+
+inf::telemetry_string make_string(int i)
+{
+   inf::telemetry_string s;
+   s.sample_clock = 1000 * i;
+   s.channel = i % 3;
+   s.flags = inf::telemetry_string::active;
+   s.period = 100.0f + i * 0.25f;
+   s.phase_error = -0.25f + i * 0.01f;
+   s.envelope = i / 32.0f;
+   s.level = 1.0f - i / 32.0f;
+   return s;
+}
+
+int main()
+{
+   // Frame encoding round trip
+   {
+      auto s = make_string(7);
+      std::uint8_t buff[inf::telemetry_string::size];
+      s.encode(buff);
+      inf::telemetry_string d;
+      d.decode(buff);
+      assert(d.sample_clock == 7000 && d.channel == 1 && d.flags == 1);
+      assert(d.period == s.period);
+      assert(std::abs(d.phase_error - s.phase_error) < 1.0f / 65536);
+      assert(std::abs(d.envelope - s.envelope) < 1.0f / 65535);
+      assert(std::abs(d.level - s.level) < 1.0f / 65535);
+
+      // Out of range values are clamped
+      inf::telemetry_system sys;
+      sys.load = 1.5f;
+      sys.peak_load = -1.0f;
+      sys.tier = 2;
+      sys.deadline_misses = 123456;
+      sys.dropped = 42;
+      std::uint8_t sbuff[inf::telemetry_system::size];
+      sys.encode(sbuff);
+      inf::telemetry_system sd;
+      sd.decode(sbuff);
+      assert(sd.load == 1.0f && sd.peak_load == 0.0f && sd.tier == 2);
+      assert(sd.deadline_misses == 123456 && sd.dropped == 42);
+   }
+
+   // A full ring drops whole frames
+   {
+      inf::telemetry_stream<64> stream;
+      auto s = make_string(0);
+      assert(stream.push(s));
+      assert(stream.push(s));
+      assert(!stream.push(s));   // 3 * 23 bytes > 64
+      assert(stream.dropped() == 1);
+   }
+
+   // Stream through a pty
+   int master = ::posix_openpt(O_RDWR | O_NOCTTY);
+   assert(master >= 0);
+   assert(::grantpt(master) == 0 && ::unlockpt(master) == 0);
+
+   // Open the other end first, to put it in raw mode
+   host::serial_port port(::ptsname(master), 230400);
+   assert(port.is_tty());
+
+   fake_uart uart;
+   uart.fd = master;
+
+   // Line noise, including a false sync
+   std::uint8_t const noise[] = { 0x00, 0xA5, 0xFF, 0xA5, 0x5A, 0x01, 0x33 };
+   auto written = ::write(master, noise, sizeof(noise));
+   assert(written == int(sizeof(noise)));
+   (void) written;
+
+   // Corrupt a payload byte of frame 5
+   constexpr std::size_t frame_size =
+      inf::telemetry_overhead + inf::telemetry_string::size;
+   uart.corrupt_at = 5 * frame_size + inf::telemetry_header_size + 3;
+
+   constexpr int num_frames = 20;
+   inf::telemetry_stream<256> stream;
+   for (int i = 0; i != num_frames; ++i)
+   {
+      assert(stream.push(make_string(i)));
+      if (i % 4 == 3)
+         flush(stream, uart);   // Wraps around the ring
+   }
+   inf::telemetry_system sys;
+   sys.sample_clock = 99;
+   sys.tier = 1;
+   assert(stream.push(sys));
+   flush(stream, uart);
+
+   // Receive and decode
+   host::telemetry_decoder decoder;
+   std::vector<inf::telemetry_string> strings;
+   std::vector<inf::telemetry_system> systems;
+
+   auto handler =
+      [&](inf::telemetry_frame type, std::uint8_t /*seq*/,
+         std::uint8_t const* payload, std::size_t len)
+      {
+         if (type == inf::telemetry_frame::string)
+         {
+            assert(len == inf::telemetry_string::size);
+            inf::telemetry_string s;
+            s.decode(payload);
+            strings.push_back(s);
+         }
+         else if (type == inf::telemetry_frame::system)
+         {
+            assert(len == inf::telemetry_system::size);
+            inf::telemetry_system s;
+            s.decode(payload);
+            systems.push_back(s);
+         }
+      };
+
+   // Feed in small chunks, to split the frames
+   std::uint8_t buff[7];
+   int n;
+   while ((n = port.read(buff, sizeof(buff), 200)) > 0)
+      decoder.feed(buff, n, handler);
+   ::close(master);
+
+   assert(strings.size() == num_frames - 1);
+   assert(systems.size() == 1);
+   assert(decoder.frames() == num_frames);
+   assert(decoder.lost() == 1);
+   assert(decoder.crc_errors() >= 1);
+   assert(decoder.skipped() >= sizeof(noise));
+
+   for (std::size_t i = 0, k = 0; i != num_frames; ++i)
+   {
+      if (i == 5)
+         continue;   // The corrupted frame
+      auto expected = make_string(i);
+      auto const& s = strings[k++];
+      assert(s.sample_clock == expected.sample_clock);
+      assert(s.channel == expected.channel);
+      assert(s.period == expected.period);
+      assert(std::abs(s.envelope - expected.envelope) < 1.0f / 65535);
+   }
+   assert(systems[0].sample_clock == 99 && systems[0].tier == 1);
+
+   std::puts("telemetry_test: all tests passed");
+   return 0;
+}
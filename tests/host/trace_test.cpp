@@ -0,0 +1,86 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define INFINITY_TRACE
+#define INFINITY_TRACE_SIZE 16
+
+#include <inf/host/trace.hpp>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Event trace test (see trace.hpp and host/trace.hpp). Build with:
+//
+//    g++ -std=c++14 -I inc tests/host/trace_test.cpp
+//
+// We record more events than the ring holds, dump the ring inside a larger
+// block of memory (as read by the debugger), and decode it.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+namespace host = cycfi::infinity::host;
+
+int main()
+{
+   std::vector<host::trace_entry> events;
+
+   // Empty ring
+   {
+      std::vector<std::uint8_t> dump;
+      inf::trace_dump(
+         [&](std::uint8_t const* data, std::size_t size)
+         {
+            dump.assign(data, data + size);
+         });
+      assert(host::decode_trace(dump.data(), dump.size(), events));
+      assert(events.empty());
+   }
+
+   // 20 events, the first 4 are overwritten
+   for (std::uint32_t i = 0; i != 20; ++i)
+      inf::trace(inf::trace_event::edge, i * 100, i % 3, std::uint16_t(i));
+   inf::trace(inf::trace_event::param, 2000, 7, inf::trace_unorm(0.5f));
+
+   // Dump, with some garbage before and after
+   std::vector<std::uint8_t> dump(64, 0xAA);
+   inf::trace_dump(
+      [&](std::uint8_t const* data, std::size_t size)
+      {
+         dump.insert(dump.end(), data, data + size);
+      });
+   dump.insert(dump.end(), 32, 0x55);
+
+   host::trace_dump_info info;
+   assert(host::decode_trace(dump.data(), dump.size(), events, &info));
+   assert(info.offset == 64);
+   assert(info.capacity == 16);
+   assert(info.count == 21);
+   assert(events.size() == 16);
+
+   for (std::size_t i = 0; i != 15; ++i)
+   {
+      auto const& e = events[i];
+      auto n = i + 5;
+      assert(e.index == n);
+      assert(e.event == inf::trace_event::edge);
+      assert(e.sample_clock == n * 100);
+      assert(e.channel == n % 3);
+      assert(e.data == n);
+   }
+
+   auto const& last = events.back();
+   assert(last.event == inf::trace_event::param);
+   assert(last.channel == 7);
+   assert(last.data == 32768);
+   assert(std::strcmp(host::trace_event_name(last.event), "param") == 0);
+
+   // Truncated dump: no trace
+   assert(!host::decode_trace(dump.data(), 64 + 100, events));
+
+   std::puts("trace_test: all tests passed");
+   return 0;
+}
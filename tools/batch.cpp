@@ -0,0 +1,457 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/processor.hpp>
+#include <inf/sample_convert.hpp>
+#include <inf/interpolation.hpp>
+#include <inf/host/capture.hpp>
+#include <inf/host/wav.hpp>
+#include "../app/sustain_processor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Offline batch processor. Runs the sustainer pipeline of app/start.cpp
+// (sustain_processor: agc, pls, sustainer) over recorded takes, one job
+// per file and channel, in parallel.
+//
+// Build (host): g++ -O2 -std=c++14 -DINFINITY_HOST -I inc -I q/q_lib/include
+//                  tools/batch.cpp src/host/capture.cpp -pthread -o batch
+//
+// Usage: batch <file>... [--output <dir>] [--level <l>] [--jobs <n>]
+//              [--json]
+//
+// Inputs:
+//
+//    .wav           16, 24 or 32 bit PCM or 32 bit float, any number of
+//                   channels and any sampling rate. Resampled (linear
+//                   interpolation) to the processing rate (20kHz).
+//    .infr          ADC captures (see capture.hpp), at 80kHz with 4x
+//                   oversampling, like app/start.cpp. Processed exactly
+//                   like the firmware does, block by block, with the
+//                   captured level changes.
+//
+// The files are streamed in fixed-size blocks: memory use does not depend
+// on the file length. With --output, the sustainer output of each channel
+// is written to <dir>/<name>.ch<n>.wav (32 bit float, 20kHz).
+//
+// Prints one record per file and channel, as CSV with a header line
+// (default) or as JSON lines (--json):
+//
+//    file           The input file
+//    channel        The channel
+//    seconds        Duration
+//    in_rms         Input RMS level
+//    out_rms        Sustainer output RMS level
+//    out_peak       Sustainer output peak level
+//    active         Fraction of the time the sustainer is active (non-zero
+//                   output)
+//    onsets         Number of times the sustainer became active after at
+//                   least 20ms of silence
+//    realtime       Processing speed, relative to real time
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+namespace host = cycfi::infinity::host;
+using clock_type = std::chrono::steady_clock;
+using namespace inf::sustain_constants;
+
+// Output frames per block (as in the firmware)
+constexpr std::size_t block_size = buffer_size / 2 / sps_div;
+
+bool json = false;
+
+///////////////////////////////////////////////////////////////////////////////
+// Metrics
+///////////////////////////////////////////////////////////////////////////////
+struct metrics
+{
+   template <typename I>
+   void operator()(I first, I last)
+   {
+      for (auto i = first; i != last; ++i)
+      {
+         auto out = (*i)[0];
+         auto in = (*i)[1];
+         in_sum2 += in * in;
+         out_sum2 += out * out;
+         out_peak = std::max<double>(out_peak, std::abs(out));
+         if (out != 0.0f)
+         {
+            ++active;
+            if (silence >= sps / 50)
+               ++onsets;
+            silence = 0;
+         }
+         else
+         {
+            ++silence;
+         }
+         ++frames;
+      }
+   }
+
+   bool           ok = false;
+   std::size_t    frames = 0;
+   double         in_sum2 = 0;
+   double         out_sum2 = 0;
+   double         out_peak = 0;
+   std::size_t    active = 0;
+   std::size_t    onsets = 0;
+   std::size_t    silence = sps;
+   double         elapsed = 0;
+};
+
+using out_block = std::array<std::array<float, 2>, block_size>;
+
+void write_output(std::unique_ptr<host::wav_writer>& out, out_block const& block, std::size_t n)
+{
+   if (!out)
+      return;
+   std::array<float, block_size> mono;
+   for (std::size_t i = 0; i != n; ++i)
+      mono[i] = block[i][0];
+   out->write(mono.data(), n);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// WAV files
+///////////////////////////////////////////////////////////////////////////////
+
+// Streaming linear interpolation resampler
+class resampler
+{
+public:
+
+   resampler(double from, double to)
+    : _step(from / to)
+   {}
+
+   template <typename F>
+   void operator()(float s, F f)
+   {
+      for (; _pos <= 1.0; _pos += _step)
+         f(inf::linear_interpolate(_prev, s, float(_pos)));
+      _pos -= 1.0;
+      _prev = s;
+   }
+
+private:
+
+   double   _step;
+   double   _pos = 1.0;
+   float    _prev = 0.0f;
+};
+
+void process_wav(
+   std::string const& path, std::size_t channel
+ , std::unique_ptr<host::wav_writer>& out, float level, metrics& m)
+{
+   host::wav_reader wav{ path };
+   auto const channels = wav.channels();
+   inf::processor<inf::sustain_processor<1, 1>> proc;
+   resampler resample{ double(wav.sps()), double(sps) };
+
+   constexpr std::size_t read_size = 1024;
+   std::vector<float> in(read_size * channels);
+   std::array<std::array<float, 1>, block_size> src;
+   out_block block;
+   std::size_t n = 0;
+   std::uint32_t next_update = 0;
+
+   auto flush = [&]()
+   {
+      // The main loop updates the level every 10ms
+      for (; proc._sample_clock >= next_update; next_update += sps / 100)
+         proc.update_level(level);
+
+      proc.process(block.begin(), block.begin() + n, src.begin(),
+         [](float s) { return s; });
+      m(block.begin(), block.begin() + n);
+      write_output(out, block, n);
+      n = 0;
+   };
+
+   while (auto frames = wav.read(in.data(), read_size))
+   {
+      for (std::size_t i = 0; i != frames; ++i)
+      {
+         resample(in[i * channels + channel],
+            [&](float s)
+            {
+               src[n++][0] = s;
+               if (n == block_size)
+                  flush();
+            });
+      }
+   }
+   if (n)
+      flush();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Capture files
+///////////////////////////////////////////////////////////////////////////////
+void process_capture(
+   std::string const& path, std::size_t channel
+ , std::unique_ptr<host::wav_writer>& out, metrics& m)
+{
+   host::capture_file file{ path };
+   auto const& info = file.info();
+   if (info.sampling_rate != adc_clock || info.oversampling != sps_div
+      || info.block_frames % sps_div != 0)
+   {
+      throw std::runtime_error("unsupported capture (expecting 80kHz, 4x oversampling)");
+   }
+
+   using converter = inf::sample_convert<4096, sps_div>;
+   inf::processor<inf::sustain_processor<1>> proc;
+
+   std::vector<std::array<std::uint16_t, 1>> src(info.block_frames);
+   out_block block;
+
+   file.for_each(
+      [&](host::capture_file::chunk const& c)
+      {
+         if (c.type == inf::capture_chunk::param)
+         {
+            if (c.size < sizeof(inf::capture_param))
+               return;
+            inf::capture_param p;
+            std::memcpy(&p, c.data, sizeof(p));
+            if (p.id == param_level)
+               proc.update_level(p.value);
+            return;
+         }
+
+         // Skip empty frames chunks, like capture_file and replay_source
+         if (c.size <= sizeof(std::uint32_t))
+            return;
+
+         // Extract our channel, then process the block like the firmware
+         auto data = reinterpret_cast<std::uint16_t const*>(c.data + sizeof(std::uint32_t));
+         auto frames = (c.size - sizeof(std::uint32_t)) / (info.channels * 2);
+         if (frames > src.size())
+            throw std::runtime_error("malformed capture (oversized frames chunk)");
+         frames -= frames % sps_div;
+         for (std::size_t i = 0; i != frames; ++i)
+            src[i][0] = data[i * info.channels + channel];
+
+         for (std::size_t i = 0; i < frames; i += block_size * sps_div)
+         {
+            auto n = std::min(block_size, (frames - i) / sps_div);
+            proc.process(block.begin(), block.begin() + n, src.begin() + i,
+               [](std::uint32_t sample) { return converter::to_float(sample); });
+            m(block.begin(), block.begin() + n);
+            write_output(out, block, n);
+         }
+      });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Jobs
+///////////////////////////////////////////////////////////////////////////////
+struct job
+{
+   std::string    path;
+   std::size_t    channel;
+   bool           capture;
+};
+
+bool ends_with(std::string const& s, std::string const& suffix)
+{
+   return s.size() >= suffix.size()
+      && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::string stem(std::string const& path)
+{
+   auto slash = path.find_last_of('/');
+   auto name = (slash == std::string::npos)? path : path.substr(slash + 1);
+   return name.substr(0, name.find_last_of('.'));
+}
+
+metrics run(job const& j, std::string const& output, float level)
+{
+   metrics m;
+   try
+   {
+      auto start = clock_type::now();
+      std::unique_ptr<host::wav_writer> out;
+      if (!output.empty())
+      {
+         auto name = output + "/" + stem(j.path) + ".ch" + std::to_string(j.channel) + ".wav";
+         out.reset(new host::wav_writer(name, 1, sps));
+      }
+
+      if (j.capture)
+         process_capture(j.path, j.channel, out, m);
+      else
+         process_wav(j.path, j.channel, out, level, m);
+
+      std::chrono::duration<double> elapsed = clock_type::now() - start;
+      m.elapsed = elapsed.count();
+      m.ok = true;
+   }
+   catch (std::exception const& e)
+   {
+      std::fprintf(stderr, "Error: %s: %s\n", j.path.c_str(), e.what());
+   }
+   return m;
+}
+
+// Escapes s for a JSON string
+std::string json_escape(std::string const& s)
+{
+   std::string result;
+   for (auto c : s)
+   {
+      if (c == '"' || c == '\\')
+      {
+         result += '\\';
+         result += c;
+      }
+      else if (static_cast<unsigned char>(c) < 0x20)
+      {
+         char code[8];
+         std::snprintf(code, sizeof(code), "\\u%04x", unsigned(c));
+         result += code;
+      }
+      else
+      {
+         result += c;
+      }
+   }
+   return result;
+}
+
+void report(job const& j, metrics const& m)
+{
+   double seconds = double(m.frames) / sps;
+   double in_rms = m.frames? std::sqrt(m.in_sum2 / m.frames) : 0;
+   double out_rms = m.frames? std::sqrt(m.out_sum2 / m.frames) : 0;
+   double active = m.frames? double(m.active) / m.frames : 0;
+   double realtime = (m.elapsed > 0)? seconds / m.elapsed : 0;
+
+   if (json)
+   {
+      std::printf(
+         "{\"file\":\"%s\",\"channel\":%zu,\"seconds\":%.2f,\"in_rms\":%.4f,"
+         "\"out_rms\":%.4f,\"out_peak\":%.4f,\"active\":%.3f,\"onsets\":%zu,"
+         "\"realtime\":%.1f}\n",
+         json_escape(j.path).c_str(), j.channel, seconds, in_rms, out_rms,
+         m.out_peak, active, m.onsets, realtime);
+   }
+   else
+   {
+      std::printf("%s,%zu,%.2f,%.4f,%.4f,%.4f,%.3f,%zu,%.1f\n",
+         j.path.c_str(), j.channel, seconds, in_rms, out_rms, m.out_peak,
+         active, m.onsets, realtime);
+   }
+}
+
+[[noreturn]] void usage(char const* name)
+{
+   std::fprintf(stderr,
+      "Usage: %s <file>... [--output <dir>] [--level <l>] [--jobs <n>]"
+      " [--json]\n", name);
+   std::exit(EXIT_FAILURE);
+}
+
+int main(int argc, char const* argv[])
+{
+   std::vector<std::string> files;
+   std::string output;
+   float level = 0.0625f;
+   std::size_t jobs = std::max(std::thread::hardware_concurrency(), 1u);
+
+   for (int i = 1; i < argc; ++i)
+   {
+      std::string opt = argv[i];
+      if (opt == "--json")
+      {
+         json = true;
+         continue;
+      }
+      if (opt.compare(0, 2, "--") != 0)
+      {
+         files.push_back(opt);
+         continue;
+      }
+      if (i+1 == argc)
+         usage(argv[0]);
+      std::string arg = argv[++i];
+      if (opt == "--output")
+         output = arg;
+      else if (opt == "--level")
+         level = std::stof(arg);
+      else if (opt == "--jobs")
+         jobs = std::max<std::size_t>(std::stoul(arg), 1);
+      else
+         usage(argv[0]);
+   }
+
+   if (files.empty())
+      usage(argv[0]);
+
+   // One job per file and channel
+   std::vector<job> work;
+   int status = 0;
+   for (auto const& path : files)
+   {
+      try
+      {
+         bool capture = ends_with(path, ".infr");
+         std::size_t channels = capture?
+            host::capture_file{ path }.info().channels :
+            host::wav_reader{ path }.channels();
+         for (std::size_t c = 0; c != channels; ++c)
+            work.push_back({ path, c, capture });
+      }
+      catch (std::exception const& e)
+      {
+         std::fprintf(stderr, "Error: %s\n", e.what());
+         status = EXIT_FAILURE;
+      }
+   }
+
+   // Each thread takes the next job until there are no more
+   std::vector<metrics> results(work.size());
+   std::atomic<std::size_t> next{ 0 };
+   auto worker = [&]
+   {
+      for (auto i = next++; i < work.size(); i = next++)
+         results[i] = run(work[i], output, level);
+   };
+
+   std::vector<std::thread> threads;
+   for (std::size_t i = 1; i < std::min(jobs, work.size()); ++i)
+      threads.emplace_back(worker);
+   worker();
+   for (auto& t : threads)
+      t.join();
+
+   if (!json)
+      std::puts("file,channel,seconds,in_rms,out_rms,out_peak,active,onsets,realtime");
+   for (std::size_t i = 0; i != work.size(); ++i)
+   {
+      if (results[i].ok)
+         report(work[i], results[i]);
+      else
+         status = EXIT_FAILURE;
+   }
+   return status;
+}
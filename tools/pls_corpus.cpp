@@ -0,0 +1,259 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/host/corpus_eval.hpp>
+#include "../app/sustainer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Synthetic plucked-string corpus generator and pls evaluation harness
+// (see host/corpus.hpp and host/corpus_eval.hpp).
+//
+// Build (host): g++ -O2 -std=c++14 -DINFINITY_HOST -I inc -I q/q_lib/include
+//                  tools/pls_corpus.cpp -pthread -o pls_corpus
+//
+// Usage: pls_corpus generate <dir> [--count <n>] [--seed <s>]
+//                  [--seconds <s>]
+//        pls_corpus eval <file>... [--target pls | sustainer]
+//                  [--jobs <n>] [--json]
+//
+// generate writes <dir>/corpus_<n>.infc, each file generated from seed + n.
+//
+// eval runs the target over the corpus files, in parallel (one file per
+// job), and prints one record per file plus a "total" record, as CSV with
+// a header line (default) or as JSON lines (--json):
+//
+//    file           The corpus file
+//    notes          Number of notes
+//    locked         Fraction of the notes where the target locked
+//    lock_ms        Mean lock time (ms), from the note onset until the
+//                   output period stays within 3% of the true period for
+//                   at least 5 cycles
+//    lock_p90_ms    90th percentile lock time (ms)
+//    octave_errors  Fraction of the output cycles, after the onset, whose
+//                   period is off by one or more octaves
+//    phase_offset   Mean phase of the output relative to the input
+//                   (cycles), at the output's rising zero crossings after
+//                   lock. The input phase is taken one latency period
+//                   later, since the pls advances its output by the
+//                   latency.
+//    phase_jitter   Circular standard deviation of the phase (cycles)
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+namespace host = cycfi::infinity::host;
+namespace q = cycfi::q;
+
+constexpr std::uint32_t sps = 20000;
+constexpr std::uint32_t latency = 256;
+
+bool json = false;
+
+///////////////////////////////////////////////////////////////////////////////
+// Targets
+///////////////////////////////////////////////////////////////////////////////
+using sin_synth = decltype(q::sin(0.0, sps, 0.0));
+
+struct pls_target
+{
+   float operator()(float s) { return _pls(s, _clock++); }
+
+   sin_synth _synth = q::sin(0.0, sps, q::pi/4);
+   inf::pls<sin_synth, sps, latency> _pls = { _synth };
+   std::uint32_t _clock = 0;
+};
+
+struct sustainer_target
+{
+   float operator()(float s)
+   {
+      // Update the level at 100Hz (see level_pid_config)
+      if (_clock % (sps / 100) == 0)
+         _sustainer.update_level(0.5f, 1.0f);
+      return _sustainer(s, _clock++);
+   }
+
+   inf::sustainer<sps, latency> _sustainer;
+   std::uint32_t _clock = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Evaluation (see host/corpus_eval.hpp)
+///////////////////////////////////////////////////////////////////////////////
+template <typename Target>
+host::corpus_result evaluate(host::corpus const& c)
+{
+   Target target;
+   return host::evaluate(c, target, latency);
+}
+
+void report(char const* file, host::corpus_result const& r)
+{
+   auto s = host::score(r);
+
+   if (json)
+   {
+      std::printf(
+         "{\"file\":\"%s\",\"notes\":%zu,\"locked\":%.3f,\"lock_ms\":%.1f,"
+         "\"lock_p90_ms\":%.1f,\"octave_errors\":%.4f,"
+         "\"phase_offset\":%.4f,\"phase_jitter\":%.4f}\n",
+         file, r.notes, s.locked, s.lock_ms, s.lock_p90_ms, s.octave_errors,
+         s.phase_offset, s.phase_jitter);
+   }
+   else
+   {
+      std::printf("%s,%zu,%.3f,%.1f,%.1f,%.4f,%.4f,%.4f\n",
+         file, r.notes, s.locked, s.lock_ms, s.lock_p90_ms, s.octave_errors,
+         s.phase_offset, s.phase_jitter);
+   }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Commands
+///////////////////////////////////////////////////////////////////////////////
+[[noreturn]] void usage(char const* name)
+{
+   std::fprintf(stderr,
+      "Usage: %s generate <dir> [--count <n>] [--seed <s>] [--seconds <s>]\n"
+      "       %s eval <file>... [--target pls | sustainer] [--jobs <n>]"
+      " [--json]\n", name, name);
+   std::exit(EXIT_FAILURE);
+}
+
+int generate(int argc, char const* argv[])
+{
+   if (argc < 3)
+      usage(argv[0]);
+
+   std::string dir = argv[2];
+   std::size_t count = 16;
+   std::uint32_t seed = 1;
+   double seconds = 30;
+
+   for (int i = 3; i < argc; ++i)
+   {
+      std::string opt = argv[i];
+      if (i+1 == argc)
+         usage(argv[0]);
+      std::string arg = argv[++i];
+      if (opt == "--count")
+         count = std::stoul(arg);
+      else if (opt == "--seed")
+         seed = std::stoul(arg);
+      else if (opt == "--seconds")
+         seconds = std::stod(arg);
+      else
+         usage(argv[0]);
+   }
+
+   for (std::size_t i = 0; i != count; ++i)
+   {
+      auto path = dir + "/corpus_" + std::to_string(i) + ".infc";
+      if (!host::write_corpus(path, host::generate_corpus(seed + i, sps, seconds)))
+      {
+         std::fprintf(stderr, "Error: can't write %s\n", path.c_str());
+         return EXIT_FAILURE;
+      }
+   }
+   return 0;
+}
+
+int eval(int argc, char const* argv[])
+{
+   std::vector<std::string> files;
+   std::string target = "pls";
+   std::size_t jobs = std::max(std::thread::hardware_concurrency(), 1u);
+
+   for (int i = 2; i < argc; ++i)
+   {
+      std::string opt = argv[i];
+      if (opt == "--json")
+      {
+         json = true;
+         continue;
+      }
+      if (opt.compare(0, 2, "--") != 0)
+      {
+         files.push_back(opt);
+         continue;
+      }
+      if (i+1 == argc)
+         usage(argv[0]);
+      std::string arg = argv[++i];
+      if (opt == "--target")
+         target = arg;
+      else if (opt == "--jobs")
+         jobs = std::max<std::size_t>(std::stoul(arg), 1);
+      else
+         usage(argv[0]);
+   }
+
+   if (files.empty() || (target != "pls" && target != "sustainer"))
+      usage(argv[0]);
+
+   // Each job takes the next file until there are no more
+   auto f = (target == "pls")?
+      &evaluate<pls_target> : &evaluate<sustainer_target>;
+   std::vector<host::corpus_result> results(files.size());
+   std::atomic<std::size_t> next{ 0 };
+
+   auto job = [&]
+   {
+      for (auto i = next++; i < files.size(); i = next++)
+      {
+         host::corpus c;
+         if (host::read_corpus(files[i], c) && c.sps == sps)
+            results[i] = f(c);
+      }
+   };
+
+   std::vector<std::thread> threads;
+   for (std::size_t i = 1; i < std::min(jobs, files.size()); ++i)
+      threads.emplace_back(job);
+   job();
+   for (auto& t : threads)
+      t.join();
+
+   if (!json)
+      std::puts("file,notes,locked,lock_ms,lock_p90_ms,octave_errors,phase_offset,phase_jitter");
+
+   host::corpus_result total;
+   int status = 0;
+   for (std::size_t i = 0; i != files.size(); ++i)
+   {
+      if (!results[i].ok)
+      {
+         std::fprintf(stderr, "Error: can't read %s\n", files[i].c_str());
+         status = EXIT_FAILURE;
+         continue;
+      }
+      report(files[i].c_str(), results[i]);
+      total += results[i];
+   }
+   report("total", total);
+   return status;
+}
+
+int main(int argc, char const* argv[])
+{
+   if (argc < 2)
+      usage(argv[0]);
+
+   std::string cmd = argv[1];
+   if (cmd == "generate")
+      return generate(argc, argv);
+   else if (cmd == "eval")
+      return eval(argc, argv);
+   usage(argv[0]);
+}
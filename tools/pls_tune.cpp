@@ -0,0 +1,410 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/host/corpus_eval.hpp>
+#include <inf/host/string_model.hpp>
+#include "../app/pls.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Parallel parameter-sweep tuner for the pls constants (see tuning.hpp),
+// scored against a corpus (see host/corpus.hpp and host/corpus_eval.hpp).
+//
+// Build (host): g++ -O2 -std=c++14 -DINFINITY_HOST -I inc -I q/q_lib/include
+//                  tools/pls_tune.cpp -pthread -o pls_tune
+//
+// Usage: pls_tune <file>... [--param <name>=<values>]... [--random <n>]
+//                  [--seed <s>] [--jobs <n>] [--all] [--json]
+//
+// <values> is either a comma separated list (e.g. peak_drop=0.7,0.8,0.9)
+// or a range, lo:hi. With --random <n>, n candidates are sampled uniformly
+// from the ranges (a list is sampled by picking one of its values).
+// Otherwise, all the combinations of the lists are evaluated (grid
+// search; a range is taken as its two end points). Parameters that are
+// not given keep their defaults. The parameter names are the pls_tuning
+// fields:
+//
+//    agc_max_gain, agc_low_threshold, agc_high_threshold, peak_hysteresis,
+//    peak_drop, dead_zone, period_window, period_lp, shift_lp
+//
+// period_window values must be at least 1.
+//
+// The corpus files are loaded once. The candidates are evaluated in
+// parallel, one candidate per job, each over all the corpus files. Each
+// candidate is scored on three objectives, all minimized:
+//
+//    lock_ms        Mean lock time (ms). Notes that do not lock count as
+//                   unlocked_ms.
+//    octave_errors  Fraction of the output cycles off by one or more
+//                   octaves
+//    phase_jitter   Circular standard deviation of the phase (cycles)
+//
+// The Pareto front (the candidates not dominated by any other candidate)
+// is printed, sorted by lock_ms, as CSV with a header line (default) or as
+// JSON lines (--json). With --all, all the candidates are printed, with a
+// "pareto" field. Each record has the candidate's parameters followed by:
+//
+//    locked         Fraction of the notes where the pls locked
+//    lock_ms        Score, as above
+//    octave_errors  Score, as above
+//    phase_jitter   Score, as above
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+namespace host = cycfi::infinity::host;
+namespace q = cycfi::q;
+
+constexpr std::uint32_t sps = 20000;
+constexpr std::uint32_t latency = 256;
+constexpr double unlocked_ms = 1000;
+
+///////////////////////////////////////////////////////////////////////////////
+// Parameters
+///////////////////////////////////////////////////////////////////////////////
+struct param
+{
+   char const* name;
+   std::function<double(inf::pls_tuning const&)> get;
+   std::function<void(inf::pls_tuning&, double)> set;
+};
+
+#define INFINITY_TUNING_PARAM(name)                                           \
+   param{                                                                     \
+      #name                                                                   \
+    , [](inf::pls_tuning const& t) -> double { return t.name; }               \
+    , [](inf::pls_tuning& t, double v) { t.name = decltype(t.name)(v); }      \
+   }                                                                          \
+   /***/
+
+std::vector<param> const params =
+{
+   INFINITY_TUNING_PARAM(agc_max_gain)
+ , INFINITY_TUNING_PARAM(agc_low_threshold)
+ , INFINITY_TUNING_PARAM(agc_high_threshold)
+ , INFINITY_TUNING_PARAM(peak_hysteresis)
+ , INFINITY_TUNING_PARAM(peak_drop)
+ , INFINITY_TUNING_PARAM(dead_zone)
+ , INFINITY_TUNING_PARAM(period_window)
+ , INFINITY_TUNING_PARAM(period_lp)
+ , INFINITY_TUNING_PARAM(shift_lp)
+};
+
+struct sweep
+{
+   std::size_t          index;   // into params
+   bool                 range;   // lo:hi, otherwise a list
+   std::vector<double>  values;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Evaluation
+///////////////////////////////////////////////////////////////////////////////
+using sin_synth = decltype(q::sin(0.0, sps, 0.0));
+
+struct pls_target
+{
+   float operator()(float s) { return _pls(s, _clock++); }
+
+   sin_synth _synth = q::sin(0.0, sps, q::pi/4);
+   inf::pls<sin_synth, sps, latency> _pls = { _synth };
+   std::uint32_t _clock = 0;
+};
+
+struct candidate
+{
+   inf::pls_tuning   tuning;
+   double            locked = 0;
+   double            lock_ms = 0;
+   double            octave_errors = 0;
+   double            phase_jitter = 0;
+   bool              pareto = false;
+};
+
+void evaluate(candidate& c, std::vector<host::corpus> const& corpus)
+{
+   // The pls reads its constants from this thread's tuning()
+   inf::tuning() = c.tuning;
+
+   host::corpus_result r;
+   for (auto const& file : corpus)
+   {
+      pls_target target;
+      r += host::evaluate(file, target, latency);
+   }
+
+   auto s = host::score(r);
+   c.locked = s.locked;
+   c.lock_ms = s.locked * s.lock_ms + (1 - s.locked) * unlocked_ms;
+   c.octave_errors = s.octave_errors;
+   c.phase_jitter = s.phase_jitter;
+}
+
+bool dominates(candidate const& a, candidate const& b)
+{
+   return a.lock_ms <= b.lock_ms
+      && a.octave_errors <= b.octave_errors
+      && a.phase_jitter <= b.phase_jitter
+      && (a.lock_ms < b.lock_ms
+         || a.octave_errors < b.octave_errors
+         || a.phase_jitter < b.phase_jitter);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Candidates
+///////////////////////////////////////////////////////////////////////////////
+std::vector<candidate> grid_search(std::vector<sweep> const& sweeps)
+{
+   std::vector<candidate> result(1);
+   for (auto const& s : sweeps)
+   {
+      std::vector<candidate> next;
+      for (auto const& c : result)
+      {
+         for (auto v : s.values)
+         {
+            next.push_back(c);
+            params[s.index].set(next.back().tuning, v);
+         }
+      }
+      result.swap(next);
+   }
+   return result;
+}
+
+std::vector<candidate> random_search(
+   std::vector<sweep> const& sweeps, std::size_t n, std::uint32_t seed)
+{
+   host::random rand{ seed };
+   std::vector<candidate> result(n);
+   for (auto& c : result)
+   {
+      for (auto const& s : sweeps)
+      {
+         double v;
+         if (s.range)
+            v = rand(s.values[0], s.values[1]);
+         else
+            v = s.values[std::min<std::size_t>(
+               rand(0, s.values.size()), s.values.size() - 1)];
+         params[s.index].set(c.tuning, v);
+      }
+   }
+   return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Output
+///////////////////////////////////////////////////////////////////////////////
+bool json = false;
+bool all = false;
+
+void header()
+{
+   for (auto const& p : params)
+      std::printf("%s,", p.name);
+   std::puts(all?
+      "locked,lock_ms,octave_errors,phase_jitter,pareto" :
+      "locked,lock_ms,octave_errors,phase_jitter");
+}
+
+void report(candidate const& c)
+{
+   if (json)
+   {
+      std::printf("{");
+      for (auto const& p : params)
+         std::printf("\"%s\":%g,", p.name, p.get(c.tuning));
+      std::printf(
+         "\"locked\":%.3f,\"lock_ms\":%.1f,\"octave_errors\":%.4f,"
+         "\"phase_jitter\":%.4f",
+         c.locked, c.lock_ms, c.octave_errors, c.phase_jitter);
+      if (all)
+         std::printf(",\"pareto\":%s", c.pareto? "true" : "false");
+      std::puts("}");
+   }
+   else
+   {
+      for (auto const& p : params)
+         std::printf("%g,", p.get(c.tuning));
+      std::printf("%.3f,%.1f,%.4f,%.4f",
+         c.locked, c.lock_ms, c.octave_errors, c.phase_jitter);
+      if (all)
+         std::printf(",%d", c.pareto);
+      std::puts("");
+   }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+///////////////////////////////////////////////////////////////////////////////
+[[noreturn]] void usage(char const* name)
+{
+   std::fprintf(stderr,
+      "Usage: %s <file>... [--param <name>=<v1,v2,...> | <name>=<lo:hi>]...\n"
+      "          [--random <n>] [--seed <s>] [--jobs <n>] [--all] [--json]\n"
+      "Parameters:", name);
+   for (auto const& p : params)
+      std::fprintf(stderr, " %s", p.name);
+   std::fprintf(stderr, "\n");
+   std::exit(EXIT_FAILURE);
+}
+
+bool parse_sweep(std::string const& arg, sweep& s)
+{
+   auto eq = arg.find('=');
+   if (eq == std::string::npos)
+      return false;
+
+   auto name = arg.substr(0, eq);
+   auto p = std::find_if(params.begin(), params.end(),
+      [&](param const& p) { return name == p.name; });
+   if (p == params.end())
+      return false;
+   s.index = p - params.begin();
+
+   auto values = arg.substr(eq + 1);
+   auto colon = values.find(':');
+   s.range = colon != std::string::npos;
+   try
+   {
+      if (s.range)
+      {
+         s.values = {
+            std::stod(values.substr(0, colon))
+          , std::stod(values.substr(colon + 1))
+         };
+      }
+      else
+      {
+         for (std::size_t pos = 0; pos <= values.size();)
+         {
+            auto comma = std::min(values.find(',', pos), values.size());
+            s.values.push_back(std::stod(values.substr(pos, comma - pos)));
+            pos = comma + 1;
+         }
+      }
+   }
+   catch (std::exception const&)
+   {
+      return false;
+   }
+
+   // The period_detector divides the mean period by period_window (see
+   // period_detector.hpp)
+   if (name == "period_window")
+   {
+      for (auto v : s.values)
+         if (v < 1)
+            return false;
+   }
+   return !s.values.empty();
+}
+
+int main(int argc, char const* argv[])
+{
+   std::vector<std::string> files;
+   std::vector<sweep> sweeps;
+   std::size_t random_count = 0;
+   std::uint32_t seed = 1;
+   std::size_t jobs = std::max(std::thread::hardware_concurrency(), 1u);
+
+   for (int i = 1; i < argc; ++i)
+   {
+      std::string opt = argv[i];
+      if (opt == "--json")
+      {
+         json = true;
+         continue;
+      }
+      if (opt == "--all")
+      {
+         all = true;
+         continue;
+      }
+      if (opt.compare(0, 2, "--") != 0)
+      {
+         files.push_back(opt);
+         continue;
+      }
+      if (i+1 == argc)
+         usage(argv[0]);
+      std::string arg = argv[++i];
+      if (opt == "--param")
+      {
+         sweep s;
+         if (!parse_sweep(arg, s))
+            usage(argv[0]);
+         sweeps.push_back(s);
+      }
+      else if (opt == "--random")
+         random_count = std::stoul(arg);
+      else if (opt == "--seed")
+         seed = std::stoul(arg);
+      else if (opt == "--jobs")
+         jobs = std::max<std::size_t>(std::stoul(arg), 1);
+      else
+         usage(argv[0]);
+   }
+
+   if (files.empty())
+      usage(argv[0]);
+
+   // Load the corpus once, shared (read only) by all jobs
+   std::vector<host::corpus> corpus(files.size());
+   for (std::size_t i = 0; i != files.size(); ++i)
+   {
+      if (!host::read_corpus(files[i], corpus[i]) || corpus[i].sps != sps)
+      {
+         std::fprintf(stderr, "Error: can't read %s\n", files[i].c_str());
+         return EXIT_FAILURE;
+      }
+   }
+
+   auto candidates = random_count?
+      random_search(sweeps, random_count, seed) : grid_search(sweeps);
+
+   // Each job takes the next candidate until there are no more
+   std::atomic<std::size_t> next{ 0 };
+   auto job = [&]
+   {
+      for (auto i = next++; i < candidates.size(); i = next++)
+         evaluate(candidates[i], corpus);
+   };
+
+   std::vector<std::thread> threads;
+   for (std::size_t i = 1; i < std::min(jobs, candidates.size()); ++i)
+      threads.emplace_back(job);
+   job();
+   for (auto& t : threads)
+      t.join();
+
+   // Pareto front
+   for (auto& c : candidates)
+   {
+      c.pareto = std::none_of(candidates.begin(), candidates.end(),
+         [&](candidate const& other) { return dominates(other, c); });
+   }
+
+   std::stable_sort(candidates.begin(), candidates.end(),
+      [](candidate const& a, candidate const& b) { return a.lock_ms < b.lock_ms; });
+
+   if (!json)
+      header();
+   for (auto const& c : candidates)
+   {
+      if (all || c.pareto)
+         report(c);
+   }
+   return 0;
+}
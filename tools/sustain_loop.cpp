@@ -0,0 +1,336 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/host/string_model.hpp>
+#include "../app/sustainer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Closed-loop sustain simulation. The sustainer drives a simulated string
+// and listens to it through a pickup:
+//
+//    sustainer --> latency --> driver --> string --> pickup (ADC) --+
+//        ^                                                          |
+//        +----------------------------------------------------------+
+//
+//    latency        A delay line (samples), for the ADC/DAC buffering and
+//                   processing delays. Note that the sustainer compensates
+//                   for a fixed latency (see pls); sweeping the actual
+//                   latency shows the effect of a mismatch.
+//    driver         gain and a one-pole low-pass (the coil inductance)
+//    string         A damped modal resonator (see host::string_resonator)
+//    pickup         The string displacement at the pickup position,
+//                   clipped to the ADC range (-1 to 1)
+//
+// The string is plucked at t=0 and the sustainer takes over as it decays.
+// Each gain and latency combination is simulated in parallel.
+//
+// Build (host): g++ -O2 -std=c++14 -DINFINITY_HOST -I inc -I q/q_lib/include
+//                  tools/sustain_loop.cpp -pthread -o sustain_loop
+//
+// Usage: sustain_loop [--gains <g,...>] [--latencies <n,...>] [--f0 <hz>]
+//                     [--level <l>] [--seconds <s>] [--jobs <n>] [--json]
+//
+// Prints one record per gain and latency, as CSV with a header line
+// (default) or as JSON lines (--json). The measurements are taken over the
+// last 2 seconds (the steady state):
+//
+//    gain           Driver gain
+//    latency        Loop latency (samples)
+//    amplitude      RMS pickup level
+//    amplitude_cv   Coefficient of variation of the per-cycle pickup peak
+//                   (amplitude hunting)
+//    freq_cents     Mean frequency of the sustainer output relative to the
+//                   string's fundamental (cents)
+//    jitter_cents   Standard deviation of the per-cycle output frequency
+//                   (cents)
+//    locked         Fraction of the output cycles within 3% of the
+//                   fundamental
+//    runaway        1 if the pickup clipped for more than 1% of the
+//                   samples
+//    cpu_us         Sustainer CPU time per simulated second (microseconds)
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+namespace host = cycfi::infinity::host;
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::uint32_t sps = 20000;
+constexpr std::uint32_t latency = 256;
+constexpr double driver_cutoff = 1000.0;  // Hz
+constexpr double window = 2.0;            // seconds
+
+bool json = false;
+
+struct params
+{
+   double         gain;
+   std::size_t    latency;
+   double         f0;
+   double         level;
+   double         seconds;
+};
+
+struct result
+{
+   double         amplitude = 0;
+   double         amplitude_cv = 0;
+   double         freq_cents = 0;
+   double         jitter_cents = 0;
+   double         locked = 0;
+   bool           runaway = false;
+   double         cpu_us = 0;
+};
+
+// Rising zero crossings, linearly interpolated
+struct crossing
+{
+   bool operator()(double s, std::size_t i)
+   {
+      bool cross = _prev < 0 && s > 0;
+      if (cross)
+      {
+         auto pos = (i - 1) + (-_prev / (s - _prev));
+         period = (_pos >= 0)? pos - _pos : 0;
+         _pos = pos;
+      }
+      _prev = s;
+      return cross;
+   }
+
+   double period = 0;
+   double _prev = 0;
+   double _pos = -1;
+};
+
+double mean(std::vector<double> const& v)
+{
+   double sum = 0;
+   for (auto x : v)
+      sum += x;
+   return v.empty()? 0 : sum / v.size();
+}
+
+double stddev(std::vector<double> const& v)
+{
+   auto m = mean(v);
+   double sum = 0;
+   for (auto x : v)
+      sum += (x - m) * (x - m);
+   return v.empty()? 0 : std::sqrt(sum / v.size());
+}
+
+result simulate(params const& p)
+{
+   host::string_resonator::config cfg;
+   cfg.f0 = p.f0;
+   host::string_resonator str{ sps, cfg };
+   str.pluck(0.5, 0.2);
+
+   inf::sustainer<sps, latency> sustainer;
+   std::vector<double> delay(p.latency + 1, 0.0);
+   std::size_t delay_pos = 0;
+   double const lp_a = 1.0 - std::exp(-2.0 * 3.14159265358979323846 * driver_cutoff / sps);
+   double force = 0;
+   double pickup = 0;
+
+   auto const n = std::size_t(p.seconds * sps);
+   auto const start = n - std::min(n, std::size_t(window * sps));
+   std::vector<float> inputs(n);
+
+   crossing pickup_cross, out_cross;
+   double sum2 = 0;
+   double peak = 0;
+   std::size_t clipped = 0;
+   std::vector<double> peaks;
+   std::vector<double> cents;
+   std::size_t locked = 0;
+
+   for (std::size_t i = 0; i != n; ++i)
+   {
+      // Pickup (ADC)
+      auto in = float(std::max(std::min(pickup, 1.0), -1.0));
+      inputs[i] = in;
+
+      // Sustainer
+      if (i % (sps / 100) == 0)
+         sustainer.update_level(p.level, 1.0f);
+      double out = sustainer(in, i);
+
+      // Latency and driver
+      delay[delay_pos] = out;
+      delay_pos = (delay_pos + 1) % delay.size();
+      force += lp_a * (p.gain * delay[delay_pos] - force);
+
+      // String
+      pickup = str(force);
+
+      // Measure the steady state
+      if (i >= start)
+      {
+         sum2 += in * in;
+         peak = std::max(peak, double(std::abs(in)));
+         if (std::abs(pickup) >= 1.0)
+            ++clipped;
+         if (pickup_cross(in, i))
+         {
+            if (pickup_cross.period)
+               peaks.push_back(peak);
+            peak = 0;
+         }
+         if (out_cross(out, i) && out_cross.period)
+         {
+            auto ratio = sps / (out_cross.period * str.f0());
+            cents.push_back(1200 * std::log2(ratio));
+            if (std::abs(ratio - 1.0) < 0.03)
+               ++locked;
+         }
+      }
+   }
+
+   result r;
+   auto samples = n - start;
+   if (samples)
+   {
+      r.amplitude = std::sqrt(sum2 / samples);
+      r.runaway = clipped > samples / 100;
+   }
+   auto m = mean(peaks);
+   r.amplitude_cv = (m > 0)? stddev(peaks) / m : 0;
+   r.freq_cents = mean(cents);
+   r.jitter_cents = stddev(cents);
+   r.locked = double(locked) / std::max<std::size_t>(cents.size(), 1);
+
+   // CPU cost: replay the recorded input through a fresh sustainer, open
+   // loop, so the timer doesn't include the string model.
+   inf::sustainer<sps, latency> replay;
+   volatile float sink = 0;
+   auto t0 = clock_type::now();
+   for (std::size_t i = 0; i != n; ++i)
+   {
+      if (i % (sps / 100) == 0)
+         replay.update_level(p.level, 1.0f);
+      sink = replay(inputs[i], i);
+   }
+   std::chrono::duration<double, std::micro> elapsed = clock_type::now() - t0;
+   (void) sink;
+   r.cpu_us = elapsed.count() / p.seconds;
+   return r;
+}
+
+void report(params const& p, result const& r)
+{
+   if (json)
+   {
+      std::printf(
+         "{\"gain\":%g,\"latency\":%zu,\"amplitude\":%.4f,"
+         "\"amplitude_cv\":%.4f,\"freq_cents\":%.2f,\"jitter_cents\":%.2f,"
+         "\"locked\":%.3f,\"runaway\":%d,\"cpu_us\":%.1f}\n",
+         p.gain, p.latency, r.amplitude, r.amplitude_cv, r.freq_cents,
+         r.jitter_cents, r.locked, r.runaway, r.cpu_us);
+   }
+   else
+   {
+      std::printf("%g,%zu,%.4f,%.4f,%.2f,%.2f,%.3f,%d,%.1f\n",
+         p.gain, p.latency, r.amplitude, r.amplitude_cv, r.freq_cents,
+         r.jitter_cents, r.locked, r.runaway, r.cpu_us);
+   }
+}
+
+template <typename T, typename F>
+std::vector<T> parse_list(std::string const& arg, F f)
+{
+   std::vector<T> list;
+   std::size_t pos = 0;
+   while (pos <= arg.size())
+   {
+      auto comma = std::min(arg.find(',', pos), arg.size());
+      list.push_back(f(arg.substr(pos, comma - pos)));
+      pos = comma + 1;
+   }
+   return list;
+}
+
+[[noreturn]] void usage(char const* name)
+{
+   std::fprintf(stderr,
+      "Usage: %s [--gains <g,...>] [--latencies <n,...>] [--f0 <hz>]"
+      " [--level <l>] [--seconds <s>] [--jobs <n>] [--json]\n", name);
+   std::exit(EXIT_FAILURE);
+}
+
+int main(int argc, char const* argv[])
+{
+   std::vector<double> gains = { 0.25, 0.5, 1, 2, 4 };
+   std::vector<std::size_t> latencies = { 0, 128, 256, 384, 512 };
+   double f0 = 110.0;
+   double level = 0.3;
+   double seconds = 10.0;
+   std::size_t jobs = std::max(std::thread::hardware_concurrency(), 1u);
+
+   for (int i = 1; i < argc; ++i)
+   {
+      std::string opt = argv[i];
+      if (opt == "--json")
+      {
+         json = true;
+         continue;
+      }
+      if (i+1 == argc)
+         usage(argv[0]);
+      std::string arg = argv[++i];
+      if (opt == "--gains")
+         gains = parse_list<double>(arg, [](std::string const& s){ return std::stod(s); });
+      else if (opt == "--latencies")
+         latencies = parse_list<std::size_t>(arg, [](std::string const& s){ return std::stoul(s); });
+      else if (opt == "--f0")
+         f0 = std::stod(arg);
+      else if (opt == "--level")
+         level = std::stod(arg);
+      else if (opt == "--seconds")
+         seconds = std::stod(arg);
+      else if (opt == "--jobs")
+         jobs = std::max<std::size_t>(std::stoul(arg), 1);
+      else
+         usage(argv[0]);
+   }
+
+   std::vector<params> runs;
+   for (auto g : gains)
+      for (auto l : latencies)
+         runs.push_back({ g, l, f0, level, seconds });
+
+   // Each job takes the next run until there are no more
+   std::vector<result> results(runs.size());
+   std::atomic<std::size_t> next{ 0 };
+   auto job = [&]
+   {
+      for (auto i = next++; i < runs.size(); i = next++)
+         results[i] = simulate(runs[i]);
+   };
+
+   std::vector<std::thread> threads;
+   for (std::size_t i = 1; i < std::min(jobs, runs.size()); ++i)
+      threads.emplace_back(job);
+   job();
+   for (auto& t : threads)
+      t.join();
+
+   if (!json)
+      std::puts("gain,latency,amplitude,amplitude_cv,freq_cents,jitter_cents,locked,runaway,cpu_us");
+   for (std::size_t i = 0; i != runs.size(); ++i)
+      report(runs[i], results[i]);
+   return 0;
+}
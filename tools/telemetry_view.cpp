@@ -0,0 +1,204 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/host/telemetry.hpp>
+#include <inf/host/serial.hpp>
+
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+///////////////////////////////////////////////////////////////////////////////
+// Decodes a telemetry stream (see telemetry.hpp and host/telemetry.hpp),
+// live from the serial port or from a recording.
+//
+// Build (host): g++ -O2 -std=c++14 -I inc tools/telemetry_view.cpp
+//                  src/host/serial.cpp -o telemetry_view
+//
+// Usage: telemetry_view <device|file> [--baud <n>] [--sps <n>] [--json]
+//
+// The input is the serial device connected to the board's telemetry UART
+// (e.g. the ST-LINK virtual COM port, /dev/ttyACM0), read at --baud
+// (default: 230400), or a file or FIFO, e.g. written by the simulator's
+// --uart option:
+//
+//    ./start --sine 110 --uart telemetry.bin
+//    telemetry_view telemetry.bin
+//
+// Reading a device goes on until interrupted (Ctrl-C). Prints one record
+// per frame, as CSV with a header line (default) or as JSON lines (--json).
+// The string fields are empty in system frames and vice versa. The
+// frequency is computed from the period using --sps (default: 20000):
+//
+//    frame          string or system
+//    sample_clock   The frame's sample clock
+//    channel        The string's channel
+//    flags          The string's flags (1: active)
+//    period         Detected period (samples)
+//    freq           Detected frequency (Hz)
+//    phase_error    Synth phase error (cycles, +-0.5)
+//    envelope       Input envelope (0.0 to 1.0)
+//    level          Drive level (0.0 to 1.0)
+//    load           CPU load of the latest block (0.0 to 1.0)
+//    peak_load      Highest CPU load so far (0.0 to 1.0)
+//    tier           Load governor tier
+//    deadline_misses
+//    dropped        Frames dropped by the sender (link too slow)
+//
+// The link statistics (frames, crc errors, lost frames and skipped bytes)
+// are printed to stderr at the end.
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+namespace host = cycfi::infinity::host;
+
+namespace
+{
+   volatile std::sig_atomic_t interrupted = 0;
+
+   void on_interrupt(int)
+   {
+      interrupted = 1;
+   }
+}
+
+[[noreturn]] void usage(char const* name)
+{
+   std::fprintf(stderr,
+      "Usage: %s <device|file> [--baud <n>] [--sps <n>] [--json]\n", name);
+   std::exit(EXIT_FAILURE);
+}
+
+void print_string(inf::telemetry_string const& s, double sps, bool json)
+{
+   double freq = (s.period > 0)? sps / s.period : 0;
+   if (json)
+   {
+      std::printf(
+         "{\"frame\":\"string\",\"sample_clock\":%u,\"channel\":%u,"
+         "\"flags\":%u,\"period\":%.3f,\"freq\":%.2f,\"phase_error\":%.4f,"
+         "\"envelope\":%.4f,\"level\":%.4f}\n",
+         unsigned(s.sample_clock), unsigned(s.channel), unsigned(s.flags),
+         s.period, freq, s.phase_error, s.envelope, s.level);
+   }
+   else
+   {
+      std::printf("string,%u,%u,%u,%.3f,%.2f,%.4f,%.4f,%.4f,,,,,\n",
+         unsigned(s.sample_clock), unsigned(s.channel), unsigned(s.flags),
+         s.period, freq, s.phase_error, s.envelope, s.level);
+   }
+}
+
+void print_system(inf::telemetry_system const& s, bool json)
+{
+   if (json)
+   {
+      std::printf(
+         "{\"frame\":\"system\",\"sample_clock\":%u,\"load\":%.4f,"
+         "\"peak_load\":%.4f,\"tier\":%u,\"deadline_misses\":%u,"
+         "\"dropped\":%u}\n",
+         unsigned(s.sample_clock), s.load, s.peak_load, unsigned(s.tier),
+         unsigned(s.deadline_misses), unsigned(s.dropped));
+   }
+   else
+   {
+      std::printf("system,%u,,,,,,,,%.4f,%.4f,%u,%u,%u\n",
+         unsigned(s.sample_clock), s.load, s.peak_load, unsigned(s.tier),
+         unsigned(s.deadline_misses), unsigned(s.dropped));
+   }
+}
+
+int main(int argc, char const* argv[])
+{
+   std::string path;
+   std::uint32_t baud = 230400;
+   double sps = 20000;
+   bool json = false;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      std::string opt = argv[i];
+      if (opt == "--json")
+      {
+         json = true;
+         continue;
+      }
+      if (opt.compare(0, 2, "--") != 0)
+      {
+         if (!path.empty())
+            usage(argv[0]);
+         path = opt;
+         continue;
+      }
+      if (i+1 == argc)
+         usage(argv[0]);
+      std::string arg = argv[++i];
+      if (opt == "--baud")
+         baud = std::stoul(arg);
+      else if (opt == "--sps")
+         sps = std::stod(arg);
+      else
+         usage(argv[0]);
+   }
+
+   if (path.empty() || sps <= 0)
+      usage(argv[0]);
+
+   try
+   {
+      host::serial_port port(path, baud);
+      host::telemetry_decoder decoder;
+
+      std::signal(SIGINT, on_interrupt);
+      if (!json)
+         std::puts(
+            "frame,sample_clock,channel,flags,period,freq,phase_error,"
+            "envelope,level,load,peak_load,tier,deadline_misses,dropped");
+
+      auto handler =
+         [&](inf::telemetry_frame type, std::uint8_t /*seq*/,
+            std::uint8_t const* payload, std::size_t len)
+         {
+            if (type == inf::telemetry_frame::string
+               && len == inf::telemetry_string::size)
+            {
+               inf::telemetry_string s;
+               s.decode(payload);
+               print_string(s, sps, json);
+            }
+            else if (type == inf::telemetry_frame::system
+               && len == inf::telemetry_system::size)
+            {
+               inf::telemetry_system s;
+               s.decode(payload);
+               print_system(s, json);
+            }
+         };
+
+      std::uint8_t buff[4096];
+      while (!interrupted)
+      {
+         auto n = port.read(buff, sizeof(buff), 200);
+         if (n < 0)
+            break;
+         decoder.feed(buff, n, handler);
+         std::fflush(stdout);
+      }
+
+      std::fprintf(stderr,
+         "%zu frames, %zu crc errors, %zu lost, %zu bytes skipped\n",
+         decoder.frames(), decoder.crc_errors(), decoder.lost(),
+         decoder.skipped());
+   }
+   catch (std::exception const& e)
+   {
+      std::fprintf(stderr, "Error: %s\n", e.what());
+      return EXIT_FAILURE;
+   }
+   return 0;
+}
@@ -0,0 +1,192 @@
+/*=============================================================================
+   Copyright (c) 2014-2017 Cycfi Research. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#include <inf/host/trace.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Decodes a trace dump (see trace.hpp and host/trace.hpp) into a timeline.
+//
+// Build (host): g++ -O2 -std=c++14 -I inc tools/trace_decode.cpp
+//                  -o trace_decode
+//
+// Usage: trace_decode <dump> [--sps <n>] [--channel <n>] [--json]
+//
+// The dump is either a memory dump read with the debugger, containing the
+// trace ring anywhere, e.g. (gdb):
+//
+//    dump binary memory trace.bin 0x20000000 0x20020000
+//
+// or the ring's bytes as sent by trace_dump (e.g. over a serial link), or
+// as written by the simulator's --trace option.
+//
+// Prints one record per event, oldest first, as CSV with a header line
+// (default) or as JSON lines (--json). --channel shows only the events of
+// one channel (and the channel-less xrun and tier events). The sample
+// clock is converted to time using --sps (default: 20000):
+//
+//    index          Running event number
+//    sample_clock   The event's sample clock
+//    time_ms        sample_clock in ms
+//    delta_ms       Time since the previous event shown (ms)
+//    channel        The channel (for param: the parameter id)
+//    event          edge, sync, stage, gate_open, gate_close, xrun, param
+//                   or tier
+//    data           The event's data (see trace_event)
+//    info           The data, decoded (e.g. the edge frequency, the stage
+//                   name or the parameter value)
+///////////////////////////////////////////////////////////////////////////////
+
+namespace inf = cycfi::infinity;
+namespace host = cycfi::infinity::host;
+
+[[noreturn]] void usage(char const* name)
+{
+   std::fprintf(stderr,
+      "Usage: %s <dump> [--sps <n>] [--channel <n>] [--json]\n", name);
+   std::exit(EXIT_FAILURE);
+}
+
+std::string info(host::trace_entry const& e, double sps)
+{
+   char buff[64] = "";
+   switch (e.event)
+   {
+      case inf::trace_event::edge:
+         if (e.data)
+            std::snprintf(buff, sizeof(buff), "%.2f Hz", sps / e.data);
+         break;
+
+      case inf::trace_event::stage:
+      {
+         // See pls.hpp
+         static char const* const stages[] = { "stop", "wait", "run", "release" };
+         if (e.data < 4)
+            return stages[e.data];
+         break;
+      }
+
+      case inf::trace_event::param:
+         std::snprintf(buff, sizeof(buff), "%.4f", e.data / 65535.0);
+         break;
+
+      case inf::trace_event::xrun:
+         std::snprintf(buff, sizeof(buff), "%u misses", unsigned(e.data));
+         break;
+
+      default:
+         break;
+   }
+   return buff;
+}
+
+int main(int argc, char const* argv[])
+{
+   std::string path;
+   double sps = 20000;
+   int channel = -1;
+   bool json = false;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      std::string opt = argv[i];
+      if (opt == "--json")
+      {
+         json = true;
+         continue;
+      }
+      if (opt.compare(0, 2, "--") != 0)
+      {
+         if (!path.empty())
+            usage(argv[0]);
+         path = opt;
+         continue;
+      }
+      if (i+1 == argc)
+         usage(argv[0]);
+      std::string arg = argv[++i];
+      if (opt == "--sps")
+         sps = std::stod(arg);
+      else if (opt == "--channel")
+         channel = std::stoi(arg);
+      else
+         usage(argv[0]);
+   }
+
+   if (path.empty() || sps <= 0)
+      usage(argv[0]);
+
+   // Read the whole dump
+   std::vector<std::uint8_t> dump;
+   if (auto file = std::fopen(path.c_str(), "rb"))
+   {
+      std::uint8_t buff[4096];
+      while (auto n = std::fread(buff, 1, sizeof(buff), file))
+         dump.insert(dump.end(), buff, buff + n);
+      std::fclose(file);
+   }
+   else
+   {
+      std::fprintf(stderr, "Error: can't read %s\n", path.c_str());
+      return EXIT_FAILURE;
+   }
+
+   std::vector<host::trace_entry> events;
+   host::trace_dump_info dump_info;
+   if (!host::decode_trace(dump.data(), dump.size(), events, &dump_info))
+   {
+      std::fprintf(stderr, "Error: no trace found in %s\n", path.c_str());
+      return EXIT_FAILURE;
+   }
+
+   std::fprintf(stderr,
+      "Trace at offset %zu: %u events recorded, showing the latest %zu\n",
+      dump_info.offset, unsigned(dump_info.count), events.size());
+
+   if (!json)
+      std::puts("index,sample_clock,time_ms,delta_ms,channel,event,data,info");
+
+   bool first = true;
+   std::uint32_t prev = 0;
+   for (auto const& e : events)
+   {
+      bool global =
+         e.event == inf::trace_event::xrun || e.event == inf::trace_event::tier;
+      // Params are tagged with the parameter id, not the channel
+      bool param = e.event == inf::trace_event::param;
+      if (channel >= 0 && !global && (param || e.channel != channel))
+         continue;
+
+      double delta_ms = first? 0 : std::uint32_t(e.sample_clock - prev) * 1000.0 / sps;
+      first = false;
+      prev = e.sample_clock;
+
+      double time_ms = e.sample_clock * 1000.0 / sps;
+      auto name = host::trace_event_name(e.event);
+      auto decoded = info(e, sps);
+
+      if (json)
+      {
+         std::printf(
+            "{\"index\":%u,\"sample_clock\":%u,\"time_ms\":%.3f,"
+            "\"delta_ms\":%.3f,\"channel\":%u,\"event\":\"%s\",\"data\":%u,"
+            "\"info\":\"%s\"}\n",
+            unsigned(e.index), unsigned(e.sample_clock), time_ms, delta_ms,
+            unsigned(e.channel), name, unsigned(e.data), decoded.c_str());
+      }
+      else
+      {
+         std::printf("%u,%u,%.3f,%.3f,%u,%s,%u,%s\n",
+            unsigned(e.index), unsigned(e.sample_clock), time_ms, delta_ms,
+            unsigned(e.channel), name, unsigned(e.data), decoded.c_str());
+      }
+   }
+   return 0;
+}